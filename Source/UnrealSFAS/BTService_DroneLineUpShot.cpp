@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTService_DroneLineUpShot.h"
+#include "EnemyDroneAIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+
+UBTService_DroneLineUpShot::UBTService_DroneLineUpShot()
+{
+	NodeName = "Drone Line Up Shot";
+	bNotifyCeaseRelevant = true;
+
+	// Lining up a shot doesn't need to happen every frame.
+	Interval = 0.2f;
+	RandomDeviation = 0.05f;
+
+	// Only accept actors as the target and bools as the result.
+	TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_DroneLineUpShot, TargetKey), AActor::StaticClass());
+	ShotLinedUpKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_DroneLineUpShot, ShotLinedUpKey));
+
+	// Set default member values.
+	MaxAimAngleDegrees = 10.f;
+}
+
+void UBTService_DroneLineUpShot::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	// Resolve the keys once so they are accessed by ID rather than by name.
+	auto* blackboardAsset = GetBlackboardAsset();
+	if (blackboardAsset)
+	{
+		TargetKey.ResolveSelectedKey(*blackboardAsset);
+		ShotLinedUpKey.ResolveSelectedKey(*blackboardAsset);
+	}
+}
+
+void UBTService_DroneLineUpShot::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	auto* memory = reinterpret_cast<FBTDroneLineUpShotMemory*>(NodeMemory);
+	memory->ShotLinedUp = false;
+}
+
+uint16 UBTService_DroneLineUpShot::GetInstanceMemorySize() const
+{
+	return sizeof(FBTDroneLineUpShotMemory);
+}
+
+void UBTService_DroneLineUpShot::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
+
+	auto* enemyDroneAIController = Cast<AEnemyDroneAIController>(OwnerComp.GetAIOwner());
+	auto* target = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Object>(TargetKey.GetSelectedKeyID()));
+	if (!enemyDroneAIController || !enemyDroneAIController->GetPawn() || !target)
+	{
+		if (enemyDroneAIController)
+		{
+			enemyDroneAIController->ClearFocus(EAIFocusPriority::Gameplay);
+		}
+
+		SetShotLinedUp(OwnerComp, NodeMemory, false);
+		return;
+	}
+
+	// Turn the drone to face the target.
+	if (enemyDroneAIController->GetFocusActor() != target)
+	{
+		enemyDroneAIController->SetFocus(target);
+	}
+
+	// The shot is lined up once the target is in range and inside of the aim cone.
+	const auto* pawn = enemyDroneAIController->GetPawn();
+	const FVector toTarget = target->GetActorLocation() - pawn->GetActorLocation();
+	const bool inRange = toTarget.SizeSquared() <= FMath::Square(enemyDroneAIController->GetMaxShotDistance());
+	const bool inAimCone = FVector::DotProduct(toTarget.GetSafeNormal(), pawn->GetActorForwardVector()) >= FMath::Cos(FMath::DegreesToRadians(MaxAimAngleDegrees));
+
+	SetShotLinedUp(OwnerComp, NodeMemory, inRange && inAimCone);
+}
+
+void UBTService_DroneLineUpShot::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+
+	// Stop facing the target.
+	auto* aiController = OwnerComp.GetAIOwner();
+	if (aiController)
+	{
+		aiController->ClearFocus(EAIFocusPriority::Gameplay);
+	}
+
+	SetShotLinedUp(OwnerComp, NodeMemory, false);
+}
+
+void UBTService_DroneLineUpShot::SetShotLinedUp(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, bool ShotLinedUp) const
+{
+	auto* memory = reinterpret_cast<FBTDroneLineUpShotMemory*>(NodeMemory);
+	if (memory->ShotLinedUp != ShotLinedUp)
+	{
+		memory->ShotLinedUp = ShotLinedUp;
+		OwnerComp.GetBlackboardComponent()->SetValue<UBlackboardKeyType_Bool>(ShotLinedUpKey.GetSelectedKeyID(), ShotLinedUp);
+	}
+}
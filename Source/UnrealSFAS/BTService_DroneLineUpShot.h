@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTService.h"
+#include "BTService_DroneLineUpShot.generated.h"
+
+/** Per drone memory of the line up shot service. */
+struct FBTDroneLineUpShotMemory
+{
+	/** The value last written to the shot lined up key. */
+	bool ShotLinedUp;
+};
+
+/**
+ * Keeps the drone focused on the target actor and sets the shot lined up key when the target is in range of the drone's
+ * shots and in front of it. The key is only written when its value changes.
+ */
+UCLASS()
+class UNREALSFAS_API UBTService_DroneLineUpShot : public UBTService
+{
+	GENERATED_BODY()
+
+public:
+	UBTService_DroneLineUpShot();
+
+	void InitializeFromAsset(UBehaviorTree& Asset) override;
+	void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	uint16 GetInstanceMemorySize() const override;
+
+protected:
+	void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+	void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+private:
+	/** Writes the shot lined up key if it has changed. */
+	void SetShotLinedUp(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, bool ShotLinedUp) const;
+
+private:
+	/** The actor to line up a shot on. */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	FBlackboardKeySelector TargetKey;
+
+	/** Set to whether the drone has a shot lined up on the target. */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	FBlackboardKeySelector ShotLinedUpKey;
+
+	/** The largest angle between the drone's facing and the direction to the target at which a shot is lined up, in degrees. */
+	UPROPERTY(EditAnywhere, Category = Shot, meta = (ClampMin = "0", ClampMax = "180"))
+	float MaxAimAngleDegrees;
+};
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_DroneChase.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "Navigation/PathFollowingComponent.h"
+
+UBTTask_DroneChase::UBTTask_DroneChase()
+{
+	NodeName = "Drone Chase";
+	bNotifyTick = true;
+
+	// Only accept actors as the target.
+	TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_DroneChase, TargetKey), AActor::StaticClass());
+
+	// Set default member values.
+	AcceptableRadius = 800.f;
+	CheckInterval = 0.25f;
+}
+
+void UBTTask_DroneChase::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	// Resolve the key once so it is read by ID rather than by name.
+	auto* blackboardAsset = GetBlackboardAsset();
+	if (blackboardAsset)
+	{
+		TargetKey.ResolveSelectedKey(*blackboardAsset);
+	}
+}
+
+EBTNodeResult::Type UBTTask_DroneChase::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	auto* aiController = OwnerComp.GetAIOwner();
+	auto* target = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Object>(TargetKey.GetSelectedKeyID()));
+	if (!aiController || !aiController->GetPawn() || !target)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	// Nothing to do if the drone is already close enough.
+	if (aiController->GetPawn()->GetDistanceTo(target) <= AcceptableRadius)
+	{
+		return EBTNodeResult::Succeeded;
+	}
+
+	if (aiController->MoveToActor(target, AcceptableRadius) == EPathFollowingRequestResult::Failed)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	auto* memory = reinterpret_cast<FBTDroneChaseMemory*>(NodeMemory);
+	memory->TimeUntilCheck = CheckInterval;
+
+	return EBTNodeResult::InProgress;
+}
+
+EBTNodeResult::Type UBTTask_DroneChase::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	auto* aiController = OwnerComp.GetAIOwner();
+	if (aiController)
+	{
+		aiController->StopMovement();
+	}
+
+	return EBTNodeResult::Aborted;
+}
+
+uint16 UBTTask_DroneChase::GetInstanceMemorySize() const
+{
+	return sizeof(FBTDroneChaseMemory);
+}
+
+void UBTTask_DroneChase::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	// Only check the chase once per interval.
+	auto* memory = reinterpret_cast<FBTDroneChaseMemory*>(NodeMemory);
+	memory->TimeUntilCheck -= DeltaSeconds;
+	if (memory->TimeUntilCheck > 0.f)
+	{
+		return;
+	}
+	memory->TimeUntilCheck = CheckInterval;
+
+	// Give up if the target has been lost.
+	auto* aiController = OwnerComp.GetAIOwner();
+	auto* target = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Object>(TargetKey.GetSelectedKeyID()));
+	if (!aiController || !aiController->GetPawn() || !target)
+	{
+		if (aiController)
+		{
+			aiController->StopMovement();
+		}
+
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	// The chase is over once the drone is in range or the move has ended.
+	if ((aiController->GetPawn()->GetDistanceTo(target) <= AcceptableRadius) || (aiController->GetMoveStatus() == EPathFollowingStatus::Idle))
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
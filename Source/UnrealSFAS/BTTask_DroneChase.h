@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_DroneChase.generated.h"
+
+/** Per drone memory of the chase task. */
+struct FBTDroneChaseMemory
+{
+	/** Seconds until the task next checks whether the chase is over. */
+	float TimeUntilCheck;
+};
+
+/**
+ * Moves the drone towards the target actor until it is within AcceptableRadius.
+ * Fails if there is no target or the target is lost during the chase.
+ */
+UCLASS()
+class UNREALSFAS_API UBTTask_DroneChase : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_DroneChase();
+
+	void InitializeFromAsset(UBehaviorTree& Asset) override;
+	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	uint16 GetInstanceMemorySize() const override;
+
+protected:
+	void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+private:
+	/** The actor to chase. */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	FBlackboardKeySelector TargetKey;
+
+	/** The chase is over once the drone is this close to the target. */
+	UPROPERTY(EditAnywhere, Category = Chase)
+	float AcceptableRadius;
+
+	/** Seconds between checks of whether the chase is over. */
+	UPROPERTY(EditAnywhere, Category = Chase)
+	float CheckInterval;
+};
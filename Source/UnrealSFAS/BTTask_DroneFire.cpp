@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_DroneFire.h"
+#include "EnemyDroneAIController.h"
+#include "DroneCharacter.h"
+#include "DroneBehaviorTreeComponent.h"
+#include "UnrealSFASCharacter.h"
+#include "UnrealSFASGameMode.h"
+#include "ProjectileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+
+UBTTask_DroneFire::UBTTask_DroneFire()
+{
+	NodeName = "Drone Fire";
+
+	// Only accept player characters as the target.
+	TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_DroneFire, TargetKey), AUnrealSFASCharacter::StaticClass());
+
+	// Set default member values.
+	FireInterval = 1.f;
+	FollowSquadFiringOrder = true;
+}
+
+void UBTTask_DroneFire::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	// Resolve the key once so it is read by ID rather than by name.
+	auto* blackboardAsset = GetBlackboardAsset();
+	if (blackboardAsset)
+	{
+		TargetKey.ResolveSelectedKey(*blackboardAsset);
+	}
+}
+
+void UBTTask_DroneFire::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	auto* memory = reinterpret_cast<FBTDroneFireMemory*>(NodeMemory);
+	memory->LastShotSeconds = -FireInterval;
+}
+
+EBTNodeResult::Type UBTTask_DroneFire::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	auto* world = OwnerComp.GetWorld();
+	auto* enemyDroneAIController = Cast<AEnemyDroneAIController>(OwnerComp.GetAIOwner());
+	auto* drone = enemyDroneAIController ? Cast<ADroneCharacter>(enemyDroneAIController->GetPawn()) : nullptr;
+	auto* target = Cast<AUnrealSFASCharacter>(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Object>(TargetKey.GetSelectedKeyID()));
+	if (!world || !drone || !target || target->GetDefeated())
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	// Has enough AI time elapsed since the last shot? Scheduled behavior trees run on the scheduler's fixed step simulation time.
+	auto* memory = reinterpret_cast<FBTDroneFireMemory*>(NodeMemory);
+	auto* droneBehaviorTree = Cast<UDroneBehaviorTreeComponent>(&OwnerComp);
+	const double currentSeconds = droneBehaviorTree ? droneBehaviorTree->GetAITimeSeconds() : world->GetTimeSeconds();
+	if ((currentSeconds - memory->LastShotSeconds) < FireInterval)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	// Squad members take turns to fire.
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(world));
+	if (FollowSquadFiringOrder && unrealSFASGameMode && !unrealSFASGameMode->GetDroneSquadPlanner().IsFireTurn(drone->GetRegistryHandle(), static_cast<float>(currentSeconds)))
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	// Check the target is in range.
+	const FVector shotStart = drone->GetMuzzleFlashScene()->GetComponentLocation();
+	const FVector shotEnd = target->GetActorLocation();
+	if (FVector::DistSquared(shotStart, shotEnd) > FMath::Square(enemyDroneAIController->GetMaxShotDistance()))
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	memory->LastShotSeconds = currentSeconds;
+	drone->PlayFireEffects();
+
+	// Drones with a projectile speed fire a projectile at the target if the game mode has a projectile manager.
+	const float projectileSpeed = drone->GetArchetype()->GetShotProjectileSpeed();
+	auto* projectileManager = ((projectileSpeed > 0.f) && unrealSFASGameMode) ? unrealSFASGameMode->GetProjectileManager() : nullptr;
+	if (projectileManager)
+	{
+		FProjectileSpawn projectile;
+		projectile.Source = EHitscanShotSource::Drone;
+		projectile.Shooter = drone;
+		projectile.Location = shotStart;
+		projectile.Velocity = (shotEnd - shotStart).GetSafeNormal() * projectileSpeed;
+		projectile.Lifetime = enemyDroneAIController->GetMaxShotDistance() / projectileSpeed;
+		projectile.Damage = FMath::RandRange(enemyDroneAIController->GetMinShotDamage(), enemyDroneAIController->GetMaxShotDamage());
+		projectileManager->FireProjectile(projectile);
+	}
+	// Otherwise queue the shot with the game mode's hitscan service, which damages the target next frame if nothing is in the way.
+	else if (unrealSFASGameMode)
+	{
+		FHitscanShot shot;
+		shot.Source = EHitscanShotSource::Drone;
+		shot.Shooter = drone;
+		shot.Target = target;
+		shot.Start = shotStart;
+		shot.End = shotEnd;
+		shot.Damage = FMath::RandRange(enemyDroneAIController->GetMinShotDamage(), enemyDroneAIController->GetMaxShotDamage());
+		unrealSFASGameMode->GetHitscanService().FireShot(world, unrealSFASGameMode->GetDroneRegistry(), shot);
+	}
+
+	return EBTNodeResult::Succeeded;
+}
+
+uint16 UBTTask_DroneFire::GetInstanceMemorySize() const
+{
+	return sizeof(FBTDroneFireMemory);
+}
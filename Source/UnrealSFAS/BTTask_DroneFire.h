@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_DroneFire.generated.h"
+
+/** Per drone memory of the fire task. */
+struct FBTDroneFireMemory
+{
+	/** AI time of the drone's last shot. */
+	double LastShotSeconds;
+};
+
+/**
+ * Fires a shot from the drone's muzzle at the target player. The shot is traced by the game mode's hitscan service, which
+ * damages the player next frame if nothing is in the way. Uses the shot distance and damage range of the drone's AI
+ * controller. Fails if the drone fired less than FireInterval seconds ago, or if it isn't the drone's turn in its squad's
+ * firing order.
+ */
+UCLASS()
+class UNREALSFAS_API UBTTask_DroneFire : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_DroneFire();
+
+	void InitializeFromAsset(UBehaviorTree& Asset) override;
+	void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	uint16 GetInstanceMemorySize() const override;
+
+private:
+	/** The player to fire at. */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	FBlackboardKeySelector TargetKey;
+
+	/** The minimum seconds between shots. */
+	UPROPERTY(EditAnywhere, Category = Fire)
+	float FireInterval;
+
+	/** Whether the drone waits for its turn in its squad's firing order. */
+	UPROPERTY(EditAnywhere, Category = Fire)
+	bool FollowSquadFiringOrder;
+};
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_DroneKeepDistance.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "Navigation/PathFollowingComponent.h"
+
+UBTTask_DroneKeepDistance::UBTTask_DroneKeepDistance()
+{
+	NodeName = "Drone Keep Distance";
+	bNotifyTick = true;
+
+	// Only accept actors as the target.
+	TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_DroneKeepDistance, TargetKey), AActor::StaticClass());
+
+	// Set default member values.
+	MinDistance = 400.f;
+	PreferredDistance = 700.f;
+	CheckInterval = 0.25f;
+}
+
+void UBTTask_DroneKeepDistance::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	// Resolve the key once so it is read by ID rather than by name.
+	auto* blackboardAsset = GetBlackboardAsset();
+	if (blackboardAsset)
+	{
+		TargetKey.ResolveSelectedKey(*blackboardAsset);
+	}
+}
+
+EBTNodeResult::Type UBTTask_DroneKeepDistance::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	auto* aiController = OwnerComp.GetAIOwner();
+	auto* target = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Object>(TargetKey.GetSelectedKeyID()));
+	if (!aiController || !aiController->GetPawn() || !target)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	// Nothing to do if the drone is already far enough away.
+	const FVector pawnLocation = aiController->GetPawn()->GetActorLocation();
+	const FVector targetLocation = target->GetActorLocation();
+	if (FVector::DistSquared(pawnLocation, targetLocation) >= FMath::Square(MinDistance))
+	{
+		return EBTNodeResult::Succeeded;
+	}
+
+	// Back away along the line from the target to the drone.
+	FVector awayDirection = (pawnLocation - targetLocation).GetSafeNormal2D();
+	if (awayDirection.IsNearlyZero())
+	{
+		awayDirection = -aiController->GetPawn()->GetActorForwardVector();
+	}
+
+	const FVector destination = targetLocation + (awayDirection * PreferredDistance);
+	if (aiController->MoveToLocation(destination) == EPathFollowingRequestResult::Failed)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	auto* memory = reinterpret_cast<FBTDroneKeepDistanceMemory*>(NodeMemory);
+	memory->TimeUntilCheck = CheckInterval;
+
+	return EBTNodeResult::InProgress;
+}
+
+EBTNodeResult::Type UBTTask_DroneKeepDistance::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	auto* aiController = OwnerComp.GetAIOwner();
+	if (aiController)
+	{
+		aiController->StopMovement();
+	}
+
+	return EBTNodeResult::Aborted;
+}
+
+uint16 UBTTask_DroneKeepDistance::GetInstanceMemorySize() const
+{
+	return sizeof(FBTDroneKeepDistanceMemory);
+}
+
+void UBTTask_DroneKeepDistance::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	// Only check the move once per interval.
+	auto* memory = reinterpret_cast<FBTDroneKeepDistanceMemory*>(NodeMemory);
+	memory->TimeUntilCheck -= DeltaSeconds;
+	if (memory->TimeUntilCheck > 0.f)
+	{
+		return;
+	}
+	memory->TimeUntilCheck = CheckInterval;
+
+	// The task is over once the move has ended.
+	auto* aiController = OwnerComp.GetAIOwner();
+	if (!aiController || (aiController->GetMoveStatus() == EPathFollowingStatus::Idle))
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
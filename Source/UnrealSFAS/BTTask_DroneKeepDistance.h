@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_DroneKeepDistance.generated.h"
+
+/** Per drone memory of the keep distance task. */
+struct FBTDroneKeepDistanceMemory
+{
+	/** Seconds until the task next checks whether the drone has backed off. */
+	float TimeUntilCheck;
+};
+
+/**
+ * Backs the drone away from the target actor when it is closer than MinDistance, moving to PreferredDistance from it.
+ * Succeeds straight away if the drone is already far enough from the target.
+ */
+UCLASS()
+class UNREALSFAS_API UBTTask_DroneKeepDistance : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_DroneKeepDistance();
+
+	void InitializeFromAsset(UBehaviorTree& Asset) override;
+	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	uint16 GetInstanceMemorySize() const override;
+
+protected:
+	void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+private:
+	/** The actor to keep away from. */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	FBlackboardKeySelector TargetKey;
+
+	/** The drone backs off when it is closer than this to the target. */
+	UPROPERTY(EditAnywhere, Category = Distance)
+	float MinDistance;
+
+	/** The distance from the target the drone backs off to. */
+	UPROPERTY(EditAnywhere, Category = Distance)
+	float PreferredDistance;
+
+	/** Seconds between checks of whether the drone has backed off. */
+	UPROPERTY(EditAnywhere, Category = Distance)
+	float CheckInterval;
+};
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_DroneSquadMove.h"
+#include "AIController.h"
+#include "DroneCharacter.h"
+#include "UnrealSFASGameMode.h"
+#include "Kismet/GameplayStatics.h"
+#include "Navigation/PathFollowingComponent.h"
+
+UBTTask_DroneSquadMove::UBTTask_DroneSquadMove()
+{
+	NodeName = "Drone Squad Move";
+	bNotifyTick = true;
+
+	// Set default member values.
+	AcceptableRadius = 100.f;
+	RepathDistance = 200.f;
+	CheckInterval = 0.25f;
+}
+
+EBTNodeResult::Type UBTTask_DroneSquadMove::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	auto* aiController = OwnerComp.GetAIOwner();
+	FDroneSquadOrder order;
+	if (!aiController || !aiController->GetPawn() || !GetSquadOrder(OwnerComp, order))
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	// Nothing to do if the drone is already in position.
+	if (FVector::DistSquared2D(aiController->GetPawn()->GetActorLocation(), order.FlankLocation) <= FMath::Square(AcceptableRadius))
+	{
+		return EBTNodeResult::Succeeded;
+	}
+
+	if (aiController->MoveToLocation(order.FlankLocation, AcceptableRadius) == EPathFollowingRequestResult::Failed)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	auto* memory = reinterpret_cast<FBTDroneSquadMoveMemory*>(NodeMemory);
+	memory->TimeUntilCheck = CheckInterval;
+	memory->Destination = order.FlankLocation;
+
+	return EBTNodeResult::InProgress;
+}
+
+EBTNodeResult::Type UBTTask_DroneSquadMove::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	auto* aiController = OwnerComp.GetAIOwner();
+	if (aiController)
+	{
+		aiController->StopMovement();
+	}
+
+	return EBTNodeResult::Aborted;
+}
+
+uint16 UBTTask_DroneSquadMove::GetInstanceMemorySize() const
+{
+	return sizeof(FBTDroneSquadMoveMemory);
+}
+
+void UBTTask_DroneSquadMove::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	// Only check the order once per interval.
+	auto* memory = reinterpret_cast<FBTDroneSquadMoveMemory*>(NodeMemory);
+	memory->TimeUntilCheck -= DeltaSeconds;
+	if (memory->TimeUntilCheck > 0.f)
+	{
+		return;
+	}
+	memory->TimeUntilCheck = CheckInterval;
+
+	// Give up if the squad no longer has a plan.
+	auto* aiController = OwnerComp.GetAIOwner();
+	FDroneSquadOrder order;
+	if (!aiController || !aiController->GetPawn() || !GetSquadOrder(OwnerComp, order))
+	{
+		if (aiController)
+		{
+			aiController->StopMovement();
+		}
+
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	// Follow the flanking position when a re-evaluated plan moves it.
+	if (FVector::DistSquared2D(memory->Destination, order.FlankLocation) > FMath::Square(RepathDistance))
+	{
+		memory->Destination = order.FlankLocation;
+		if (aiController->MoveToLocation(order.FlankLocation, AcceptableRadius) == EPathFollowingRequestResult::Failed)
+		{
+			FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		}
+		return;
+	}
+
+	// The move is over once the drone is in position or the move has ended.
+	if (aiController->GetMoveStatus() == EPathFollowingStatus::Idle)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
+
+bool UBTTask_DroneSquadMove::GetSquadOrder(UBehaviorTreeComponent& OwnerComp, FDroneSquadOrder& OutOrder)
+{
+	auto* aiController = OwnerComp.GetAIOwner();
+	auto* drone = aiController ? Cast<ADroneCharacter>(aiController->GetPawn()) : nullptr;
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(OwnerComp.GetWorld()));
+	if (!drone || !unrealSFASGameMode)
+	{
+		return false;
+	}
+
+	return unrealSFASGameMode->GetDroneSquadPlanner().GetOrder(drone->GetRegistryHandle(), OutOrder);
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_DroneSquadMove.generated.h"
+
+/** Per drone memory of the squad move task. */
+struct FBTDroneSquadMoveMemory
+{
+	/** Seconds until the task next checks the drone's squad order. */
+	float TimeUntilCheck;
+
+	/** The flanking location the drone is moving to. */
+	FVector Destination;
+};
+
+/**
+ * Moves the drone to the flanking position its squad's plan gives it, following the position as the plan is re-evaluated.
+ * Fails if the drone has no squad plan. The plan is made by the game mode's squad planner, so this task does no planning itself.
+ */
+UCLASS()
+class UNREALSFAS_API UBTTask_DroneSquadMove : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_DroneSquadMove();
+
+	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	uint16 GetInstanceMemorySize() const override;
+
+protected:
+	void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+private:
+	/** Gets the order of the drone controlled by the behavior tree from its squad's plan. */
+	static bool GetSquadOrder(UBehaviorTreeComponent& OwnerComp, struct FDroneSquadOrder& OutOrder);
+
+private:
+	/** The move is over once the drone is this close to its flanking position. */
+	UPROPERTY(EditAnywhere, Category = Squad)
+	float AcceptableRadius;
+
+	/** The drone is sent to its new flanking position once the plan moves it further than this. */
+	UPROPERTY(EditAnywhere, Category = Squad)
+	float RepathDistance;
+
+	/** Seconds between checks of the drone's squad order. */
+	UPROPERTY(EditAnywhere, Category = Squad)
+	float CheckInterval;
+};
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraRigComponent.h"
+#include "UnrealSFAS.h"
+#include "Camera/CameraComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "Kismet/KismetMathLibrary.h"
+
+DECLARE_CYCLE_STAT(TEXT("Camera rig"), STAT_CameraRig, STATGROUP_SFASGameplay);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Camera rigs awake"), STAT_CameraRigsAwake, STATGROUP_SFASGameplay);
+
+UCameraRigComponent::UCameraRigComponent()
+{
+	// Tick before the spring arm places the camera, and only while moving. Setting a target wakes the rig.
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	// Set default member values.
+	CameraBoom = nullptr;
+	Camera = nullptr;
+	CameraManager = nullptr;
+	LookAtTarget = nullptr;
+	LookAtCameraLocation = FVector::ZeroVector;
+	LookAtTargetLocation = FVector::ZeroVector;
+	SettleTolerance = 0.01f;
+}
+
+void UCameraRigComponent::Initialize(USpringArmComponent* InCameraBoom, UCameraComponent* InCamera, float ZoomSpeed, float MoveSpeed, float PitchSpeed)
+{
+	CameraBoom = InCameraBoom;
+	Camera = InCamera;
+
+	// A critically damped spring at twice the speed settles in about the time FInterpTo takes at the speed.
+	Springs[ArmLength].AngularFrequency = 2.f * ZoomSpeed;
+	Springs[SocketOffsetX].AngularFrequency = 2.f * MoveSpeed;
+	Springs[SocketOffsetY].AngularFrequency = 2.f * MoveSpeed;
+	Springs[SocketOffsetZ].AngularFrequency = 2.f * MoveSpeed;
+	Springs[ViewPitchMin].AngularFrequency = 2.f * PitchSpeed;
+	Springs[ViewPitchMax].AngularFrequency = 2.f * PitchSpeed;
+
+	if (CameraBoom)
+	{
+		Springs[ArmLength].Value = Springs[ArmLength].Target = CameraBoom->TargetArmLength;
+		Springs[SocketOffsetX].Value = Springs[SocketOffsetX].Target = CameraBoom->SocketOffset.X;
+		Springs[SocketOffsetY].Value = Springs[SocketOffsetY].Target = CameraBoom->SocketOffset.Y;
+		Springs[SocketOffsetZ].Value = Springs[SocketOffsetZ].Target = CameraBoom->SocketOffset.Z;
+	}
+}
+
+void UCameraRigComponent::SetCameraManager(APlayerCameraManager* InCameraManager)
+{
+	CameraManager = InCameraManager;
+	if (CameraManager)
+	{
+		Springs[ViewPitchMin].Value = Springs[ViewPitchMin].Target = CameraManager->ViewPitchMin;
+		Springs[ViewPitchMax].Value = Springs[ViewPitchMax].Target = CameraManager->ViewPitchMax;
+		Springs[ViewPitchMin].Velocity = 0.f;
+		Springs[ViewPitchMax].Velocity = 0.f;
+	}
+}
+
+void UCameraRigComponent::SetBoomTarget(float TargetArmLength, const FVector& TargetSocketOffset)
+{
+	SetTarget(ArmLength, TargetArmLength);
+	SetTarget(SocketOffsetX, TargetSocketOffset.X);
+	SetTarget(SocketOffsetY, TargetSocketOffset.Y);
+	SetTarget(SocketOffsetZ, TargetSocketOffset.Z);
+}
+
+void UCameraRigComponent::SetSocketOffsetTargetY(float TargetOffsetY)
+{
+	SetTarget(SocketOffsetY, TargetOffsetY);
+}
+
+void UCameraRigComponent::SetViewPitchTarget(float PitchMin, float PitchMax)
+{
+	SetTarget(ViewPitchMin, PitchMin);
+	SetTarget(ViewPitchMax, PitchMax);
+}
+
+void UCameraRigComponent::SetLookAtTarget(USceneComponent* Target)
+{
+	LookAtTarget = Target;
+
+	// Force the first turn.
+	LookAtCameraLocation = FVector(BIG_NUMBER);
+	if (LookAtTarget)
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UCameraRigComponent::SetTarget(ERigChannel Channel, float Value)
+{
+	if (Springs[Channel].Target != Value)
+	{
+		Springs[Channel].Target = Value;
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UCameraRigComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_CameraRig);
+	INC_DWORD_STAT(STAT_CameraRigsAwake);
+
+	bool settled = true;
+	if (CameraBoom)
+	{
+		settled &= StepSpring(Springs[ArmLength], DeltaTime, SettleTolerance);
+		settled &= StepSpring(Springs[SocketOffsetX], DeltaTime, SettleTolerance);
+		settled &= StepSpring(Springs[SocketOffsetY], DeltaTime, SettleTolerance);
+		settled &= StepSpring(Springs[SocketOffsetZ], DeltaTime, SettleTolerance);
+		CameraBoom->TargetArmLength = Springs[ArmLength].Value;
+		CameraBoom->SocketOffset = FVector(Springs[SocketOffsetX].Value, Springs[SocketOffsetY].Value, Springs[SocketOffsetZ].Value);
+	}
+
+	if (CameraManager)
+	{
+		settled &= StepSpring(Springs[ViewPitchMin], DeltaTime, SettleTolerance);
+		settled &= StepSpring(Springs[ViewPitchMax], DeltaTime, SettleTolerance);
+		CameraManager->ViewPitchMin = Springs[ViewPitchMin].Value;
+		CameraManager->ViewPitchMax = Springs[ViewPitchMax].Value;
+	}
+
+	// While looking at a target the camera has to follow the player's view and the target, so the rig stays awake. It only
+	// turns the camera when one of them has moved.
+	if (LookAtTarget && Camera)
+	{
+		UpdateLookAt();
+		settled = false;
+	}
+
+	if (settled)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+bool UCameraRigComponent::StepSpring(FRigSpring& Spring, float DeltaTime, float Tolerance)
+{
+	// The exact solution of a critically damped spring over DeltaTime: x(t) = (x0 + (v0 + w * x0) * t) * e^(-w * t).
+	const float offset = Spring.Value - Spring.Target;
+	const float decay = FMath::Exp(-Spring.AngularFrequency * DeltaTime);
+	const float impulse = (Spring.Velocity + (Spring.AngularFrequency * offset)) * DeltaTime;
+	Spring.Value = Spring.Target + ((offset + impulse) * decay);
+	Spring.Velocity = (Spring.Velocity - (Spring.AngularFrequency * impulse)) * decay;
+
+	// Snap to the target once close and slow enough. Springs without a speed snap straight away.
+	if ((Spring.AngularFrequency <= 0.f) || ((FMath::Abs(Spring.Value - Spring.Target) < Tolerance) && (FMath::Abs(Spring.Velocity) < Tolerance)))
+	{
+		Spring.Value = Spring.Target;
+		Spring.Velocity = 0.f;
+		return true;
+	}
+
+	return false;
+}
+
+void UCameraRigComponent::UpdateLookAt()
+{
+	const FVector cameraLocation = Camera->GetComponentLocation();
+	const FVector targetLocation = LookAtTarget->GetComponentLocation();
+	if (cameraLocation.Equals(LookAtCameraLocation) && targetLocation.Equals(LookAtTargetLocation))
+	{
+		return;
+	}
+
+	Camera->SetWorldRotation(UKismetMathLibrary::FindLookAtRotation(cameraLocation, targetLocation));
+	LookAtCameraLocation = cameraLocation;
+	LookAtTargetLocation = targetLocation;
+}
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CameraRigComponent.generated.h"
+
+/**
+ * Moves a player's camera boom and view pitch limits towards the targets set by the character when it aims, swaps shoulder or
+ * is defeated. Each value follows a critically damped spring, which eases in and out without overshooting and is solved exactly
+ * so it is stable at any frame time. Once every value has settled the component turns its own tick off, and setting a new
+ * target turns it back on, so a player who isn't changing stance costs nothing each frame.
+ */
+UCLASS()
+class UNREALSFAS_API UCameraRigComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCameraRigComponent();
+
+	void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 * Sets the boom and camera the rig moves, starting from where they are now. The speeds match the interpolation speeds of
+	 * FMath::FInterpTo: each spring settles in about the same time as the interpolation it replaces.
+	 */
+	void Initialize(class USpringArmComponent* InCameraBoom, class UCameraComponent* InCamera, float ZoomSpeed, float MoveSpeed, float PitchSpeed);
+
+	/** Sets the camera manager whose view pitch limits the rig moves, starting from its current limits. */
+	void SetCameraManager(class APlayerCameraManager* InCameraManager);
+
+	/** Sets the length and socket offset the boom moves to. */
+	void SetBoomTarget(float TargetArmLength, const FVector& TargetSocketOffset);
+
+	/** Sets the sideways socket offset the boom moves to, leaving the rest of the target as it is. Used to swap shoulders. */
+	void SetSocketOffsetTargetY(float TargetOffsetY);
+
+	/** Sets the view pitch limits the camera manager moves to. */
+	void SetViewPitchTarget(float PitchMin, float PitchMax);
+
+	/** Turns the camera to look at the component every frame, or stops it if Target is nullptr. */
+	void SetLookAtTarget(class USceneComponent* Target);
+
+	/** Returns whether the rig is still moving towards its targets. */
+	FORCEINLINE bool IsAwake() const { return IsComponentTickEnabled(); }
+
+private:
+	/** The values the rig moves. */
+	enum ERigChannel
+	{
+		ArmLength,
+		SocketOffsetX,
+		SocketOffsetY,
+		SocketOffsetZ,
+		ViewPitchMin,
+		ViewPitchMax,
+		NumChannels
+	};
+
+	/** A value following its target on a critically damped spring. */
+	struct FRigSpring
+	{
+		float Value = 0.f;
+		float Velocity = 0.f;
+		float Target = 0.f;
+		float AngularFrequency = 0.f;
+	};
+
+	/** Sets a channel's target. Wakes the rig if it changed. */
+	void SetTarget(ERigChannel Channel, float Value);
+
+	/** Advances the spring by DeltaTime. Returns true once it is within Tolerance of its target and slower than Tolerance. */
+	static bool StepSpring(FRigSpring& Spring, float DeltaTime, float Tolerance);
+
+	/** Turns the camera towards the look at target, if either has moved since it last turned. */
+	void UpdateLookAt();
+
+private:
+	UPROPERTY()
+	class USpringArmComponent* CameraBoom;
+
+	UPROPERTY()
+	class UCameraComponent* Camera;
+
+	UPROPERTY()
+	class APlayerCameraManager* CameraManager;
+
+	UPROPERTY()
+	class USceneComponent* LookAtTarget;
+
+	FRigSpring Springs[NumChannels];
+
+	/** Where the camera and look at target were when the camera last turned. */
+	FVector LookAtCameraLocation;
+	FVector LookAtTargetLocation;
+
+	///////////////////////////////////////////////////
+	/** Camera category */
+	/** How close, in units or degrees, a value has to be to its target, and how slow, to settle. */
+	UPROPERTY(EditDefaultsOnly, Category = Camera, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float SettleTolerance;
+	///////////////////////////////////////////////////
+};
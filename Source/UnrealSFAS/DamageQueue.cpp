@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DamageQueue.h"
+#include "UnrealSFAS.h"
+#include "UnrealSFASCharacter.h"
+#include "DroneCharacter.h"
+#include "ShotLatencyTracker.h"
+
+DECLARE_CYCLE_STAT(TEXT("Resolve damage"), STAT_DamageResolve, STATGROUP_SFASGameplay);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage events resolved"), STAT_DamageEventsResolved, STATGROUP_SFASGameplay);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage targets resolved"), STAT_DamageTargetsResolved, STATGROUP_SFASGameplay);
+
+FDamageQueue::FDamageQueue()
+{
+}
+
+void FDamageQueue::QueueDamage(AActor* Target, int32 Amount, AUnrealSFASCharacter* Instigator, int32 LatencyRecord)
+{
+	if (!Target)
+	{
+		return;
+	}
+
+	FDamageEvent& damageEvent = Events.AddDefaulted_GetRef();
+	damageEvent.Target = Target;
+	damageEvent.Instigator = Instigator;
+	damageEvent.Amount = Amount;
+	damageEvent.LatencyRecord = LatencyRecord;
+}
+
+void FDamageQueue::Resolve(FShotLatencyTracker& ShotLatency)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DamageResolve);
+	SET_DWORD_STAT(STAT_DamageEventsResolved, Events.Num());
+
+	if (Events.Num() == 0)
+	{
+		SET_DWORD_STAT(STAT_DamageTargetsResolved, 0);
+		return;
+	}
+
+	Swap(Events, ResolvingEvents);
+	Targets.Reset();
+	Credits.Reset();
+	CreditedLatencyRecords.Reset();
+
+	// Apply the hitpoint changes in the order the hits landed. Targets destroyed since their hit was queued are skipped.
+	for (const FDamageEvent& damageEvent : ResolvingEvents)
+	{
+		auto* target = damageEvent.Target.Get();
+		if (!target)
+		{
+			ShotLatency.EndShot(damageEvent.LatencyRecord);
+			continue;
+		}
+
+		FResolvedTarget& resolvedTarget = FindOrAddTarget(target);
+		if (resolvedTarget.Defeated)
+		{
+			ShotLatency.EndShot(damageEvent.LatencyRecord);
+			continue;
+		}
+
+		bool defeated = false;
+		if (auto* drone = Cast<ADroneCharacter>(target))
+		{
+			defeated = drone->ApplyQueuedDamage(damageEvent.Amount);
+		}
+		else if (auto* player = Cast<AUnrealSFASCharacter>(target))
+		{
+			if (player->GetDefeated())
+			{
+				ShotLatency.EndShot(damageEvent.LatencyRecord);
+				continue;
+			}
+			defeated = player->ApplyQueuedDamage(damageEvent.Amount);
+		}
+		else
+		{
+			ShotLatency.EndShot(damageEvent.LatencyRecord);
+			continue;
+		}
+		ShotLatency.MarkStage(damageEvent.LatencyRecord, EShotLatencyStage::DamageApplied);
+
+		if (damageEvent.Amount < 0)
+		{
+			resolvedTarget.Healing -= damageEvent.Amount;
+		}
+		else
+		{
+			resolvedTarget.Damage += damageEvent.Amount;
+		}
+		resolvedTarget.Defeated = defeated;
+
+		// Credit the instigating player with the damage, and with the kill if this hit defeated the target.
+		auto* instigator = damageEvent.Instigator.Get();
+		if (instigator)
+		{
+			FInstigatorCredit& credit = FindOrAddCredit(instigator);
+			credit.Damage += damageEvent.Amount;
+			credit.Kills += defeated ? 1 : 0;
+			CreditedLatencyRecords.Add(damageEvent.LatencyRecord);
+		}
+		else
+		{
+			ShotLatency.EndShot(damageEvent.LatencyRecord);
+		}
+	}
+	ResolvingEvents.Reset();
+
+	// Play each target's side effects once. Defeated drones destroy themselves here, after every hit on them has been applied.
+	for (const FResolvedTarget& resolvedTarget : Targets)
+	{
+		if (auto* drone = Cast<ADroneCharacter>(resolvedTarget.Target))
+		{
+			drone->PlayDamageEffects(resolvedTarget.Defeated);
+		}
+		else if (auto* player = Cast<AUnrealSFASCharacter>(resolvedTarget.Target))
+		{
+			player->PlayDamageEffects(resolvedTarget.Damage, resolvedTarget.Healing, resolvedTarget.Defeated);
+		}
+	}
+
+	for (const FInstigatorCredit& credit : Credits)
+	{
+		credit.Instigator->OnDamageDealt(credit.Damage, credit.Kills);
+	}
+
+	for (const int32 latencyRecord : CreditedLatencyRecords)
+	{
+		ShotLatency.MarkStage(latencyRecord, EShotLatencyStage::UIUpdated);
+		ShotLatency.EndShot(latencyRecord);
+	}
+
+	SET_DWORD_STAT(STAT_DamageTargetsResolved, Targets.Num());
+}
+
+void FDamageQueue::Reset()
+{
+	Events.Reset();
+	ResolvingEvents.Reset();
+	Targets.Reset();
+	Credits.Reset();
+	CreditedLatencyRecords.Reset();
+}
+
+FDamageQueue::FResolvedTarget& FDamageQueue::FindOrAddTarget(AActor* Target)
+{
+	for (FResolvedTarget& resolvedTarget : Targets)
+	{
+		if (resolvedTarget.Target == Target)
+		{
+			return resolvedTarget;
+		}
+	}
+
+	FResolvedTarget& resolvedTarget = Targets.AddDefaulted_GetRef();
+	resolvedTarget.Target = Target;
+	resolvedTarget.Damage = 0;
+	resolvedTarget.Healing = 0;
+	resolvedTarget.Defeated = false;
+	return resolvedTarget;
+}
+
+FDamageQueue::FInstigatorCredit& FDamageQueue::FindOrAddCredit(AUnrealSFASCharacter* Instigator)
+{
+	for (FInstigatorCredit& credit : Credits)
+	{
+		if (credit.Instigator == Instigator)
+		{
+			return credit;
+		}
+	}
+
+	FInstigatorCredit& credit = Credits.AddDefaulted_GetRef();
+	credit.Instigator = Instigator;
+	credit.Damage = 0;
+	credit.Kills = 0;
+	return credit;
+}
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A change to the hitpoints of a player or drone character, waiting to be resolved. */
+struct FDamageEvent
+{
+	/** The player or drone character damaged. */
+	TWeakObjectPtr<class AActor> Target;
+
+	/** The player credited with the damage and any kill. Unset for damage dealt by drones and pickups. */
+	TWeakObjectPtr<class AUnrealSFASCharacter> Instigator;
+
+	/** The hitpoints removed from the target. Negative amounts heal it. */
+	int32 Amount = 0;
+
+	/** The record of the shot that dealt the damage in the game mode's shot latency tracker. INDEX_NONE if it isn't timed. */
+	int32 LatencyRecord = INDEX_NONE;
+};
+
+/**
+ * Collects every hit landed in a frame and resolves them in one pass at the end of the game mode's tick, instead of each hit
+ * playing sounds, updating UI and destroying actors as it lands. The hitpoints change in the order the hits were queued, so
+ * the hit that defeats a target is the one credited with the kill and later hits on it are dropped. Then each target plays its
+ * damage effects once, handles its defeat once, and each instigating player updates its hit marker and stats once.
+ * Every source of damage goes through the queue, which makes it the single place hit detection on other threads has to feed.
+ */
+class UNREALSFAS_API FDamageQueue
+{
+public:
+	FDamageQueue();
+
+	/** Queues damage to a player or drone character. It is applied on the next call to Resolve. */
+	void QueueDamage(class AActor* Target, int32 Amount, class AUnrealSFASCharacter* Instigator = nullptr, int32 LatencyRecord = INDEX_NONE);
+
+	/** Applies the damage queued since the last call, then plays the side effects of every target and instigator hit. Ends the latency record of every event. */
+	void Resolve(class FShotLatencyTracker& ShotLatency);
+
+	/** Drops the damage still queued. */
+	void Reset();
+
+	FORCEINLINE int32 NumQueued() const { return Events.Num(); }
+
+private:
+	/** The damage a target took this pass. */
+	struct FResolvedTarget
+	{
+		class AActor* Target;
+		int32 Damage;
+		int32 Healing;
+
+		/** Whether the target was defeated this pass. Later hits on it are dropped. */
+		bool Defeated;
+	};
+
+	/** The damage dealt by a player this pass. */
+	struct FInstigatorCredit
+	{
+		class AUnrealSFASCharacter* Instigator;
+		int32 Damage;
+		int32 Kills;
+	};
+
+	/** Returns the resolved target entry of Target, adding it if this is its first hit in the pass. */
+	FResolvedTarget& FindOrAddTarget(class AActor* Target);
+
+	/** Returns the credit entry of Instigator, adding it if this is its first hit in the pass. */
+	FInstigatorCredit& FindOrAddCredit(class AUnrealSFASCharacter* Instigator);
+
+private:
+	TArray<FDamageEvent> Events;
+
+	/** The events being resolved. Damage queued by side effects during a pass waits for the next one. Scratch storage. */
+	TArray<FDamageEvent> ResolvingEvents;
+
+	/** Scratch storage for a pass. Few targets are hit each frame, so they are searched linearly. */
+	TArray<FResolvedTarget> Targets;
+	TArray<FInstigatorCredit> Credits;
+
+	/** The latency records of the events credited to a player, ended once the players' hit markers are updated. Scratch storage. */
+	TArray<int32> CreditedLatencyRecords;
+};
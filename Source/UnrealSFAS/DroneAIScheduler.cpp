@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneAIScheduler.h"
+#include "UnrealSFAS.h"
+#include "DroneRegistry.h"
+#include "DroneCharacter.h"
+#include "DroneBehaviorTreeComponent.h"
+#include "AIController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fixed rate AI"), STAT_DroneAISchedule, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI sub-ticks"), STAT_DroneAISubTicks, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Behavior trees ticked"), STAT_DroneAIBehaviorTreesTicked, STATGROUP_SFASDrones);
+
+namespace DroneAIScheduler
+{
+	/** Returns the drone's behavior tree component, or nullptr if it doesn't use a drone behavior tree component. */
+	static UDroneBehaviorTreeComponent* GetBehaviorTree(const ADroneCharacter* Drone)
+	{
+		auto* aiController = Cast<AAIController>(Drone->GetController());
+		return aiController ? Cast<UDroneBehaviorTreeComponent>(aiController->GetBrainComponent()) : nullptr;
+	}
+}
+
+FDroneAIScheduleSettings::FDroneAIScheduleSettings()
+{
+	// Set default member values.
+	UpdateRate = 15.f;
+	NumSubTicks = 4;
+	MaxSubTicksPerFrame = 8;
+}
+
+FDroneAIScheduler::FDroneAIScheduler()
+{
+	// Set default member values.
+	AccumulatedSeconds = 0.f;
+	SimulationSeconds = 0.0;
+	NextSubTick = 0;
+	WasEnabled = false;
+}
+
+void FDroneAIScheduler::Tick(float DeltaSeconds, const FDroneRegistry& Registry, const FDroneAIScheduleSettings& Settings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneAISchedule);
+
+	// Hand the behavior trees back to the engine's tick while fixed rate AI is disabled.
+	const bool enabled = UDroneBehaviorTreeComponent::IsFixedRateEnabled();
+	if (enabled != WasEnabled)
+	{
+		WasEnabled = enabled;
+		AccumulatedSeconds = 0.f;
+		NextSubTick = 0;
+		if (!enabled)
+		{
+			SetAllScheduled(false, Registry);
+		}
+	}
+
+	if (!enabled)
+	{
+		return;
+	}
+
+	const int32 numSubTicks = FMath::Max(Settings.NumSubTicks, 1);
+	const float subTickSeconds = 1.f / (FMath::Max(Settings.UpdateRate, 1.f) * numSubTicks);
+
+	// Run every sub-tick that is due, dropping the remainder after a frame long enough to exceed the budget.
+	AccumulatedSeconds += DeltaSeconds;
+	int32 numRun = 0;
+	while (AccumulatedSeconds >= subTickSeconds)
+	{
+		if (numRun >= Settings.MaxSubTicksPerFrame)
+		{
+			AccumulatedSeconds = FMath::Fmod(AccumulatedSeconds, subTickSeconds);
+			break;
+		}
+
+		AccumulatedSeconds -= subTickSeconds;
+		SimulationSeconds += subTickSeconds;
+
+		RunSubTick(NextSubTick, numSubTicks, Registry);
+		NextSubTick = (NextSubTick + 1) % numSubTicks;
+		numRun++;
+	}
+
+	SET_DWORD_STAT(STAT_DroneAISubTicks, numRun);
+}
+
+void FDroneAIScheduler::RunSubTick(int32 SubTick, int32 NumSubTicks, const FDroneRegistry& Registry)
+{
+	// Shares are keyed on the handle rather than the dense index, which changes whenever another drone is removed.
+	const auto& handles = Registry.GetHandles();
+
+	int32 numTicked = 0;
+	for (int32 i = 0; i < Registry.Num(); i++)
+	{
+		if ((handles[i].Index % NumSubTicks) != SubTick)
+		{
+			continue;
+		}
+
+		auto* behaviorTree = DroneAIScheduler::GetBehaviorTree(Registry.GetActor(i));
+		if (!behaviorTree)
+		{
+			continue;
+		}
+
+		// Drones spawned since the last sub-tick are taken over from the engine's tick. Their first scheduled tick comes one update later.
+		if (!behaviorTree->GetScheduled())
+		{
+			behaviorTree->SetScheduled(true, SimulationSeconds);
+			continue;
+		}
+
+		behaviorTree->TickScheduled(SimulationSeconds);
+		numTicked++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_DroneAIBehaviorTreesTicked, numTicked);
+}
+
+void FDroneAIScheduler::SetAllScheduled(bool Scheduled, const FDroneRegistry& Registry)
+{
+	for (int32 i = 0; i < Registry.Num(); i++)
+	{
+		auto* behaviorTree = DroneAIScheduler::GetBehaviorTree(Registry.GetActor(i));
+		if (behaviorTree && (behaviorTree->GetScheduled() != Scheduled))
+		{
+			behaviorTree->SetScheduled(Scheduled, SimulationSeconds);
+		}
+	}
+}
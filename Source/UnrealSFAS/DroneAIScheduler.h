@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneAIScheduler.generated.h"
+
+class FDroneRegistry;
+
+/** The fixed rate drone AI runs at and how its work is spread across frames. */
+USTRUCT(BlueprintType)
+struct FDroneAIScheduleSettings
+{
+	GENERATED_BODY()
+
+	FDroneAIScheduleSettings();
+
+	/** How many times a second each drone's behavior tree is ticked. */
+	UPROPERTY(EditDefaultsOnly, Category = Schedule, meta = (ClampMin = "1", ClampMax = "60"))
+	float UpdateRate;
+
+	/** The number of sub-ticks each update is split into. Each sub-tick ticks an even share of the drones. */
+	UPROPERTY(EditDefaultsOnly, Category = Schedule, meta = (ClampMin = "1"))
+	int32 NumSubTicks;
+
+	/** The most sub-ticks run in one frame. Time beyond this is dropped after a long frame so the AI doesn't fall further behind. */
+	UPROPERTY(EditDefaultsOnly, Category = Schedule, meta = (ClampMin = "1"))
+	int32 MaxSubTicksPerFrame;
+};
+
+/**
+ * Ticks drone behavior trees at a fixed rate, independent of the frame rate. Each update is split into sub-ticks run at an even
+ * spacing, and each sub-tick ticks the drones whose handle index falls in its share, so every frame does about the same amount
+ * of AI work and a drone keeps its place in the update when other drones are removed. Behavior trees always see the fixed step time, so AI behaves the same at any frame rate.
+ *
+ * Movement is unaffected: path following and drone movement still run every frame towards the goal of the latest decision.
+ */
+class UNREALSFAS_API FDroneAIScheduler
+{
+public:
+	FDroneAIScheduler();
+
+	/** Runs the sub-ticks due this frame. */
+	void Tick(float DeltaSeconds, const FDroneRegistry& Registry, const FDroneAIScheduleSettings& Settings);
+
+private:
+	/** Ticks the behavior trees of the drones in the sub-tick's share. */
+	void RunSubTick(int32 SubTick, int32 NumSubTicks, const FDroneRegistry& Registry);
+
+	/** Stops or starts scheduling every drone's behavior tree. */
+	void SetAllScheduled(bool Scheduled, const FDroneRegistry& Registry);
+
+private:
+	/** Frame time not yet simulated. */
+	float AccumulatedSeconds;
+
+	/** Simulated AI time, advanced by one sub-tick at a time. */
+	double SimulationSeconds;
+
+	/** The next sub-tick to run. */
+	int32 NextSubTick;
+
+	/** Whether fixed rate AI was enabled last frame. */
+	bool WasEnabled;
+};
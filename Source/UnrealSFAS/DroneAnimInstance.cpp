@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneAnimInstance.h"
+#include "UnrealSFAS.h"
+#include "GameFramework/Character.h"
+
+DECLARE_CYCLE_STAT(TEXT("Anim game thread copy"), STAT_DroneAnimGameThreadCopy, STATGROUP_SFASDrones);
+DECLARE_CYCLE_STAT(TEXT("Anim thread safe update"), STAT_DroneAnimThreadSafeUpdate, STATGROUP_SFASDrones);
+
+UDroneAnimInstance::UDroneAnimInstance()
+{
+	// Set default member values.
+	Drone = nullptr;
+	Velocity = FVector::ZeroVector;
+	Speed = 0.f;
+}
+
+void UDroneAnimInstance::NativeInitializeAnimation()
+{
+	Super::NativeInitializeAnimation();
+
+	Drone = Cast<ACharacter>(TryGetPawnOwner());
+}
+
+void UDroneAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeUpdateAnimation(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_DroneAnimGameThreadCopy);
+
+	// Only copy what the thread safe update needs. Everything else happens off the game thread.
+	if (Drone)
+	{
+		Velocity = Drone->GetVelocity();
+	}
+}
+
+void UDroneAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_DroneAnimThreadSafeUpdate);
+
+	Speed = Velocity.Size2D();
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "DroneAnimInstance.generated.h"
+
+/**
+ * Native animation instance of the drone. The drone's movement is copied once per frame on the game thread, and the values
+ * the animation graph reads are worked out in NativeThreadSafeUpdateAnimation so the update can run on a worker thread.
+ * The animation blueprint should have no event graph so the engine can update every drone in parallel.
+ *
+ * The drone's animation blueprint is still parented to UAnimInstance and only plays its looping animation. It has to be
+ * reparented to this class before the graph can read Speed.
+ */
+UCLASS()
+class UNREALSFAS_API UDroneAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+	UDroneAnimInstance();
+
+protected:
+	void NativeInitializeAnimation() override;
+	void NativeUpdateAnimation(float DeltaSeconds) override;
+	void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
+private:
+	/** The drone being animated. */
+	UPROPERTY(Transient)
+	class ACharacter* Drone;
+
+	/** Inputs copied from the drone on the game thread. */
+	FVector Velocity;
+
+	/** The drone's speed. */
+	UPROPERTY(BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	float Speed;
+};
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneArchetype.h"
+#include "Pickup.h"
+#include "Sound/SoundBase.h"
+#include "UObject/ConstructorHelpers.h"
+
+UDroneArchetype::UDroneArchetype()
+{
+	// Default to the motor loop the drone's own audio component used to play.
+	static ConstructorHelpers::FObjectFinder<USoundBase> MotorSoundAsset(TEXT("SoundWave'/Game/Audio/Drone/drone_flying.drone_flying'"));
+
+	// Set default member values.
+	BaseHitpoints = 100;
+	HitpointsPerWave = 5;
+	HitProxyRadius = 50.f;
+	MaxShotDistance = 1000.f;
+	ShotProjectileSpeed = 0.f;
+	MinShotDamage = 1;
+	MaxShotDamage = 5;
+	MuzzleFlashEmitterTemplate = nullptr;
+	ExplosionEmitterTemplate = nullptr;
+	MotorSound = MotorSoundAsset.Object;
+	DefaultMotorAudioPitchMultiplier = 0.125f;
+	MaxMotorAudioPitchMultiplierModifier = 4.f;
+	FireSound = nullptr;
+	BulletImpactSound = nullptr;
+	DestroyedSound = nullptr;
+	PickupDropRate = 0.5f;
+	PickupClassToDrop = nullptr;
+}
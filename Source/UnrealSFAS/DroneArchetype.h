@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "DroneArchetype.generated.h"
+
+/**
+ * Tuning data shared by every drone of a type. Drones and their AI controllers keep a pointer to their archetype and read
+ * their tuning from it, so each drone only stores its own changing state. Drones without an archetype use the defaults of
+ * this class.
+ */
+UCLASS(BlueprintType)
+class UNREALSFAS_API UDroneArchetype : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UDroneArchetype();
+
+	FORCEINLINE int GetBaseHitpoints() const { return BaseHitpoints; }
+	FORCEINLINE int GetHitpointsPerWave() const { return HitpointsPerWave; }
+	FORCEINLINE float GetHitProxyRadius() const { return HitProxyRadius; }
+	FORCEINLINE float GetMaxShotDistance() const { return MaxShotDistance; }
+	FORCEINLINE float GetShotProjectileSpeed() const { return ShotProjectileSpeed; }
+	FORCEINLINE int GetMinShotDamage() const { return MinShotDamage; }
+	FORCEINLINE int GetMaxShotDamage() const { return MaxShotDamage; }
+	FORCEINLINE UParticleSystem* GetMuzzleFlashEmitterTemplate() const { return MuzzleFlashEmitterTemplate; }
+	FORCEINLINE UParticleSystem* GetExplosionEmitterTemplate() const { return ExplosionEmitterTemplate; }
+	FORCEINLINE float GetDefaultMotorAudioPitchMultiplier() const { return DefaultMotorAudioPitchMultiplier; }
+	FORCEINLINE float GetMaxMotorAudioPitchMultiplierModifier() const { return MaxMotorAudioPitchMultiplierModifier; }
+	FORCEINLINE USoundBase* GetMotorSound() const { return MotorSound; }
+	FORCEINLINE USoundBase* GetFireSound() const { return FireSound; }
+	FORCEINLINE USoundBase* GetBulletImpactSound() const { return BulletImpactSound; }
+	FORCEINLINE USoundBase* GetDestroyedSound() const { return DestroyedSound; }
+	FORCEINLINE float GetPickupDropRate() const { return PickupDropRate; }
+	FORCEINLINE TSubclassOf<class APickup> GetPickupClassToDrop() const { return PickupClassToDrop; }
+
+private:
+	/** Drones fill in an archetype from their deprecated tuning properties until their blueprint is given an archetype asset. */
+	friend class ADroneCharacter;
+
+	///////////////////////////////////////////////
+	/** Damage category */
+	/** The hitpoints a drone of this type spawns with. */
+	UPROPERTY(EditDefaultsOnly, Category = Damage, meta = (AllowPrivateAccess = "true"))
+	int BaseHitpoints;
+
+	/** The hitpoints added to drones of this type for each wave the game has reached. */
+	UPROPERTY(EditDefaultsOnly, Category = Damage, meta = (AllowPrivateAccess = "true"))
+	int HitpointsPerWave;
+
+	/** The radius of the sphere around the drone that shots are tested against. */
+	UPROPERTY(EditDefaultsOnly, Category = Damage, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float HitProxyRadius;
+	///////////////////////////////////////////////
+	/** Drone AI category */
+	/** The furthest distance the drone can shoot a player from. */
+	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true"))
+	float MaxShotDistance;
+
+	/** The speed of the projectiles the drone fires. 0 fires instant hitscan shots. Projectiles fly until they have travelled MaxShotDistance. */
+	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float ShotProjectileSpeed;
+
+	/** The least damage a drone shot deals. */
+	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true"))
+	int MinShotDamage;
+
+	/** The most damage a drone shot deals. */
+	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true"))
+	int MaxShotDamage;
+	///////////////////////////////////////////////
+	/** Particles category */
+	/** The particle emitter template to use to create a muzzle flash effect when the drone fires. */
+	UPROPERTY(EditDefaultsOnly, Category = Particles, meta = (AllowPrivateAccess = "true"))
+	UParticleSystem* MuzzleFlashEmitterTemplate;
+
+	/** The particle emitter template to use to play an explosion. */
+	UPROPERTY(EditDefaultsOnly, Category = Particles, meta = (AllowPrivateAccess = "true"))
+	UParticleSystem* ExplosionEmitterTemplate;
+	///////////////////////////////////////////////
+	/** Audio category */
+	/** The looping motor sound. Played by the game mode's drone audio manager for the drones nearest the players. Defaults to drone_flying. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	USoundBase* MotorSound;
+
+	/** The pitch multiplier of the motor audio when the drone is stationary. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	float DefaultMotorAudioPitchMultiplier;
+
+	/** The maximum value that can be set as the pitch multiplier. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	float MaxMotorAudioPitchMultiplierModifier;
+
+	/** The sound to play when the drone fires. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	USoundBase* FireSound;
+
+	/** The sound to play when the drone is shot. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	USoundBase* BulletImpactSound;
+
+	/** The sound to play when the drone is destroyed. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	USoundBase* DestroyedSound;
+	///////////////////////////////////////////////
+	/** Pickup category */
+	/** Determines the rate at which the drone drops a pickup when it is destroyed. In the range 0 - 1, 1 is more likely to drop a pickup. */
+	UPROPERTY(EditDefaultsOnly, Category = Pickup, meta = (AllowPrivateAccess = "true", ClampMin = "0", ClampMax = "1"))
+	float PickupDropRate;
+
+	/** The pickup class to spawn if the drone drops a pickup. */
+	UPROPERTY(EditDefaultsOnly, Category = Pickup, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<class APickup> PickupClassToDrop;
+	///////////////////////////////////////////////
+};
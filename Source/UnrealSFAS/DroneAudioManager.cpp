@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneAudioManager.h"
+#include "UnrealSFAS.h"
+#include "DroneSignificance.h"
+#include "DroneCharacter.h"
+#include "DroneArchetype.h"
+#include "DroneSwarm.h"
+#include "Components/AudioComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update audio"), STAT_DroneAudio, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Motor voices playing"), STAT_DroneMotorVoices, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Motor pitch updates pushed"), STAT_DroneMotorPitchPushes, STATGROUP_SFASDrones);
+
+FDroneAudioSettings::FDroneAudioSettings()
+{
+	// Set default member values.
+	MaxMotorVoices = 8;
+	VoiceSelectionInterval = 0.1f;
+	VoiceRadius = 2500.f;
+	VoiceHysteresis = 0.8f;
+	VoiceVolume = 0.75f;
+	Attenuation = nullptr;
+	PitchUpdateThreshold = 0.02f;
+	CrowdBedSound = nullptr;
+	CrowdRadius = 3000.f;
+	CrowdSaturationCount = 20.f;
+	CrowdMaxVolume = 1.f;
+	CrowdVolumeInterpSpeed = 2.f;
+}
+
+FDroneAudioManager::FDroneAudioManager()
+{
+	// Set default member values.
+	TimeUntilSelection = 0.f;
+}
+
+void FDroneAudioManager::Tick(float DeltaSeconds, AActor* Owner, const FDroneRegistry& Registry, const ADroneSwarm* Swarm, const TArray<FDroneSignificanceViewpoint>& Listeners,
+	const FDroneSignificanceSettings& SignificanceSettings, const FDroneAudioSettings& Settings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneAudio);
+
+	if (!Owner)
+	{
+		return;
+	}
+
+	// Create the voice pool the first time it is needed, so the number of audio components never depends on the wave size.
+	while (Voices.Num() < Settings.MaxMotorVoices)
+	{
+		FMotorVoice& voice = Voices.AddDefaulted_GetRef();
+		voice.Component = CreateAudioComponent(Owner, Settings.Attenuation);
+		voice.Component->SetVolumeMultiplier(Settings.VoiceVolume);
+		voice.Pitch = 0.f;
+	}
+
+	TimeUntilSelection -= DeltaSeconds;
+	if (TimeUntilSelection <= 0.f)
+	{
+		TimeUntilSelection = Settings.VoiceSelectionInterval;
+		SelectVoices(Registry, Swarm, Listeners, SignificanceSettings, Settings);
+	}
+
+	// Keep each voice on its drone and push pitch changes that are large enough to hear.
+	const TArray<FVector>& positions = Registry.GetPositions();
+	const TArray<float>& motorPitches = Registry.GetMotorPitches();
+	uint32 playing = 0;
+	uint32 pushes = 0;
+	for (FMotorVoice& voice : Voices)
+	{
+		if (!voice.Drone.IsSet())
+		{
+			continue;
+		}
+
+		const int32 denseIndex = Registry.GetDenseIndex(voice.Drone);
+		if (denseIndex == INDEX_NONE)
+		{
+			FreeVoice(voice);
+			continue;
+		}
+
+		voice.Component->SetWorldLocation(positions[denseIndex]);
+		if (FMath::Abs(motorPitches[denseIndex] - voice.Pitch) > Settings.PitchUpdateThreshold)
+		{
+			voice.Pitch = motorPitches[denseIndex];
+			voice.Component->SetPitchMultiplier(voice.Pitch);
+			pushes++;
+		}
+		playing++;
+	}
+
+	UpdateCrowdBeds(DeltaSeconds, Owner, Listeners, Settings);
+
+	SET_DWORD_STAT(STAT_DroneMotorVoices, playing);
+	SET_DWORD_STAT(STAT_DroneMotorPitchPushes, pushes);
+}
+
+void FDroneAudioManager::Reset()
+{
+	Voices.Reset();
+	CrowdBeds.Reset();
+	CrowdVolumes.Reset();
+	CrowdTargetVolumes.Reset();
+	TimeUntilSelection = 0.f;
+}
+
+void FDroneAudioManager::SelectVoices(const FDroneRegistry& Registry, const ADroneSwarm* Swarm, const TArray<FDroneSignificanceViewpoint>& Listeners,
+	const FDroneSignificanceSettings& SignificanceSettings, const FDroneAudioSettings& Settings)
+{
+	const int32 count = Registry.Num();
+	const TArray<FVector>& positions = Registry.GetPositions();
+	const TArray<EDroneStateFlags>& flags = Registry.GetFlags();
+	const TArray<EDroneSignificance>& significance = Registry.GetSignificance();
+
+	// Mark the drones that already have a voice.
+	Voiced.Reset();
+	Voiced.SetNumZeroed(count);
+	for (FMotorVoice& voice : Voices)
+	{
+		if (voice.Drone.IsSet())
+		{
+			const int32 denseIndex = Registry.GetDenseIndex(voice.Drone);
+			if (denseIndex == INDEX_NONE)
+			{
+				FreeVoice(voice);
+			}
+			else
+			{
+				Voiced[denseIndex] = true;
+			}
+		}
+	}
+
+	// Rate every alive drone whose significance tier allows motor audio by its distance to the nearest listener. Voiced drones
+	// are treated as closer than they are so a drone only takes a voice from another when it is clearly nearer.
+	Candidates.Reset();
+	const float voiceRadiusSquared = FMath::Square(Settings.VoiceRadius);
+	const float hysteresisSquared = FMath::Square(Settings.VoiceHysteresis);
+	for (int32 n = 0; n < count; n++)
+	{
+		if (!EnumHasAnyFlags(flags[n], EDroneStateFlags::Alive) || !SignificanceSettings.GetTierSettings(significance[n]).MotorAudioActive)
+		{
+			continue;
+		}
+
+		float nearestDistanceSquared = BIG_NUMBER;
+		for (const FDroneSignificanceViewpoint& listener : Listeners)
+		{
+			nearestDistanceSquared = FMath::Min(nearestDistanceSquared, static_cast<float>(FVector::DistSquared(positions[n], listener.ViewLocation)));
+		}
+
+		if (nearestDistanceSquared <= voiceRadiusSquared)
+		{
+			Candidates.Emplace(Voiced[n] ? nearestDistanceSquared * hysteresisSquared : nearestDistanceSquared, n);
+		}
+	}
+
+	const int32 numSelected = FMath::Min(Candidates.Num(), Voices.Num());
+	if (Candidates.Num() > numSelected)
+	{
+		Candidates.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+	}
+
+	// Free the voices of drones that are no longer selected, then hand the free voices to selected drones without one.
+	Selected.Reset();
+	Selected.SetNumZeroed(count);
+	for (int32 i = 0; i < numSelected; i++)
+	{
+		Selected[Candidates[i].Value] = true;
+	}
+
+	for (FMotorVoice& voice : Voices)
+	{
+		if (voice.Drone.IsSet())
+		{
+			const int32 denseIndex = Registry.GetDenseIndex(voice.Drone);
+			if (!Selected[denseIndex])
+			{
+				Voiced[denseIndex] = false;
+				FreeVoice(voice);
+			}
+		}
+	}
+
+	const TArray<FDroneHandle>& handles = Registry.GetHandles();
+	const TArray<float>& motorPitches = Registry.GetMotorPitches();
+	int32 voiceIndex = 0;
+	for (int32 i = 0; i < numSelected; i++)
+	{
+		const int32 denseIndex = Candidates[i].Value;
+		if (Voiced[denseIndex])
+		{
+			continue;
+		}
+
+		while (Voices[voiceIndex].Drone.IsSet())
+		{
+			voiceIndex++;
+		}
+
+		FMotorVoice& voice = Voices[voiceIndex];
+		USoundBase* motorSound = Registry.GetActor(denseIndex)->GetArchetype()->GetMotorSound();
+		if (!motorSound)
+		{
+			continue;
+		}
+
+		voice.Drone = handles[denseIndex];
+		voice.Pitch = motorPitches[denseIndex];
+		voice.Component->SetSound(motorSound);
+		voice.Component->SetWorldLocation(positions[denseIndex]);
+		voice.Component->SetPitchMultiplier(voice.Pitch);
+		voice.Component->Play();
+		Voiced[denseIndex] = true;
+	}
+
+	// Every other drone is heard through the crowd bed of each listener, louder the more drones are close to it.
+	CrowdTargetVolumes.Reset();
+	CrowdTargetVolumes.SetNumZeroed(Listeners.Num());
+	const float crowdRadius = FMath::Max(Settings.CrowdRadius, KINDA_SMALL_NUMBER);
+	const float crowdRadiusSquared = FMath::Square(crowdRadius);
+	for (int32 l = 0; l < Listeners.Num(); l++)
+	{
+		const FVector& listenerLocation = Listeners[l].ViewLocation;
+		float intensity = 0.f;
+		for (int32 n = 0; n < count; n++)
+		{
+			if (Voiced[n] || !EnumHasAnyFlags(flags[n], EDroneStateFlags::Alive))
+			{
+				continue;
+			}
+
+			const float distanceSquared = FVector::DistSquared(positions[n], listenerLocation);
+			if (distanceSquared < crowdRadiusSquared)
+			{
+				intensity += 1.f - (FMath::Sqrt(distanceSquared) / crowdRadius);
+			}
+		}
+
+		// Swarm drones never have a voice, so they are only ever heard through the crowd bed.
+		if (Swarm)
+		{
+			const FDroneSwarmSimulation& swarm = Swarm->GetSimulation();
+			for (int32 s = 0; s < swarm.Num(); s++)
+			{
+				const float distanceSquared = FVector::DistSquared(swarm.GetLocation(s), listenerLocation);
+				if (distanceSquared < crowdRadiusSquared)
+				{
+					intensity += 1.f - (FMath::Sqrt(distanceSquared) / crowdRadius);
+				}
+			}
+		}
+
+		CrowdTargetVolumes[l] = FMath::Clamp(intensity / Settings.CrowdSaturationCount, 0.f, 1.f) * Settings.CrowdMaxVolume;
+	}
+}
+
+void FDroneAudioManager::UpdateCrowdBeds(float DeltaSeconds, AActor* Owner, const TArray<FDroneSignificanceViewpoint>& Listeners, const FDroneAudioSettings& Settings)
+{
+	if (!Settings.CrowdBedSound)
+	{
+		return;
+	}
+
+	while (CrowdBeds.Num() < Listeners.Num())
+	{
+		// The crowd bed follows its listener, so it isn't attenuated.
+		UAudioComponent* crowdBed = CreateAudioComponent(Owner, nullptr);
+		crowdBed->SetSound(Settings.CrowdBedSound);
+		CrowdBeds.Add(crowdBed);
+		CrowdVolumes.Add(0.f);
+	}
+
+	for (int32 l = 0; l < CrowdBeds.Num(); l++)
+	{
+		UAudioComponent* crowdBed = CrowdBeds[l];
+		const float targetVolume = CrowdTargetVolumes.IsValidIndex(l) ? CrowdTargetVolumes[l] : 0.f;
+		CrowdVolumes[l] = FMath::FInterpTo(CrowdVolumes[l], targetVolume, DeltaSeconds, Settings.CrowdVolumeInterpSpeed);
+
+		// Stop beds that have faded out so silent loops don't hold a voice.
+		if (CrowdVolumes[l] <= KINDA_SMALL_NUMBER)
+		{
+			if (crowdBed->IsPlaying())
+			{
+				crowdBed->Stop();
+			}
+			continue;
+		}
+
+		if (Listeners.IsValidIndex(l))
+		{
+			crowdBed->SetWorldLocation(Listeners[l].ViewLocation);
+		}
+		crowdBed->SetVolumeMultiplier(CrowdVolumes[l]);
+		if (!crowdBed->IsPlaying())
+		{
+			crowdBed->Play();
+		}
+	}
+}
+
+void FDroneAudioManager::FreeVoice(FMotorVoice& Voice)
+{
+	Voice.Component->Stop();
+	Voice.Drone.Reset();
+}
+
+UAudioComponent* FDroneAudioManager::CreateAudioComponent(AActor* Owner, USoundAttenuation* Attenuation)
+{
+	UAudioComponent* component = NewObject<UAudioComponent>(Owner);
+	component->bAutoActivate = false;
+	component->bAutoDestroy = false;
+	component->AttenuationSettings = Attenuation;
+	component->RegisterComponent();
+	return component;
+}
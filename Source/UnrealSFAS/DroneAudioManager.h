@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneRegistry.h"
+#include "DroneAudioManager.generated.h"
+
+struct FDroneSignificanceViewpoint;
+struct FDroneSignificanceSettings;
+
+/** How many drones get their own motor voice and how the rest are heard. */
+USTRUCT(BlueprintType)
+struct FDroneAudioSettings
+{
+	GENERATED_BODY()
+
+	FDroneAudioSettings();
+
+	/** The most drones with their own motor voice at once. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (ClampMin = "0"))
+	int32 MaxMotorVoices;
+
+	/** Seconds between choosing which drones have a motor voice. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	float VoiceSelectionInterval;
+
+	/** Only drones closer than this to a listener can have a motor voice. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	float VoiceRadius;
+
+	/** Drones with a voice keep it until another drone is this much closer, in the range 0 - 1, so voices don't swap back and forth. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (ClampMin = "0", ClampMax = "1"))
+	float VoiceHysteresis;
+
+	/** The volume multiplier of each motor voice. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	float VoiceVolume;
+
+	/** How the motor voices fade with distance. Defaults to the drone buzz attenuation the drone's own audio component used. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	class USoundAttenuation* Attenuation;
+
+	/** The smallest change in a drone's motor pitch that is pushed to its voice. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	float PitchUpdateThreshold;
+
+	/** Set in the derived blueprint. The looping sound of the drones without a voice. No crowd bed plays if unset. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	USoundBase* CrowdBedSound;
+
+	/** Drones without a voice closer than this to a listener add to the listener's crowd bed, more the closer they are. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	float CrowdRadius;
+
+	/** The crowd bed plays at full volume once this many drones at the listener's location would be heard. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (ClampMin = "1"))
+	float CrowdSaturationCount;
+
+	/** The volume multiplier of the crowd bed at full intensity. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	float CrowdMaxVolume;
+
+	/** How quickly the crowd bed volume follows the drones around the listener. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio)
+	float CrowdVolumeInterpSpeed;
+};
+
+/**
+ * Plays drone motor audio from a fixed pool of voices instead of an audio component per drone. The drones nearest to the
+ * listeners get a real voice that follows them and plays their motor pitch, if their significance tier allows motor audio.
+ * Every other drone, swarm drones included, is only heard through a crowd bed per listener, whose volume follows how many
+ * drones are around that listener. The number of playing sounds stays the same however large the wave is.
+ */
+class UNREALSFAS_API FDroneAudioManager
+{
+public:
+	FDroneAudioManager();
+
+	/**
+	 * Updates the voices and crowd beds. The audio components are created on Owner. Listeners are the players' points of view.
+	 * Swarm may be nullptr.
+	 */
+	void Tick(float DeltaSeconds, AActor* Owner, const FDroneRegistry& Registry, const class ADroneSwarm* Swarm, const TArray<FDroneSignificanceViewpoint>& Listeners,
+		const FDroneSignificanceSettings& SignificanceSettings, const FDroneAudioSettings& Settings);
+
+	/** Forgets every voice and crowd bed. Their audio components are destroyed with their owner. */
+	void Reset();
+
+private:
+	struct FMotorVoice
+	{
+		class UAudioComponent* Component;
+
+		/** The drone the voice plays for. Unset if the voice is free. */
+		FDroneHandle Drone;
+
+		/** The pitch last pushed to the voice. */
+		float Pitch;
+	};
+
+	/** Chooses which drones have a voice, hands out free voices and works out how loud each listener's crowd bed should be. */
+	void SelectVoices(const FDroneRegistry& Registry, const class ADroneSwarm* Swarm, const TArray<FDroneSignificanceViewpoint>& Listeners,
+		const FDroneSignificanceSettings& SignificanceSettings, const FDroneAudioSettings& Settings);
+
+	/** Moves each listener's crowd bed towards the volume chosen at the last selection. */
+	void UpdateCrowdBeds(float DeltaSeconds, AActor* Owner, const TArray<FDroneSignificanceViewpoint>& Listeners, const FDroneAudioSettings& Settings);
+
+	/** Stops the voice and frees it. */
+	static void FreeVoice(FMotorVoice& Voice);
+
+	/** Creates a registered audio component on the owner that only plays when told to. Attenuation may be nullptr. */
+	static class UAudioComponent* CreateAudioComponent(AActor* Owner, class USoundAttenuation* Attenuation);
+
+private:
+	/** The motor voices. Their audio components are owned by the actor passed to Tick. */
+	TArray<FMotorVoice> Voices;
+
+	/** The crowd bed of each listener. Owned by the actor passed to Tick. */
+	TArray<class UAudioComponent*> CrowdBeds;
+
+	/** The current and target volume of each crowd bed. */
+	TArray<float> CrowdVolumes;
+	TArray<float> CrowdTargetVolumes;
+
+	/** Seconds until voices are next chosen. */
+	float TimeUntilSelection;
+
+	/** Whether the drone at each dense index has a voice. Scratch storage. */
+	TArray<bool> Voiced;
+
+	/** Whether the drone at each dense index was chosen for a voice. Scratch storage. */
+	TArray<bool> Selected;
+
+	/** Drones close enough for a voice, as distance squared to the nearest listener and dense index. Scratch storage. */
+	TArray<TPair<float, int32>> Candidates;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneBehaviorTreeComponent.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarDroneAIFixedRate(
+	TEXT("SFAS.DroneAI.FixedRate"),
+	1,
+	TEXT("1: drone behavior trees are ticked at a fixed rate by the game mode. 0: drone behavior trees tick themselves every frame."),
+	ECVF_Default);
+
+UDroneBehaviorTreeComponent::UDroneBehaviorTreeComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Set default member values.
+	LastTickSimulationSeconds = 0.0;
+	ScheduledTickInterval = 0.f;
+	IsScheduled = false;
+	IsTickingScheduled = false;
+}
+
+void UDroneBehaviorTreeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	// The behavior tree can turn its own tick back on, so engine ticks of a scheduled component are ignored here as well.
+	if (IsScheduled && !IsTickingScheduled)
+	{
+		return;
+	}
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
+
+bool UDroneBehaviorTreeComponent::IsFixedRateEnabled()
+{
+	return CVarDroneAIFixedRate.GetValueOnGameThread() != 0;
+}
+
+void UDroneBehaviorTreeComponent::SetScheduled(bool Scheduled, double SimulationSeconds)
+{
+	IsScheduled = Scheduled;
+	LastTickSimulationSeconds = SimulationSeconds;
+
+	// Scheduled components are ticked by the game mode rather than ticking themselves.
+	SetComponentTickEnabled(!Scheduled);
+}
+
+void UDroneBehaviorTreeComponent::SetScheduledTickInterval(float Interval)
+{
+	ScheduledTickInterval = Interval;
+}
+
+void UDroneBehaviorTreeComponent::TickScheduled(double SimulationSeconds)
+{
+	const float deltaSeconds = static_cast<float>(SimulationSeconds - LastTickSimulationSeconds);
+	if ((deltaSeconds <= 0.f) || (deltaSeconds < ScheduledTickInterval) || !IsRegistered())
+	{
+		return;
+	}
+	LastTickSimulationSeconds = SimulationSeconds;
+
+	TGuardValue<bool> tickingScheduledGuard(IsTickingScheduled, true);
+	TickComponent(deltaSeconds, LEVELTICK_All, &PrimaryComponentTick);
+}
+
+double UDroneBehaviorTreeComponent::GetAITimeSeconds() const
+{
+	// The last scheduled tick's time is the current time while a scheduled tick runs.
+	if (IsScheduled)
+	{
+		return LastTickSimulationSeconds;
+	}
+
+	auto* world = GetWorld();
+	return world ? world->GetTimeSeconds() : 0.0;
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "DroneBehaviorTreeComponent.generated.h"
+
+/**
+ * Behavior tree component of a drone that can be ticked at a fixed rate by the game mode's drone AI scheduler instead of
+ * ticking itself every frame. Scheduled components ignore the engine's tick and are ticked with the fixed step time.
+ */
+UCLASS()
+class UNREALSFAS_API UDroneBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+	GENERATED_BODY()
+
+public:
+	UDroneBehaviorTreeComponent(const FObjectInitializer& ObjectInitializer);
+
+	void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Returns whether drone AI is ticked at a fixed rate by the scheduler. Set with the SFAS.DroneAI.FixedRate console variable. */
+	static bool IsFixedRateEnabled();
+
+	/** Sets whether the component is ticked by the scheduler. SimulationSeconds is the scheduler's current simulation time. */
+	void SetScheduled(bool Scheduled, double SimulationSeconds);
+
+	FORCEINLINE bool GetScheduled() const { return IsScheduled; }
+
+	/**
+	 * Sets the least time between scheduled ticks, such as a significance tier's behavior tree tick interval. Kept apart from the
+	 * component's tick interval, which the behavior tree overwrites whenever it schedules its own next tick.
+	 */
+	void SetScheduledTickInterval(float Interval);
+
+	/**
+	 * Ticks the behavior tree with the simulation time since its last scheduled tick. Called by the scheduler.
+	 * Skipped if less than the scheduled tick interval has passed, so significance tiers still lower the update rate.
+	 */
+	void TickScheduled(double SimulationSeconds);
+
+	/** Returns the time the behavior tree runs on: the scheduler's simulation time when scheduled, otherwise the world's game time. */
+	double GetAITimeSeconds() const;
+
+private:
+	/** The simulation time of the last scheduled tick. */
+	double LastTickSimulationSeconds;
+
+	/** The least simulation time between scheduled ticks. */
+	float ScheduledTickInterval;
+
+	bool IsScheduled;
+
+	/** Whether the current tick comes from the scheduler rather than the engine. */
+	bool IsTickingScheduled;
+};
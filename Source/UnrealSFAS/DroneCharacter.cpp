@@ -4,19 +4,32 @@
 #include "DroneCharacter.h"
 #include "UnrealSFASGameMode.h"
 #include "Kismet/GameplayStatics.h"
-#include "Components/AudioComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "HitpointsPickup.h"
+#include "Pickup.h"
+#include "PickupManager.h"
+#include "DroneSignificance.h"
+#include "EnemyDroneAIController.h"
+#include "DroneMovementComponent.h"
+#include "GameCollisionDefinitions.h"
+#include "Components/CapsuleComponent.h"
 
 // Sets default values
-ADroneCharacter::ADroneCharacter()
+ADroneCharacter::ADroneCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UDroneMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// The drone doesn't need to tick. Its cosmetic state is updated in a batch by the game mode's drone cosmetic manager.
+	PrimaryActorTick.bCanEverTick = false;
 
-	// Set the skeletal mesh component to block the visibility collision channel.
-	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
+	// Shots are tested against the drone's hit proxy in the registry and the capsule handles movement, so the skeletal mesh only
+	// answers queries on the visibility channel. Content traces such as the behavior tree's fire task rely on drones blocking
+	// visibility; every other channel, including the shot and sight channels, ignores the mesh's per-body shapes.
+	GetMesh()->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	GetMesh()->SetCollisionResponseToAllChannels(ECR_Ignore);
+	GetMesh()->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
+
+	// Shots are tested against the hit proxy and drones don't block each other's sight, so the capsule's profile ignores both channels.
+	GetCapsuleComponent()->SetCollisionProfileName(COLLISION_PROFILE_DRONE);
 
 	// Set the AI controller to possess the pawn when placed in the world or spawned.
 	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
@@ -28,96 +41,237 @@ ADroneCharacter::ADroneCharacter()
 	MuzzleFlashScene = CreateDefaultSubobject<USceneComponent>(TEXT("MuzzleFlashScene"));
 	MuzzleFlashScene->SetupAttachment(GetMesh());
 
-	// Setup motor audio source audio component.
-	MotorAudioSource = CreateDefaultSubobject<UAudioComponent>(TEXT("MotorAudioSource"));
-	MotorAudioSource->SetupAttachment(GetMesh());
-	MotorAudioSource->SetVolumeMultiplier(0.75f);
-	DefaultMotorAudioPitchMultiplier = 0.125f;
-	MotorAudioSource->SetPitchMultiplier(DefaultMotorAudioPitchMultiplier);
-
-	// Set member default values.
-	Hitpoints = 100;
-	MaxMotorAudioPitchMultiplierModifier = 4.f;
-	BulletImpactSound = nullptr;
-	DestroyedSound = nullptr;
-	MuzzleFlashEmitterTemplate = nullptr;
-	ExplosionEmitterTemplate = nullptr;
-	PickupDropRate = 0.5f;
-	PickupClassToDrop = nullptr;
+	// Set member default values. The starting hitpoints come from the archetype when the drone starts.
+	Hitpoints = 0;
+	Archetype = nullptr;
+	LegacyArchetype = nullptr;
+
+	// The deprecated tuning properties default to the archetype defaults, so drones that never set them are unchanged.
+	const auto* defaultArchetype = GetDefault<UDroneArchetype>();
+	MuzzleFlashEmitterTemplate = defaultArchetype->MuzzleFlashEmitterTemplate;
+	ExplosionEmitterTemplate = defaultArchetype->ExplosionEmitterTemplate;
+	MaxMotorAudioPitchMultiplierModifier = defaultArchetype->MaxMotorAudioPitchMultiplierModifier;
+	FireSound = defaultArchetype->FireSound;
+	BulletImpactSound = defaultArchetype->BulletImpactSound;
+	DestroyedSound = defaultArchetype->DestroyedSound;
+	PickupDropRate = defaultArchetype->PickupDropRate;
+	PickupClassToDrop = defaultArchetype->PickupClassToDrop;
 
 	// The enemy drone AI controller will add the "Enemy" tag when this character is possessed by it.
 }
 
-void ADroneCharacter::Tick(float DeltaTime)
+void ADroneCharacter::BeginPlay()
 {
-	Super::Tick(DeltaTime);
+	// Take the starting state from the archetype.
+	const UDroneArchetype* archetype = GetArchetype();
+	Hitpoints = archetype->GetBaseHitpoints();
+
+	Super::BeginPlay();
 
-	// Adjust the motor audio pitch based on the character's velocity. Higher velocity = higher pitch multiplier
-	auto mapped = UKismetMathLibrary::MapRangeClamped(GetVelocity().Size(), 0.f, GetCharacterMovement()->MaxWalkSpeed, 0.f, 4.f);
-	MotorAudioSource->SetPitchMultiplier(FMath::Clamp(DefaultMotorAudioPitchMultiplier + mapped, DefaultMotorAudioPitchMultiplier, MaxMotorAudioPitchMultiplierModifier));
+	// Add the drone to the registry so batch systems can find it, and to a squad so it acts on its squad's plan.
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		RegistryHandle = unrealSFASGameMode->GetDroneRegistry().Add(this, Hitpoints);
+		unrealSFASGameMode->AddDroneToSquad(RegistryHandle, GetActorLocation());
+	}
+}
+
+void ADroneCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Remove the drone from the registry.
+	auto* droneRegistry = GetDroneRegistry();
+	if (droneRegistry)
+	{
+		droneRegistry->Remove(RegistryHandle);
+	}
+	RegistryHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ADroneCharacter::PostLoad()
+{
+	Super::PostLoad();
+
+	// Only the class default object needs one. Drones spawned from it copy its pointer.
+	if (HasAnyFlags(RF_ClassDefaultObject) && !Archetype && !LegacyArchetype)
+	{
+		LegacyArchetype = CreateLegacyArchetype();
+	}
 }
 
-bool ADroneCharacter::RecieveDamage(int Amount)
+UDroneArchetype* ADroneCharacter::CreateLegacyArchetype()
+{
+	auto* archetype = NewObject<UDroneArchetype>(this, NAME_None, RF_Transient);
+	archetype->MuzzleFlashEmitterTemplate = MuzzleFlashEmitterTemplate;
+	archetype->ExplosionEmitterTemplate = ExplosionEmitterTemplate;
+	archetype->MaxMotorAudioPitchMultiplierModifier = MaxMotorAudioPitchMultiplierModifier;
+	archetype->FireSound = FireSound;
+	archetype->BulletImpactSound = BulletImpactSound;
+	archetype->DestroyedSound = DestroyedSound;
+	archetype->PickupDropRate = PickupDropRate;
+	archetype->PickupClassToDrop = PickupClassToDrop;
+
+	// The shot tuning used to be set on the AI controller blueprint.
+	const auto* enemyDroneAIController = AIControllerClass ? Cast<AEnemyDroneAIController>(AIControllerClass->GetDefaultObject()) : nullptr;
+	if (enemyDroneAIController)
+	{
+		archetype->MaxShotDistance = enemyDroneAIController->MaxShotDistance;
+		archetype->MinShotDamage = enemyDroneAIController->MinShotDamage;
+		archetype->MaxShotDamage = enemyDroneAIController->MaxShotDamage;
+	}
+
+	return archetype;
+}
+
+FDroneRegistry* ADroneCharacter::GetDroneRegistry() const
+{
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		return &unrealSFASGameMode->GetDroneRegistry();
+	}
+
+	return nullptr;
+}
+
+void ADroneCharacter::RecieveDamage(int Amount, AUnrealSFASCharacter* Instigator, int32 LatencyRecord)
 {
 	// Recieving negative damage can heal the drone.
-	//if (Amount <= 0.f) return false;
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		unrealSFASGameMode->GetDamageQueue().QueueDamage(this, Amount, Instigator, LatencyRecord);
+	}
+}
 
+bool ADroneCharacter::ApplyQueuedDamage(int Amount)
+{
+	// Apply the damage.
+	Hitpoints -= Amount;
+
+	// Keep the registry copy of the hitpoints up to date.
+	auto* droneRegistry = GetDroneRegistry();
+	if (droneRegistry)
+	{
+		droneRegistry->SetHitpoints(RegistryHandle, Hitpoints);
+	}
+
+	return Hitpoints <= 0;
+}
+
+void ADroneCharacter::PlayDamageEffects(bool Destroyed)
+{
 	auto* world = GetWorld();
 	if (world)
 	{
+		const UDroneArchetype* archetype = GetArchetype();
+
 		// Play the impact sound.
-		if (BulletImpactSound)
+		if (archetype->GetBulletImpactSound())
 		{
-			UGameplayStatics::PlaySoundAtLocation(world, BulletImpactSound, GetActorLocation());
+			UGameplayStatics::PlaySoundAtLocation(world, archetype->GetBulletImpactSound(), GetActorLocation());
 		}
 
-		// Apply the damage.
-		Hitpoints -= Amount;
-
 		// Check if the drone's Hitpoints have been reduced to 0.
-		if (Hitpoints <= 0)
+		if (Destroyed)
 		{
 			// Notify the game mode a drone has beeen destroyed.
 			auto* unrealSFASGameMode = CastChecked<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
 			unrealSFASGameMode->NotifyDroneDestroyed();
 
 			// Play the destroyed sound.
-			if (DestroyedSound)
+			if (archetype->GetDestroyedSound())
 			{
-				UGameplayStatics::PlaySoundAtLocation(world, DestroyedSound, GetActorLocation());
+				UGameplayStatics::PlaySoundAtLocation(world, archetype->GetDestroyedSound(), GetActorLocation());
 			}
 
 			// Spawn explosion particle system.
-			if (ExplosionEmitterTemplate)
+			if (archetype->GetExplosionEmitterTemplate())
 			{
 				auto* mesh = GetMesh();
 				if (mesh)
 				{
-					UGameplayStatics::SpawnEmitterAtLocation(world, ExplosionEmitterTemplate, mesh->GetComponentLocation(), mesh->GetComponentRotation(), true, EPSCPoolMethod::AutoRelease);
+					UGameplayStatics::SpawnEmitterAtLocation(world, archetype->GetExplosionEmitterTemplate(), mesh->GetComponentLocation(), mesh->GetComponentRotation(), true, EPSCPoolMethod::AutoRelease);
 				}
 			}
 
 			// Should the drone drop a pickup?
-			if (UKismetMathLibrary::RandomBoolWithWeight(PickupDropRate))
+			if (UKismetMathLibrary::RandomBoolWithWeight(archetype->GetPickupDropRate()))
 			{
-				// Spawn the set pickup actor.
-				if (PickupClassToDrop)
+				// Drop the set pickup through the game mode's pickup manager, or spawn it as an actor if there is none.
+				if (archetype->GetPickupClassToDrop())
 				{
-					world->SpawnActor<AHitpointsPickup>(PickupClassToDrop.Get(), GetActorLocation(), GetActorRotation());
+					auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(world));
+					auto* pickupManager = unrealSFASGameMode ? unrealSFASGameMode->GetPickupManager() : nullptr;
+					if (pickupManager)
+					{
+						pickupManager->DropPickup(archetype->GetPickupClassToDrop(), GetActorLocation(), GetActorRotation());
+					}
+					else
+					{
+						world->SpawnActor<APickup>(archetype->GetPickupClassToDrop().Get(), GetActorLocation(), GetActorRotation());
+					}
 				}
 			}
 
 			// Destroy the drone actor.
 			this->Destroy();
-
-			return true;
 		}
 	}
+}
+
+void ADroneCharacter::ApplySignificance(EDroneSignificance Significance, const FDroneSignificanceTierSettings& TierSettings)
+{
+	// Update the animation rate. Dormant drones are far away or unseen, so their animation is paused outright.
+	auto* mesh = GetMesh();
+	mesh->SetComponentTickInterval(TierSettings.AnimationTickInterval);
+	mesh->SetComponentTickEnabled(Significance != EDroneSignificance::Dormant);
+
+	// Update the movement rate and fidelity.
+	auto* characterMovement = GetCharacterMovement();
+	characterMovement->SetComponentTickInterval(TierSettings.MovementTickInterval);
+	characterMovement->MaxSimulationIterations = TierSettings.MovementMaxSimulationIterations;
 
-	return false;
+	// Update the behavior tree rate.
+	auto* enemyDroneAIController = Cast<AEnemyDroneAIController>(GetController());
+	if (enemyDroneAIController)
+	{
+		enemyDroneAIController->SetBehaviorTreeTickInterval(TierSettings.BehaviorTreeTickInterval);
+	}
+}
+
+void ADroneCharacter::PlayFireEffects()
+{
+	auto* world = GetWorld();
+	if (world)
+	{
+		const UDroneArchetype* archetype = GetArchetype();
+
+		// Spawn muzzle flash particles system.
+		if (archetype->GetMuzzleFlashEmitterTemplate())
+		{
+			UGameplayStatics::SpawnEmitterAttached(archetype->GetMuzzleFlashEmitterTemplate(), MuzzleFlashScene, FName("None"), MuzzleFlashScene->GetComponentLocation(),
+				MuzzleFlashScene->GetComponentRotation(), EAttachLocation::KeepWorldPosition, true, EPSCPoolMethod::AutoRelease);
+		}
+
+		// Play the fire sound at the muzzle.
+		if (archetype->GetFireSound())
+		{
+			UGameplayStatics::PlaySoundAtLocation(world, archetype->GetFireSound(), MuzzleFlashScene->GetComponentLocation());
+		}
+	}
 }
 
 void ADroneCharacter::AddHitpoints(int Amount)
 {
 	Hitpoints += Amount;
+
+	// Keep the registry copy of the hitpoints up to date.
+	auto* droneRegistry = GetDroneRegistry();
+	if (droneRegistry)
+	{
+		droneRegistry->SetHitpoints(RegistryHandle, Hitpoints);
+	}
 }
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "DroneRegistry.h"
+#include "DroneArchetype.h"
 #include "DroneCharacter.generated.h"
 
 UCLASS()
@@ -14,64 +16,113 @@ class UNREALSFAS_API ADroneCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Particles, meta = (AllowPrivateAccess = "true"))
 	USceneComponent* MuzzleFlashScene;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Particles, meta = (AllowPrivateAccess = "true"))
-	UAudioComponent* MotorAudioSource;
-
 public:
 	// Sets default values for this character's properties
-	ADroneCharacter();
+	ADroneCharacter(const FObjectInitializer& ObjectInitializer);
+
+	/** Queues damage to the drone character with the game mode's damage queue. Instigator is the player credited with the damage, if any. */
+	void RecieveDamage(int Amount, class AUnrealSFASCharacter* Instigator = nullptr, int32 LatencyRecord = INDEX_NONE);
 
-	// Called every tick
-	void Tick(float DeltaTime) override;
+	/** Reduces the drone's Hitpoints without any side effects. Returns whether the drone has been destroyed. Called by the game mode's damage queue. */
+	bool ApplyQueuedDamage(int Amount);
 
-	/** Damages the drone character, reducing its Hitpoints value. Returns whether the damage destroyed the drone character. Can be extended by derived blueprint */
-	bool RecieveDamage(int Amount);
+	/** Plays the impact sound once for every hit this frame, and destroys the drone if it was defeated. Called by the game mode's damage queue. */
+	void PlayDamageEffects(bool Destroyed);
 
 	/** Returns the muzzle flash scene component. */
 	FORCEINLINE USceneComponent* GetMuzzleFlashScene() const { return MuzzleFlashScene; }
 
 	/** Returns the emitter template to use for muzzle flash. */
 	UFUNCTION(BlueprintCallable, Category = Particles)
-	FORCEINLINE UParticleSystem* GetMuzzleFlashEmitterTemplate() const { return MuzzleFlashEmitterTemplate; }
+	FORCEINLINE UParticleSystem* GetMuzzleFlashEmitterTemplate() const { return GetArchetype()->GetMuzzleFlashEmitterTemplate(); }
+
+	/** Spawns the muzzle flash and plays the fire sound of a shot. */
+	void PlayFireEffects();
 
 	/** Adds Hitpoints to the current Hitpoints total. */
 	void AddHitpoints(int Amount);
 
+	/** Returns the current Hitpoints total. */
+	FORCEINLINE int GetHitpoints() const { return Hitpoints; }
+
+	/** Returns the motor audio pitch multiplier used when the drone is stationary. */
+	FORCEINLINE float GetDefaultMotorAudioPitchMultiplier() const { return GetArchetype()->GetDefaultMotorAudioPitchMultiplier(); }
+
+	/** Returns the maximum motor audio pitch multiplier. */
+	FORCEINLINE float GetMaxMotorAudioPitchMultiplierModifier() const { return GetArchetype()->GetMaxMotorAudioPitchMultiplierModifier(); }
+
+	/**
+	 * Returns the tuning data shared by drones of this type. Falls back to an archetype built from the deprecated tuning
+	 * properties if none is set, or to the archetype defaults if there are none either.
+	 */
+	FORCEINLINE const UDroneArchetype* GetArchetype() const { return Archetype ? Archetype : (LegacyArchetype ? LegacyArchetype : GetDefault<UDroneArchetype>()); }
+
+	/** Applies the update rates of a significance tier to the drone's animation, movement and behavior tree. Dormant drones stop animating. */
+	void ApplySignificance(EDroneSignificance Significance, const struct FDroneSignificanceTierSettings& TierSettings);
+
+	/** Returns the handle of this drone in the game mode's drone registry. Unset if the drone is not registered. */
+	FORCEINLINE const FDroneHandle& GetRegistryHandle() const { return RegistryHandle; }
+
+protected:
+	/** Called when the game starts or when spawned. Adds the drone to the game mode's drone registry. */
+	void BeginPlay() override;
+
+	/** Called when the drone is destroyed or removed from the level. Removes the drone from the game mode's drone registry. */
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Builds the legacy archetype of a blueprint that has no archetype asset yet. Spawned drones share their class default's. */
+	void PostLoad() override;
+
+private:
+	/** Returns the drone registry of the current game mode, or nullptr if the game mode does not track drones. */
+	FDroneRegistry* GetDroneRegistry() const;
+
+	/** Copies the deprecated tuning properties of the drone and its AI controller class into a new transient archetype. */
+	UDroneArchetype* CreateLegacyArchetype();
+
 private:
-	float DefaultMotorAudioPitchMultiplier;
+	/** Handle of this drone in the game mode's drone registry. */
+	FDroneHandle RegistryHandle;
 
 	UPROPERTY(BlueprintReadOnly, Category = Damage, meta = (AllowPrivateAccess = "true"))
 	int Hitpoints;
 
 	///////////////////////////////////////////////
-	/** Particles category */
-	/** The particle emitter template to use to create a muzzle flash effect when the drone fires. */
-	UPROPERTY(EditDefaultsOnly, Category = Particles, meta = (AllowPrivateAccess = "true"))
+	/** Archetype category */
+	/** Set in the derived blueprint. The tuning data shared by drones of this type. */
+	UPROPERTY(EditDefaultsOnly, Category = Archetype, meta = (AllowPrivateAccess = "true"))
+	UDroneArchetype* Archetype;
+
+	/** Built from the deprecated tuning properties when no archetype is set. */
+	UPROPERTY(Transient)
+	UDroneArchetype* LegacyArchetype;
+	///////////////////////////////////////////////
+	/**
+	 * Deprecated tuning properties. Still loaded so the values set on existing drone blueprints aren't lost, and used through the
+	 * legacy archetype until the blueprint is given an archetype asset. Remove once the content has been moved over.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = Particles, meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the muzzle flash on the drone archetype instead."))
 	UParticleSystem* MuzzleFlashEmitterTemplate;
 
-	/** The particle emitter template to use to play an explosion. */
-	UPROPERTY(EditDefaultsOnly, Category = Particles, meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(EditDefaultsOnly, Category = Particles, meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the explosion on the drone archetype instead."))
 	UParticleSystem* ExplosionEmitterTemplate;
 
-	/** Audio category */
-	/** The maximum value that can be set as the pitch multiplier. */
-	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the motor pitch range on the drone archetype instead."))
 	float MaxMotorAudioPitchMultiplierModifier;
 
-	/** The sound to play when the drone is shot. */
-	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the fire sound on the drone archetype instead."))
+	USoundBase* FireSound;
+
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the bullet impact sound on the drone archetype instead."))
 	USoundBase* BulletImpactSound;
 
-	/** The sound to play when the drone is destroyed. */
-	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the destroyed sound on the drone archetype instead."))
 	USoundBase* DestroyedSound;
-	///////////////////////////////////////////////
-	/** Stats category. */
-	/** Determines the rate at which the drone drops a pickup when it is destroyed. In the range 0 - 1, 1 is more likely to drop a pickup. */
-	UPROPERTY(EditDefaultsOnly, Category = Pickup, meta = (AllowPrivateAccess = "true"))
+
+	UPROPERTY(EditDefaultsOnly, Category = Pickup, meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the pickup drop rate on the drone archetype instead."))
 	float PickupDropRate;
 
-	/** The pickup class to spawn if the drone drops a pickup. */
-	UPROPERTY(EditDefaultsOnly, Category = Pickup, meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(EditDefaultsOnly, Category = Pickup, meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the pickup class on the drone archetype instead."))
 	TSubclassOf<class APickup> PickupClassToDrop;
+	///////////////////////////////////////////////
 };
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneCosmeticManager.h"
+#include "UnrealSFAS.h"
+#include "DroneRegistry.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update cosmetics"), STAT_DroneCosmeticUpdate, STATGROUP_SFASDrones);
+
+FDroneCosmeticManager::FDroneCosmeticManager()
+{
+}
+
+void FDroneCosmeticManager::Tick(FDroneRegistry& Registry)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneCosmeticUpdate);
+
+	const int32 count = Registry.Num();
+	NewMotorPitches.SetNumUninitialized(count, false);
+
+	const float* velocityX = Registry.GetVelocityX().GetData();
+	const float* velocityY = Registry.GetVelocityY().GetData();
+	const float* velocityZ = Registry.GetVelocityZ().GetData();
+	const float* maxSpeeds = Registry.GetMaxSpeeds().GetData();
+	const float* minPitches = Registry.GetMinMotorPitches().GetData();
+	const float* maxPitches = Registry.GetMaxMotorPitches().GetData();
+	float* newPitches = NewMotorPitches.GetData();
+
+	// Calculate the pitch of four drones at a time: pitch = clamp(min + saturate(speed / maxSpeed) * range, min, max).
+	const VectorRegister4Float zero = VectorZeroFloat();
+	const VectorRegister4Float one = VectorOneFloat();
+	const VectorRegister4Float smallestSpeed = VectorSetFloat1(KINDA_SMALL_NUMBER);
+	const VectorRegister4Float pitchSpeedRange = VectorSetFloat1(MotorPitchSpeedRange);
+
+	int32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const VectorRegister4Float vx = VectorLoad(velocityX + i);
+		const VectorRegister4Float vy = VectorLoad(velocityY + i);
+		const VectorRegister4Float vz = VectorLoad(velocityZ + i);
+		const VectorRegister4Float speed = VectorSqrt(VectorMultiplyAdd(vz, vz, VectorMultiplyAdd(vy, vy, VectorMultiply(vx, vx))));
+
+		const VectorRegister4Float maxSpeed = VectorMax(VectorLoad(maxSpeeds + i), smallestSpeed);
+		const VectorRegister4Float alpha = VectorMin(VectorMax(VectorDivide(speed, maxSpeed), zero), one);
+
+		const VectorRegister4Float minPitch = VectorLoad(minPitches + i);
+		const VectorRegister4Float maxPitch = VectorLoad(maxPitches + i);
+		const VectorRegister4Float pitch = VectorMultiplyAdd(alpha, pitchSpeedRange, minPitch);
+		VectorStore(VectorMin(VectorMax(pitch, minPitch), maxPitch), newPitches + i);
+	}
+
+	// Finish off the drones that don't fill a whole vector.
+	for (; i < count; i++)
+	{
+		const float speed = FMath::Sqrt(FMath::Square(velocityX[i]) + FMath::Square(velocityY[i]) + FMath::Square(velocityZ[i]));
+		newPitches[i] = CalculateMotorPitch(speed, maxSpeeds[i], minPitches[i], maxPitches[i]);
+	}
+
+	for (int32 n = 0; n < count; n++)
+	{
+		Registry.SetMotorPitch(n, newPitches[n]);
+	}
+}
+
+float FDroneCosmeticManager::CalculateMotorPitch(float Speed, float MaxSpeed, float MinPitch, float MaxPitch)
+{
+	const float alpha = FMath::Clamp(Speed / FMath::Max(MaxSpeed, KINDA_SMALL_NUMBER), 0.f, 1.f);
+	return FMath::Clamp(MinPitch + (alpha * MotorPitchSpeedRange), MinPitch, MaxPitch);
+}
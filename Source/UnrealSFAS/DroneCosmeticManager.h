@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Updates the cosmetic state of every drone in one pass over the drone registry, so drones don't need to tick.
+ * Motor audio pitch is calculated four drones at a time from the packed velocity arrays and written back to the registry,
+ * where the drone audio manager reads it for the drones that have a voice.
+ */
+class UNREALSFAS_API FDroneCosmeticManager
+{
+public:
+	FDroneCosmeticManager();
+
+	/** Updates the cosmetic state of every drone in the registry. */
+	void Tick(class FDroneRegistry& Registry);
+
+	/** Returns the motor audio pitch multiplier for a drone travelling at Speed. Matches the batched calculation. */
+	static float CalculateMotorPitch(float Speed, float MaxSpeed, float MinPitch, float MaxPitch);
+
+private:
+	/** The pitch change added to the minimum pitch when a drone travels at its max speed. */
+	static constexpr float MotorPitchSpeedRange = 4.f;
+
+	/** Scratch storage of the newly calculated pitches, indexed by dense index. */
+	TArray<float> NewMotorPitches;
+};
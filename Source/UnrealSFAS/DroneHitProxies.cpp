@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneHitProxies.h"
+#include "UnrealSFAS.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hit proxy raycast"), STAT_DroneHitProxyRaycast, STATGROUP_SFASDrones);
+
+static TAutoConsoleVariable<int32> CVarDroneHitProxiesSIMD(
+	TEXT("SFAS.HitProxies.SIMD"),
+	1,
+	TEXT("1: shots are tested against four drone hit proxies at a time. 0: shots are tested against one hit proxy at a time."),
+	ECVF_Default);
+
+int32 FDroneHitProxies::Raycast(const FDroneHitProxyView& Proxies, const FVector& Start, const FVector& End, float MaxDistance, int32 IgnoreIndex, float& OutDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneHitProxyRaycast);
+
+	return RaycastAnyThread(Proxies, FVector3f(Start), FVector3f(End), MaxDistance, IgnoreIndex, IsSIMDEnabled(), OutDistance);
+}
+
+int32 FDroneHitProxies::RaycastAnyThread(const FDroneHitProxyView& Proxies, const FVector3f& Start, const FVector3f& End, float MaxDistance, int32 IgnoreIndex, bool SIMD, float& OutDistance)
+{
+	FVector3f direction(End - Start);
+	const float length = direction.Size();
+	if (length <= KINDA_SMALL_NUMBER)
+	{
+		return INDEX_NONE;
+	}
+	direction /= length;
+
+	int32 nearest = INDEX_NONE;
+	float nearestDistance = FMath::Min(length, MaxDistance);
+
+	int32 begin = 0;
+	if (SIMD)
+	{
+		begin = RaycastSIMD(Proxies, Start, direction, IgnoreIndex, nearest, nearestDistance);
+	}
+
+	// Finish off the proxies that don't fill a whole vector.
+	RaycastScalar(Proxies, begin, Proxies.Num, Start, direction, IgnoreIndex, nearest, nearestDistance);
+
+	OutDistance = nearestDistance;
+	return nearest;
+}
+
+bool FDroneHitProxies::IsSIMDEnabled()
+{
+	return CVarDroneHitProxiesSIMD.GetValueOnGameThread() != 0;
+}
+
+void FDroneHitProxies::RaycastScalar(const FDroneHitProxyView& Proxies, int32 Begin, int32 End, const FVector3f& Start, const FVector3f& Direction, int32 IgnoreIndex, int32& InOutNearest, float& InOutNearestDistance)
+{
+	for (int32 i = Begin; i < End; i++)
+	{
+		if (i == IgnoreIndex)
+		{
+			continue;
+		}
+
+		// Solve |start + direction * t - centre|^2 = radius^2 for the first t along the segment.
+		const FVector3f offset(Proxies.CenterX[i] - Start.X, Proxies.CenterY[i] - Start.Y, Proxies.CenterZ[i] - Start.Z);
+		const float projection = FVector3f::DotProduct(offset, Direction);
+		const float radiusSquared = Proxies.RadiiSquared ? Proxies.RadiiSquared[i] : Proxies.UniformRadiusSquared;
+		const float c = offset.SizeSquared() - radiusSquared;
+
+		// The segment starts outside of the sphere and points away from it.
+		if ((c > 0.f) && (projection < 0.f))
+		{
+			continue;
+		}
+
+		const float discriminant = (projection * projection) - c;
+		if ((discriminant < 0.f) || (radiusSquared < 0.f))
+		{
+			continue;
+		}
+
+		const float distance = FMath::Max(projection - FMath::Sqrt(discriminant), 0.f);
+		if (distance <= InOutNearestDistance)
+		{
+			InOutNearestDistance = distance;
+			InOutNearest = i;
+		}
+	}
+}
+
+int32 FDroneHitProxies::RaycastSIMD(const FDroneHitProxyView& Proxies, const FVector3f& Start, const FVector3f& Direction, int32 IgnoreIndex, int32& InOutNearest, float& InOutNearestDistance)
+{
+	const VectorRegister4Float zero = VectorZeroFloat();
+	const VectorRegister4Float startX = VectorSetFloat1(Start.X);
+	const VectorRegister4Float startY = VectorSetFloat1(Start.Y);
+	const VectorRegister4Float startZ = VectorSetFloat1(Start.Z);
+	const VectorRegister4Float directionX = VectorSetFloat1(Direction.X);
+	const VectorRegister4Float directionY = VectorSetFloat1(Direction.Y);
+	const VectorRegister4Float directionZ = VectorSetFloat1(Direction.Z);
+	const VectorRegister4Float uniformRadiusSquared = VectorSetFloat1(Proxies.UniformRadiusSquared);
+
+	alignas(16) float distances[4];
+
+	int32 i = 0;
+	for (; i + 4 <= Proxies.Num; i += 4)
+	{
+		const VectorRegister4Float ox = VectorSubtract(VectorLoad(Proxies.CenterX + i), startX);
+		const VectorRegister4Float oy = VectorSubtract(VectorLoad(Proxies.CenterY + i), startY);
+		const VectorRegister4Float oz = VectorSubtract(VectorLoad(Proxies.CenterZ + i), startZ);
+		const VectorRegister4Float radiusSquared = Proxies.RadiiSquared ? VectorLoad(Proxies.RadiiSquared + i) : uniformRadiusSquared;
+
+		const VectorRegister4Float projection = VectorMultiplyAdd(oz, directionZ, VectorMultiplyAdd(oy, directionY, VectorMultiply(ox, directionX)));
+		const VectorRegister4Float c = VectorSubtract(VectorMultiplyAdd(oz, oz, VectorMultiplyAdd(oy, oy, VectorMultiply(ox, ox))), radiusSquared);
+		const VectorRegister4Float discriminant = VectorSubtract(VectorMultiply(projection, projection), c);
+
+		// Hit when the line passes through the sphere and the segment doesn't start outside of it pointing away.
+		const VectorRegister4Float throughSphere = VectorBitwiseAnd(VectorCompareGE(discriminant, zero), VectorCompareGE(radiusSquared, zero));
+		const VectorRegister4Float towardsSphere = VectorBitwiseOr(VectorCompareLE(c, zero), VectorCompareGE(projection, zero));
+		const VectorRegister4Float distance = VectorMax(VectorSubtract(projection, VectorSqrt(VectorMax(discriminant, zero))), zero);
+		const VectorRegister4Float nearer = VectorCompareLE(distance, VectorSetFloat1(InOutNearestDistance));
+
+		int32 hits = VectorMaskBits(VectorBitwiseAnd(VectorBitwiseAnd(throughSphere, towardsSphere), nearer));
+		if (hits == 0)
+		{
+			continue;
+		}
+
+		// Compare the lanes that hit against the nearest hit so far.
+		VectorStoreAligned(distance, distances);
+		while (hits != 0)
+		{
+			const int32 lane = FMath::CountTrailingZeros(hits);
+			hits &= hits - 1;
+
+			if (((i + lane) != IgnoreIndex) && (distances[lane] <= InOutNearestDistance))
+			{
+				InOutNearestDistance = distances[lane];
+				InOutNearest = i + lane;
+			}
+		}
+	}
+
+	return i;
+}
+
+namespace DroneHitProxies
+{
+	/** Returns the average microseconds per ray against Count proxies scattered along a corridor the rays fire down. */
+	static double MeasureRaycastMicroseconds(int32 Count, int32 NumRays, bool SIMD, int32& OutHits)
+	{
+		FRandomStream randomStream(Count);
+		TArray<float> centerX;
+		TArray<float> centerY;
+		TArray<float> centerZ;
+		for (int32 i = 0; i < Count; i++)
+		{
+			centerX.Add(randomStream.FRandRange(0.f, 10000.f));
+			centerY.Add(randomStream.FRandRange(-2000.f, 2000.f));
+			centerZ.Add(randomStream.FRandRange(0.f, 400.f));
+		}
+
+		FDroneHitProxyView proxies;
+		proxies.CenterX = centerX.GetData();
+		proxies.CenterY = centerY.GetData();
+		proxies.CenterZ = centerZ.GetData();
+		proxies.UniformRadiusSquared = FMath::Square(50.f);
+		proxies.Num = Count;
+
+		TArray<FVector> rayEnds;
+		for (int32 ray = 0; ray < NumRays; ray++)
+		{
+			rayEnds.Add(FVector(10000.f, randomStream.FRandRange(-2000.f, 2000.f), randomStream.FRandRange(0.f, 400.f)));
+		}
+
+		IConsoleVariable* simdVariable = CVarDroneHitProxiesSIMD.AsVariable();
+		const int32 previousSIMD = simdVariable->GetInt();
+		simdVariable->Set(SIMD ? 1 : 0, ECVF_SetByCode);
+
+		OutHits = 0;
+		const double startSeconds = FPlatformTime::Seconds();
+		for (const FVector& rayEnd : rayEnds)
+		{
+			float distance = 0.f;
+			if (FDroneHitProxies::Raycast(proxies, FVector(0.f, 0.f, 200.f), rayEnd, BIG_NUMBER, INDEX_NONE, distance) != INDEX_NONE)
+			{
+				OutHits++;
+			}
+		}
+		const double microseconds = ((FPlatformTime::Seconds() - startSeconds) * 1000000.0) / NumRays;
+
+		simdVariable->Set(previousSIMD, ECVF_SetByCode);
+		return microseconds;
+	}
+
+	/** Logs the cost of a ray against increasing numbers of proxies, with and without SIMD. */
+	static void RunBenchmark(const TArray<FString>& Args)
+	{
+		const int32 numRays = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+
+		for (int32 count = 64; count <= 4096; count *= 2)
+		{
+			int32 scalarHits = 0;
+			int32 simdHits = 0;
+			const double scalarMicroseconds = MeasureRaycastMicroseconds(count, numRays, false, scalarHits);
+			const double simdMicroseconds = MeasureRaycastMicroseconds(count, numRays, true, simdHits);
+			UE_LOG(LogUnrealSFAS, Display, TEXT("Hit proxy benchmark: %d proxies, %.3f us per ray scalar, %.3f us per ray SIMD, %d / %d hits"),
+				count, scalarMicroseconds, simdMicroseconds, scalarHits, simdHits);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("SFAS.HitProxies.Benchmark"),
+		TEXT("Measures the cost of a shot ray against drone hit proxies, with and without SIMD. Optional argument: number of rays per proxy count."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+}
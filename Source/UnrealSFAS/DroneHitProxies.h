@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Packed hit spheres to test shots against. Centres are stored one float array per component. */
+struct FDroneHitProxyView
+{
+	const float* CenterX = nullptr;
+	const float* CenterY = nullptr;
+	const float* CenterZ = nullptr;
+
+	/** The squared radius of each sphere, or nullptr if every sphere has UniformRadiusSquared. A negative value disables a sphere. */
+	const float* RadiiSquared = nullptr;
+	float UniformRadiusSquared = 0.f;
+
+	int32 Num = 0;
+};
+
+/**
+ * Analytic ray tests against simple drone hit spheres, so shots don't need physics traces against drone meshes. The sphere
+ * tests run four proxies at a time: a ray against several hundred proxies takes a few microseconds. Only the lanes that pass
+ * every test are compared against the nearest hit so far, which is rare for a single shot.
+ */
+class UNREALSFAS_API FDroneHitProxies
+{
+public:
+	/**
+	 * Returns the index of the first sphere the segment from Start to End passes through before MaxDistance along it, or
+	 * INDEX_NONE. OutDistance is set to the distance along the segment to the hit sphere. The sphere at IgnoreIndex is skipped.
+	 */
+	static int32 Raycast(const FDroneHitProxyView& Proxies, const FVector& Start, const FVector& End, float MaxDistance, int32 IgnoreIndex, float& OutDistance);
+
+	/** Same as Raycast, but safe to call from any thread. SIMD is the value of IsSIMDEnabled read on the game thread. */
+	static int32 RaycastAnyThread(const FDroneHitProxyView& Proxies, const FVector3f& Start, const FVector3f& End, float MaxDistance, int32 IgnoreIndex, bool SIMD, float& OutDistance);
+
+	/** Returns whether the ray tests run four proxies at a time. Controlled by SFAS.HitProxies.SIMD. */
+	static bool IsSIMDEnabled();
+
+private:
+	/** Tests the spheres in [Begin, End) one at a time, updating the nearest hit. */
+	static void RaycastScalar(const FDroneHitProxyView& Proxies, int32 Begin, int32 End, const FVector3f& Start, const FVector3f& Direction, int32 IgnoreIndex, int32& InOutNearest, float& InOutNearestDistance);
+
+	/** Tests the spheres four at a time from index 0 and returns the index the vectorised loop stopped at. */
+	static int32 RaycastSIMD(const FDroneHitProxyView& Proxies, const FVector3f& Start, const FVector3f& Direction, int32 IgnoreIndex, int32& InOutNearest, float& InOutNearestDistance);
+};
@@ -0,0 +1,212 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneHitProxyHistory.h"
+#include "UnrealSFAS.h"
+#include "DroneHitProxies.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Record hit proxy history"), STAT_DroneHitProxyHistoryRecord, STATGROUP_SFASDrones);
+DECLARE_CYCLE_STAT(TEXT("Rewind hit proxies"), STAT_DroneHitProxyRewind, STATGROUP_SFASDrones);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hit proxy rewinds"), STAT_DroneHitProxyRewinds, STATGROUP_SFASDrones);
+
+static TAutoConsoleVariable<int32> CVarDroneHitProxiesRewind(
+	TEXT("SFAS.HitProxies.Rewind"),
+	1,
+	TEXT("1: player shots are tested against the drones where they were when the fire input was received. 0: against where they are when the shot is fired."),
+	ECVF_Default);
+
+FDroneHitProxyHistorySettings::FDroneHitProxyHistorySettings()
+{
+	// Set default member values.
+	HistorySeconds = 0.25f;
+	MaxSnapshots = 32;
+}
+
+FDroneHitProxyHistory::FDroneHitProxyHistory()
+{
+	Head = INDEX_NONE;
+	NumRecorded = 0;
+	SlotCapacity = 0;
+	MaxRewindCycles = 0;
+	RewoundCycles = 0;
+	RewoundFrame = 0;
+}
+
+void FDroneHitProxyHistory::Record(const FDroneRegistry& Registry, const FDroneHitProxyHistorySettings& Settings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneHitProxyHistoryRecord);
+
+	// Reallocate when the settings change or the registry has more handle slots than a snapshot can hold. Slots grow in powers
+	// of two so this is rare, and the history it drops is a fraction of a second long.
+	const int32 maxSnapshots = FMath::Clamp(Settings.MaxSnapshots, 2, 128);
+	const int32 handleCapacity = Registry.GetHandleCapacity();
+	if ((Snapshots.Num() != maxSnapshots) || (handleCapacity > SlotCapacity))
+	{
+		SlotCapacity = FMath::Max(SlotCapacity, (int32)FMath::RoundUpToPowerOfTwo(FMath::Max(handleCapacity, 64)));
+		Snapshots.SetNumZeroed(maxSnapshots);
+		QuantisedX.SetNumUninitialized(maxSnapshots * SlotCapacity);
+		QuantisedY.SetNumUninitialized(maxSnapshots * SlotCapacity);
+		QuantisedZ.SetNumUninitialized(maxSnapshots * SlotCapacity);
+		Tags.SetNumZeroed(maxSnapshots * SlotCapacity);
+		Head = INDEX_NONE;
+		NumRecorded = 0;
+	}
+	MaxRewindCycles = (uint64)(FMath::Max(Settings.HistorySeconds, 0.f) / FPlatformTime::GetSecondsPerCycle64());
+
+	Head = (Head + 1) % Snapshots.Num();
+	NumRecorded = FMath::Min(NumRecorded + 1, Snapshots.Num());
+	RewoundFrame = 0;
+
+	// Quantise against the bounds of this snapshot's proxies. A maze tens of thousands of units across keeps sub unit precision.
+	const FDroneHitProxyView proxies = Registry.GetHitProxies();
+	FVector3f boundsMin(BIG_NUMBER);
+	FVector3f boundsMax(-BIG_NUMBER);
+	for (int32 i = 0; i < proxies.Num; i++)
+	{
+		const FVector3f center(proxies.CenterX[i], proxies.CenterY[i], proxies.CenterZ[i]);
+		boundsMin = boundsMin.ComponentMin(center);
+		boundsMax = boundsMax.ComponentMax(center);
+	}
+
+	FSnapshot& snapshot = Snapshots[Head];
+	snapshot.Cycles = FPlatformTime::Cycles64();
+	snapshot.Origin = (proxies.Num > 0) ? ((boundsMin + boundsMax) * 0.5f) : FVector3f::ZeroVector;
+	snapshot.Step = (proxies.Num > 0) ? FMath::Max((boundsMax - boundsMin).GetMax() * 0.5f / MAX_int16, KINDA_SMALL_NUMBER) : 1.f;
+
+	const int32 base = Head * SlotCapacity;
+	FMemory::Memzero(Tags.GetData() + base, SlotCapacity * sizeof(uint16));
+
+	const float inverseStep = 1.f / snapshot.Step;
+	const TArray<FDroneHandle>& handles = Registry.GetHandles();
+	for (int32 i = 0; i < proxies.Num; i++)
+	{
+		const int32 index = base + handles[i].Index;
+		QuantisedX[index] = (int16)FMath::Clamp(FMath::RoundToInt((proxies.CenterX[i] - snapshot.Origin.X) * inverseStep), -MAX_int16, MAX_int16);
+		QuantisedY[index] = (int16)FMath::Clamp(FMath::RoundToInt((proxies.CenterY[i] - snapshot.Origin.Y) * inverseStep), -MAX_int16, MAX_int16);
+		QuantisedZ[index] = (int16)FMath::Clamp(FMath::RoundToInt((proxies.CenterZ[i] - snapshot.Origin.Z) * inverseStep), -MAX_int16, MAX_int16);
+		Tags[index] = MakeTag(handles[i]);
+	}
+}
+
+FDroneHandle FDroneHitProxyHistory::Raycast(const FDroneRegistry& Registry, uint64 AtCycles, const FVector& Start, const FVector& End, float MaxDistance, const FDroneHandle& Ignore, float& OutDistance)
+{
+	if ((AtCycles == 0) || !IsRewindEnabled() || !Rewind(Registry, AtCycles))
+	{
+		return Registry.Raycast(Start, End, MaxDistance, Ignore, OutDistance);
+	}
+
+	FDroneHitProxyView proxies = Registry.GetHitProxies();
+	proxies.CenterX = RewoundX.GetData();
+	proxies.CenterY = RewoundY.GetData();
+	proxies.CenterZ = RewoundZ.GetData();
+
+	const int32 hitIndex = FDroneHitProxies::Raycast(proxies, Start, End, MaxDistance, Registry.GetDenseIndex(Ignore), OutDistance);
+	return (hitIndex != INDEX_NONE) ? Registry.GetHandles()[hitIndex] : FDroneHandle();
+}
+
+bool FDroneHitProxyHistory::Rewind(const FDroneRegistry& Registry, uint64 AtCycles)
+{
+	// Shots after the newest snapshot are tested where the drones are now, which is the newest snapshot.
+	if ((NumRecorded == 0) || (AtCycles >= Snapshots[Head].Cycles))
+	{
+		return false;
+	}
+
+	// The pellets of a shot share its input time, so they share one rewind.
+	const int32 count = Registry.Num();
+	if ((RewoundFrame == GFrameCounter) && (RewoundCycles == AtCycles) && (RewoundX.Num() == count))
+	{
+		return true;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DroneHitProxyRewind);
+	INC_DWORD_STAT(STAT_DroneHitProxyRewinds);
+
+	// Don't resolve shots further back than the history allows.
+	const uint64 newestCycles = Snapshots[Head].Cycles;
+	const uint64 targetCycles = ((newestCycles - AtCycles) > MaxRewindCycles) ? (newestCycles - MaxRewindCycles) : AtCycles;
+
+	// Find the snapshots either side of the target time. Before the oldest snapshot, the oldest is used.
+	int32 older = Head;
+	int32 newer = Head;
+	for (int32 age = 1; age < NumRecorded; age++)
+	{
+		newer = older;
+		older = (Head - age + Snapshots.Num()) % Snapshots.Num();
+		if (Snapshots[older].Cycles <= targetCycles)
+		{
+			break;
+		}
+	}
+
+	const FSnapshot& olderSnapshot = Snapshots[older];
+	const FSnapshot& newerSnapshot = Snapshots[newer];
+	const uint64 span = newerSnapshot.Cycles - olderSnapshot.Cycles;
+	const float alpha = ((span > 0) && (targetCycles > olderSnapshot.Cycles)) ? FMath::Min((float)((double)(targetCycles - olderSnapshot.Cycles) / span), 1.f) : 0.f;
+
+	// Interpolate each drone between the snapshots it is in. Drones in neither, added since, are tested where they are now.
+	RewoundX.SetNumUninitialized(count, false);
+	RewoundY.SetNumUninitialized(count, false);
+	RewoundZ.SetNumUninitialized(count, false);
+
+	const FDroneHitProxyView proxies = Registry.GetHitProxies();
+	const TArray<FDroneHandle>& handles = Registry.GetHandles();
+	const int32 olderBase = older * SlotCapacity;
+	const int32 newerBase = newer * SlotCapacity;
+	for (int32 i = 0; i < count; i++)
+	{
+		const FDroneHandle& handle = handles[i];
+		const uint16 tag = MakeTag(handle);
+		FVector3f center(proxies.CenterX[i], proxies.CenterY[i], proxies.CenterZ[i]);
+		if (handle.Index < SlotCapacity)
+		{
+			const int32 olderIndex = olderBase + handle.Index;
+			const int32 newerIndex = newerBase + handle.Index;
+			const bool inOlder = (Tags[olderIndex] == tag);
+			const bool inNewer = (Tags[newerIndex] == tag);
+
+			if (inOlder && inNewer)
+			{
+				center = FMath::Lerp(Dequantise(olderSnapshot, olderIndex), Dequantise(newerSnapshot, newerIndex), alpha);
+			}
+			else if (inOlder)
+			{
+				center = Dequantise(olderSnapshot, olderIndex);
+			}
+			else if (inNewer)
+			{
+				center = Dequantise(newerSnapshot, newerIndex);
+			}
+		}
+
+		RewoundX[i] = center.X;
+		RewoundY[i] = center.Y;
+		RewoundZ[i] = center.Z;
+	}
+
+	RewoundCycles = AtCycles;
+	RewoundFrame = GFrameCounter;
+	return true;
+}
+
+void FDroneHitProxyHistory::Reset()
+{
+	Snapshots.Reset();
+	QuantisedX.Reset();
+	QuantisedY.Reset();
+	QuantisedZ.Reset();
+	Tags.Reset();
+	RewoundX.Reset();
+	RewoundY.Reset();
+	RewoundZ.Reset();
+	Head = INDEX_NONE;
+	NumRecorded = 0;
+	SlotCapacity = 0;
+	RewoundFrame = 0;
+}
+
+bool FDroneHitProxyHistory::IsRewindEnabled()
+{
+	return CVarDroneHitProxiesRewind.GetValueOnGameThread() != 0;
+}
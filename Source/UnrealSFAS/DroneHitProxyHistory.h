@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneRegistry.h"
+#include "DroneHitProxyHistory.generated.h"
+
+/** How far back player shots can be resolved against the drones. */
+USTRUCT(BlueprintType)
+struct FDroneHitProxyHistorySettings
+{
+	GENERATED_BODY()
+
+	FDroneHitProxyHistorySettings();
+
+	/** The longest time, in seconds, a shot can be resolved in the past. Shots older than this are resolved this far back. */
+	UPROPERTY(EditDefaultsOnly, Category = Shooting, meta = (ClampMin = "0"))
+	float HistorySeconds;
+
+	/** The most frames of drone positions kept. At frame rates above MaxSnapshots / HistorySeconds the history covers less time. */
+	UPROPERTY(EditDefaultsOnly, Category = Shooting, meta = (ClampMin = "2", ClampMax = "128"))
+	int32 MaxSnapshots;
+};
+
+/**
+ * A short history of where each drone's hit proxy was, so a player shot can be tested against the drones where they were when
+ * the fire input was received rather than where they are when the shot is processed, which can be most of a long frame later.
+ * A snapshot of every proxy centre is recorded at the same point each frame, before any actor ticks, quantised to 16 bits per
+ * component relative to the bounds of that snapshot, in a ring of MaxSnapshots. Snapshots are indexed by registry handle slot
+ * so a drone is found without a search, and tagged with its handle generation so a slot reused by a new drone is never mistaken
+ * for the old one. Memory is MaxSnapshots * 8 bytes per handle slot.
+ * Fire input is stamped when the viewport receives it, before that frame's snapshot, so a shot is interpolated between the last
+ * two snapshots: the rewind achieved is under one frame, and HistorySeconds only bounds it.
+ */
+class UNREALSFAS_API FDroneHitProxyHistory
+{
+public:
+	FDroneHitProxyHistory();
+
+	/** Records where every drone's hit proxy is now. Called by the game mode once per frame before any actor ticks, after syncing the registry. */
+	void Record(const FDroneRegistry& Registry, const FDroneHitProxyHistorySettings& Settings);
+
+	/**
+	 * Same as FDroneRegistry::Raycast, against the hit proxies interpolated to the time AtCycles, in FPlatformTime cycles.
+	 * Drones are tested where they are now if AtCycles is 0, is after the last snapshot, or rewinding is disabled.
+	 */
+	FDroneHandle Raycast(const FDroneRegistry& Registry, uint64 AtCycles, const FVector& Start, const FVector& End, float MaxDistance, const FDroneHandle& Ignore, float& OutDistance);
+
+	/** Drops every snapshot. */
+	void Reset();
+
+	FORCEINLINE int32 NumSnapshots() const { return NumRecorded; }
+
+	/** Returns whether player shots are resolved at their input time. Controlled by SFAS.HitProxies.Rewind. */
+	static bool IsRewindEnabled();
+
+private:
+	/** A frame of hit proxy centres. Each centre is Origin + Quantised * Step. */
+	struct FSnapshot
+	{
+		uint64 Cycles;
+		FVector3f Origin;
+		float Step;
+	};
+
+	/** Fills the rewound centres with every drone's hit proxy at AtCycles. Returns false if the drones should be tested where they are now. */
+	bool Rewind(const FDroneRegistry& Registry, uint64 AtCycles);
+
+	/** Returns the hit proxy centre stored at the index of a snapshot. */
+	FORCEINLINE FVector3f Dequantise(const FSnapshot& Snapshot, int32 Index) const
+	{
+		return Snapshot.Origin + (FVector3f(QuantisedX[Index], QuantisedY[Index], QuantisedZ[Index]) * Snapshot.Step);
+	}
+
+	/** Returns the tag identifying the drone with the handle in a snapshot. Never 0, which marks an empty slot. */
+	static FORCEINLINE uint16 MakeTag(const FDroneHandle& Handle) { return (uint16)((Handle.Generation & 0x7fff) | 0x8000); }
+
+private:
+	/** The snapshots, in a ring. Head is the newest. */
+	TArray<FSnapshot> Snapshots;
+	int32 Head;
+	int32 NumRecorded;
+
+	/** The most handle slots each snapshot can hold. Grows with the registry, dropping the history when it does. */
+	int32 SlotCapacity;
+
+	/** The quantised centre and tag of each handle slot of each snapshot, at (snapshot * SlotCapacity) + slot. */
+	TArray<int16> QuantisedX;
+	TArray<int16> QuantisedY;
+	TArray<int16> QuantisedZ;
+	TArray<uint16> Tags;
+
+	/** The furthest back a shot can be resolved, in cycles. */
+	uint64 MaxRewindCycles;
+
+	/** The hit proxy centres of the last rewind, by dense index. Reused by the other pellets of a shot. */
+	TArray<float> RewoundX;
+	TArray<float> RewoundY;
+	TArray<float> RewoundZ;
+	uint64 RewoundCycles;
+	uint64 RewoundFrame;
+};
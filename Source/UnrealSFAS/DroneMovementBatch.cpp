@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneMovementBatch.h"
+#include "UnrealSFAS.h"
+#include "DroneRegistry.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Batched movement"), STAT_DroneMovementBatch, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batched moves"), STAT_DroneBatchedMoves, STATGROUP_SFASDrones);
+
+void FDroneMovementBatch::Tick(float DeltaSeconds, FDroneRegistry& Registry, const TArray<FVector2f>& Steering, const AUnrealSFASMaze* Maze)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneMovementBatch);
+
+	// Drones fall back to ticking their own movement while kinematic movement is disabled.
+	const bool kinematic = UDroneMovementComponent::IsKinematicEnabled();
+
+	// Gather the moves on the game thread.
+	Moves.Reset();
+	for (int32 i = 0; i < Registry.Num(); i++)
+	{
+		auto* droneMovement = Registry.GetMovement(i);
+		if (!droneMovement)
+		{
+			continue;
+		}
+
+		if (droneMovement->GetBatched() != kinematic)
+		{
+			droneMovement->SetBatched(kinematic);
+		}
+
+		FDroneMove move;
+		if (kinematic && droneMovement->PrepareMove(DeltaSeconds, move))
+		{
+			if (Steering.IsValidIndex(i))
+			{
+				move.Steering = Steering[i];
+			}
+			Moves.Add(move);
+		}
+	}
+
+	// Integrate and test against the maze grid in parallel.
+	ParallelFor(Moves.Num(), [this, Maze](int32 Index)
+		{
+			UDroneMovementComponent::CalculateMove(Moves[Index], Maze);
+		}, Moves.Num() < 64);
+
+	// Sweep the drones on the game thread.
+	for (const auto& move : Moves)
+	{
+		move.Component->ApplyMove(move);
+	}
+
+	SET_DWORD_STAT(STAT_DroneBatchedMoves, Moves.Num());
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneMovementComponent.h"
+
+class FDroneRegistry;
+
+/**
+ * Moves every drone with a drone movement component in one batch. Inputs are gathered and results applied on the game
+ * thread, and the kinematic integration and maze grid checks in between run in parallel.
+ */
+class UNREALSFAS_API FDroneMovementBatch
+{
+public:
+	/** Moves the drones in the registry. Steering is added to each drone's desired velocity, by dense index. Maze may be nullptr. */
+	void Tick(float DeltaSeconds, FDroneRegistry& Registry, const TArray<FVector2f>& Steering, const class AUnrealSFASMaze* Maze);
+
+private:
+	/** Scratch storage of this frame's moves. */
+	TArray<FDroneMove> Moves;
+};
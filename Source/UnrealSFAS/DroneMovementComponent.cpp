@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneMovementComponent.h"
+#include "UnrealSFAS.h"
+#include "UnrealSFASMaze.h"
+#include "UnrealSFASGameMode.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Kinematic move"), STAT_DroneKinematicMove, STATGROUP_SFASDrones);
+DECLARE_CYCLE_STAT(TEXT("Character movement move"), STAT_DroneCharacterMovementMove, STATGROUP_SFASDrones);
+
+static TAutoConsoleVariable<int32> CVarDroneKinematicMovement(
+	TEXT("SFAS.DroneMovement.Kinematic"),
+	1,
+	TEXT("1: drones use lightweight kinematic movement. 0: drones use the full character movement component."),
+	ECVF_Default);
+
+UDroneMovementComponent::UDroneMovementComponent()
+{
+	// Set default member values.
+	TimeSinceLastMove = 0.f;
+	IsBatched = false;
+	IsSettled = false;
+}
+
+void UDroneMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	if (!IsKinematicEnabled())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DroneCharacterMovementMove);
+		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DroneKinematicMove);
+
+	FDroneMove move;
+	if (PrepareMove(DeltaTime, move))
+	{
+		CalculateMove(move, GetMaze());
+		ApplyMove(move);
+	}
+}
+
+bool UDroneMovementComponent::IsKinematicEnabled()
+{
+	return CVarDroneKinematicMovement.GetValueOnGameThread() != 0;
+}
+
+void UDroneMovementComponent::SetBatched(bool Batched)
+{
+	IsBatched = Batched;
+	TimeSinceLastMove = 0.f;
+
+	// The character movement component may have moved the drone off the floor since it last settled.
+	IsSettled = false;
+
+	// Batched drones are moved by the game mode rather than ticking themselves.
+	SetComponentTickEnabled(!Batched);
+}
+
+bool UDroneMovementComponent::PrepareMove(float DeltaSeconds, FDroneMove& OutMove)
+{
+	// Batched drones keep to their tick interval by accumulating time. Self ticking drones are already ticked at their interval.
+	TimeSinceLastMove += DeltaSeconds;
+	if (IsBatched && (TimeSinceLastMove < GetComponentTickInterval()))
+	{
+		return false;
+	}
+
+	const float moveSeconds = TimeSinceLastMove;
+	TimeSinceLastMove = 0.f;
+
+	if (!HasValidData() || ShouldSkipUpdate(moveSeconds) || UpdatedComponent->IsSimulatingPhysics() || (moveSeconds <= 0.f))
+	{
+		return false;
+	}
+
+	// Path following requests a velocity. Direct input is used if there is no request.
+	FVector desiredVelocity = FVector::ZeroVector;
+	if (bHasRequestedVelocity)
+	{
+		desiredVelocity = bRequestedMoveWithMaxSpeed ? (RequestedVelocity.GetSafeNormal() * MaxWalkSpeed) : RequestedVelocity.GetClampedToMaxSize(MaxWalkSpeed);
+		bHasRequestedVelocity = false;
+	}
+
+	const FVector input = ConsumeInputVector();
+	if (!input.IsNearlyZero())
+	{
+		desiredVelocity = input.GetClampedToMaxSize(1.f) * MaxWalkSpeed;
+	}
+
+	// Drones steer in the horizontal plane. Gravity alone moves them vertically.
+	desiredVelocity.Z = 0.f;
+
+	OutMove.Component = this;
+	OutMove.Location = UpdatedComponent->GetComponentLocation();
+	OutMove.Velocity = Velocity;
+	OutMove.DesiredVelocity = desiredVelocity;
+	OutMove.Steering = FVector2f::ZeroVector;
+	OutMove.DeltaSeconds = moveSeconds;
+	OutMove.MaxSpeed = MaxWalkSpeed;
+	OutMove.Acceleration = GetMaxAcceleration();
+	OutMove.Deceleration = BrakingDecelerationWalking;
+	CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleSize(OutMove.Radius, OutMove.HalfHeight);
+	OutMove.GravityZ = GetGravityZ();
+	OutMove.Settled = IsSettled;
+
+	return true;
+}
+
+void UDroneMovementComponent::CalculateMove(FDroneMove& Move, const AUnrealSFASMaze* Maze)
+{
+	// Accelerate towards the steered desired velocity, or brake if there is none.
+	const FVector desiredVelocity = Move.DesiredVelocity + FVector(Move.Steering.X, Move.Steering.Y, 0.f);
+	FVector velocity(Move.Velocity.X, Move.Velocity.Y, 0.f);
+	const float rate = desiredVelocity.IsNearlyZero() ? Move.Deceleration : Move.Acceleration;
+	velocity += (desiredVelocity - velocity).GetClampedToMaxSize(rate * Move.DeltaSeconds);
+	velocity = velocity.GetClampedToMaxSize(Move.MaxSpeed);
+
+	// Fall until settled onto the floor.
+	velocity.Z = Move.Settled ? 0.f : (Move.Velocity.Z + (Move.GravityZ * Move.DeltaSeconds));
+
+	FVector delta = velocity * Move.DeltaSeconds;
+
+	// Stop movement along each axis that would take the drone's capsule into a maze wall taller than the bottom of the drone.
+	if (Maze)
+	{
+		const float bottom = Move.Location.Z - Move.HalfHeight;
+
+		if (delta.X != 0.f)
+		{
+			const FVector probe = Move.Location + FVector(delta.X + (FMath::Sign(delta.X) * Move.Radius), 0.f, 0.f);
+			if (Maze->GetWallTopHeight(AUnrealSFASMaze::WorldToCell(probe)) > bottom)
+			{
+				delta.X = 0.f;
+				velocity.X = 0.f;
+			}
+		}
+
+		if (delta.Y != 0.f)
+		{
+			const FVector probe = Move.Location + FVector(delta.X, delta.Y + (FMath::Sign(delta.Y) * Move.Radius), 0.f);
+			if (Maze->GetWallTopHeight(AUnrealSFASMaze::WorldToCell(probe)) > bottom)
+			{
+				delta.Y = 0.f;
+				velocity.Y = 0.f;
+			}
+		}
+	}
+
+	Move.NewVelocity = velocity;
+	Move.Delta = delta;
+}
+
+void UDroneMovementComponent::ApplyMove(const FDroneMove& Move)
+{
+	// One sweep for the horizontal move. Anything the grid doesn't know about, such as other drones and players, stops the drone.
+	FVector velocity = Move.NewVelocity;
+	const FVector horizontalDelta(Move.Delta.X, Move.Delta.Y, 0.f);
+	if (!horizontalDelta.IsNearlyZero())
+	{
+		FHitResult hit;
+		SafeMoveUpdatedComponent(horizontalDelta, UpdatedComponent->GetComponentQuat(), true, hit);
+
+		// Remove the part of the velocity heading into what was hit.
+		if (hit.IsValidBlockingHit())
+		{
+			velocity -= hit.Normal * FMath::Min(FVector::DotProduct(velocity, hit.Normal), 0.0);
+		}
+	}
+
+	// A separate sweep for the fall, so landing doesn't cut the horizontal move short. Landing on a walkable floor settles the drone.
+	if (Move.Delta.Z != 0.f)
+	{
+		FHitResult hit;
+		SafeMoveUpdatedComponent(FVector(0.f, 0.f, Move.Delta.Z), UpdatedComponent->GetComponentQuat(), true, hit);
+
+		if (hit.IsValidBlockingHit())
+		{
+			velocity.Z = 0.f;
+			IsSettled = IsWalkable(hit);
+		}
+	}
+
+	Velocity = velocity;
+	UpdateComponentVelocity();
+
+	// Turn towards the direction of travel or the controller's focus.
+	PhysicsRotation(Move.DeltaSeconds);
+}
+
+AUnrealSFASMaze* UDroneMovementComponent::GetMaze() const
+{
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		return unrealSFASGameMode->GetMaze();
+	}
+
+	return nullptr;
+}
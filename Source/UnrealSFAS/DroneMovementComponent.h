@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "DroneMovementComponent.generated.h"
+
+/** The inputs and results of one kinematic drone move. */
+struct FDroneMove
+{
+	class UDroneMovementComponent* Component;
+
+	/** Inputs, gathered on the game thread. */
+	FVector Location;
+	FVector Velocity;
+	FVector DesiredVelocity;
+
+	/** Separation and alignment steering added to the desired velocity. */
+	FVector2f Steering;
+	float DeltaSeconds;
+	float MaxSpeed;
+	float Acceleration;
+	float Deceleration;
+	float Radius;
+	float HalfHeight;
+
+	/** Gravity along Z. Only applied while the drone hasn't settled onto the floor. */
+	float GravityZ;
+	bool Settled;
+
+	/** Results, calculated on any thread. */
+	FVector NewVelocity;
+	FVector Delta;
+};
+
+/**
+ * Movement for drones. Skips the floor finding, step up and walking mode bookkeeping of the character movement component:
+ * the horizontal velocity is integrated kinematically, checked against the maze grid, and moved with a single sweep.
+ * MaxWalkSpeed is still the drone's top speed. Drones fall under gravity until a downward sweep lands them on a walkable
+ * floor, after which they stay at that height. The maze floor is flat, so a settled drone never needs to fall again.
+ *
+ * Moves are split into three stages so the game mode can batch every drone's move: PrepareMove and ApplyMove run on the
+ * game thread, and CalculateMove is a pure function that can run on any thread.
+ *
+ * Set SFAS.DroneMovement.Kinematic to 0 to fall back to the character movement component, to compare the cost of the two.
+ */
+UCLASS()
+class UNREALSFAS_API UDroneMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UDroneMovementComponent();
+
+	void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Returns whether drones use kinematic movement rather than the character movement component. */
+	static bool IsKinematicEnabled();
+
+	/** Sets whether the drone is moved by the game mode's movement batch instead of ticking itself. */
+	void SetBatched(bool Batched);
+
+	/** Returns whether the drone is moved by the game mode's movement batch. */
+	FORCEINLINE bool GetBatched() const { return IsBatched; }
+
+	/** Gathers the inputs of this frame's move. Returns false if the drone doesn't move this frame. */
+	bool PrepareMove(float DeltaSeconds, FDroneMove& OutMove);
+
+	/** Calculates the new velocity and movement delta of a move. Maze may be nullptr. Safe to call from any thread. */
+	static void CalculateMove(FDroneMove& Move, const class AUnrealSFASMaze* Maze);
+
+	/** Sweeps the drone by the calculated delta and updates its velocity and rotation. Settles the drone if it lands on a walkable floor. */
+	void ApplyMove(const FDroneMove& Move);
+
+private:
+	/** Returns the maze of the current level, or nullptr if there is none. */
+	class AUnrealSFASMaze* GetMaze() const;
+
+private:
+	/** Seconds of movement accumulated since the last batched move. Lets batched drones keep their significance tick interval. */
+	float TimeSinceLastMove;
+
+	/** Whether the game mode's movement batch moves this drone. */
+	bool IsBatched;
+
+	/** Whether the drone has landed on the floor and no longer falls. */
+	bool IsSettled;
+};
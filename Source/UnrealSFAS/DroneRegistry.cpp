@@ -0,0 +1,316 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneRegistry.h"
+#include "Async/ParallelFor.h"
+#include "DroneCharacter.h"
+#include "DroneHitProxies.h"
+#include "DroneMovementComponent.h"
+#include "UnrealSFASMaze.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+FDroneHandle FDroneRegistry::Add(ADroneCharacter* Drone, int32 InitialHitpoints)
+{
+	check(IsInGameThread());
+	check(Drone);
+
+	// Reuse a free handle slot if one is available, otherwise create a new one.
+	int32 slot = INDEX_NONE;
+	if (FreeSlots.Num() > 0)
+	{
+		slot = FreeSlots.Pop(false);
+	}
+	else
+	{
+		slot = SparseToDense.Add(INDEX_NONE);
+		Generations.Add(1);
+	}
+
+	FDroneHandle handle;
+	handle.Index = slot;
+	handle.Generation = Generations[slot];
+
+	// Append the drone's attributes to the end of the packed arrays.
+	const FVector location = Drone->GetActorLocation();
+	const int32 denseIndex = Handles.Add(handle);
+	Positions.Add(location);
+	Forwards.Add(FVector3f(Drone->GetActorForwardVector()));
+	Hitpoints.Add(InitialHitpoints);
+	Cells.Add(AUnrealSFASMaze::WorldToCell(location));
+	Flags.Add(InitialHitpoints > 0 ? EDroneStateFlags::Alive : EDroneStateFlags::None);
+	Significance.Add(EDroneSignificance::High);
+	Actors.Add(Drone);
+	Movements.Add(Cast<UDroneMovementComponent>(Drone->GetCharacterMovement()));
+
+	const FVector3f velocity(Drone->GetVelocity());
+	VelocityX.Add(velocity.X);
+	VelocityY.Add(velocity.Y);
+	VelocityZ.Add(velocity.Z);
+	MaxSpeeds.Add(Drone->GetCharacterMovement()->MaxWalkSpeed);
+	MinMotorPitches.Add(Drone->GetDefaultMotorAudioPitchMultiplier());
+	MaxMotorPitches.Add(Drone->GetMaxMotorAudioPitchMultiplierModifier());
+	MotorPitches.Add(Drone->GetDefaultMotorAudioPitchMultiplier());
+	SightTargets.Add(INDEX_NONE);
+	HitProxyX.Add(location.X);
+	HitProxyY.Add(location.Y);
+	HitProxyZ.Add(location.Z);
+	HitProxyRadiiSquared.Add(InitialHitpoints > 0 ? FMath::Square(Drone->GetArchetype()->GetHitProxyRadius()) : -1.f);
+
+	SparseToDense[slot] = denseIndex;
+
+	return handle;
+}
+
+void FDroneRegistry::Remove(const FDroneHandle& Handle)
+{
+	check(IsInGameThread());
+
+	const int32 denseIndex = GetDenseIndex(Handle);
+	if (denseIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Move the last drone into the removed drone's place to keep the arrays packed.
+	const int32 lastIndex = Handles.Num() - 1;
+	if (denseIndex != lastIndex)
+	{
+		SparseToDense[Handles[lastIndex].Index] = denseIndex;
+	}
+
+	Positions.RemoveAtSwap(denseIndex, 1, false);
+	Forwards.RemoveAtSwap(denseIndex, 1, false);
+	Hitpoints.RemoveAtSwap(denseIndex, 1, false);
+	Cells.RemoveAtSwap(denseIndex, 1, false);
+	Flags.RemoveAtSwap(denseIndex, 1, false);
+	Significance.RemoveAtSwap(denseIndex, 1, false);
+	Handles.RemoveAtSwap(denseIndex, 1, false);
+	Actors.RemoveAtSwap(denseIndex, 1, false);
+	Movements.RemoveAtSwap(denseIndex, 1, false);
+	VelocityX.RemoveAtSwap(denseIndex, 1, false);
+	VelocityY.RemoveAtSwap(denseIndex, 1, false);
+	VelocityZ.RemoveAtSwap(denseIndex, 1, false);
+	MaxSpeeds.RemoveAtSwap(denseIndex, 1, false);
+	MinMotorPitches.RemoveAtSwap(denseIndex, 1, false);
+	MaxMotorPitches.RemoveAtSwap(denseIndex, 1, false);
+	MotorPitches.RemoveAtSwap(denseIndex, 1, false);
+	SightTargets.RemoveAtSwap(denseIndex, 1, false);
+	HitProxyX.RemoveAtSwap(denseIndex, 1, false);
+	HitProxyY.RemoveAtSwap(denseIndex, 1, false);
+	HitProxyZ.RemoveAtSwap(denseIndex, 1, false);
+	HitProxyRadiiSquared.RemoveAtSwap(denseIndex, 1, false);
+
+	// Free the handle slot, invalidating any copies of the handle.
+	SparseToDense[Handle.Index] = INDEX_NONE;
+	Generations[Handle.Index]++;
+	FreeSlots.Add(Handle.Index);
+}
+
+void FDroneRegistry::Reset()
+{
+	check(IsInGameThread());
+
+	Positions.Reset();
+	Forwards.Reset();
+	Hitpoints.Reset();
+	Cells.Reset();
+	Flags.Reset();
+	Significance.Reset();
+	Handles.Reset();
+	Actors.Reset();
+	Movements.Reset();
+	VelocityX.Reset();
+	VelocityY.Reset();
+	VelocityZ.Reset();
+	MaxSpeeds.Reset();
+	MinMotorPitches.Reset();
+	MaxMotorPitches.Reset();
+	MotorPitches.Reset();
+	SightTargets.Reset();
+	HitProxyX.Reset();
+	HitProxyY.Reset();
+	HitProxyZ.Reset();
+	HitProxyRadiiSquared.Reset();
+
+	// Keep the generations so handles issued before the reset stay stale.
+	FreeSlots.Reset();
+	for (int32 i = 0; i < SparseToDense.Num(); i++)
+	{
+		if (SparseToDense[i] != INDEX_NONE)
+		{
+			SparseToDense[i] = INDEX_NONE;
+			Generations[i]++;
+		}
+		FreeSlots.Add(i);
+	}
+}
+
+bool FDroneRegistry::IsValid(const FDroneHandle& Handle) const
+{
+	return GetDenseIndex(Handle) != INDEX_NONE;
+}
+
+int32 FDroneRegistry::GetDenseIndex(const FDroneHandle& Handle) const
+{
+	if (!SparseToDense.IsValidIndex(Handle.Index) || (Generations[Handle.Index] != Handle.Generation))
+	{
+		return INDEX_NONE;
+	}
+
+	return SparseToDense[Handle.Index];
+}
+
+void FDroneRegistry::SyncFromActors()
+{
+	check(IsInGameThread());
+
+	// This is the only per frame pass over the drone actors. Everything downstream reads the packed arrays.
+	for (int32 i = 0; i < Actors.Num(); i++)
+	{
+		auto* drone = Actors[i];
+
+		const FVector location = drone->GetActorLocation();
+		Positions[i] = location;
+		Forwards[i] = FVector3f(drone->GetActorForwardVector());
+		Cells[i] = AUnrealSFASMaze::WorldToCell(location);
+		HitProxyX[i] = location.X;
+		HitProxyY[i] = location.Y;
+		HitProxyZ[i] = location.Z;
+
+		const FVector3f velocity(drone->GetVelocity());
+		VelocityX[i] = velocity.X;
+		VelocityY[i] = velocity.Y;
+		VelocityZ[i] = velocity.Z;
+		MaxSpeeds[i] = drone->GetCharacterMovement()->MaxWalkSpeed;
+	}
+}
+
+void FDroneRegistry::SetHitpoints(const FDroneHandle& Handle, int32 InHitpoints)
+{
+	const int32 denseIndex = GetDenseIndex(Handle);
+	if (denseIndex != INDEX_NONE)
+	{
+		Hitpoints[denseIndex] = InHitpoints;
+
+		// Dead drones can't be shot.
+		if (InHitpoints <= 0)
+		{
+			Flags[denseIndex] &= ~EDroneStateFlags::Alive;
+			HitProxyRadiiSquared[denseIndex] = -1.f;
+		}
+	}
+}
+
+void FDroneRegistry::SetFlags(const FDroneHandle& Handle, EDroneStateFlags InFlags, bool Enabled)
+{
+	const int32 denseIndex = GetDenseIndex(Handle);
+	if (denseIndex != INDEX_NONE)
+	{
+		if (Enabled)
+		{
+			Flags[denseIndex] |= InFlags;
+		}
+		else
+		{
+			Flags[denseIndex] &= ~InFlags;
+		}
+	}
+}
+
+void FDroneRegistry::SetSignificance(int32 DenseIndex, EDroneSignificance InSignificance)
+{
+	check(IsInGameThread());
+
+	Significance[DenseIndex] = InSignificance;
+}
+
+void FDroneRegistry::SetMotorPitch(int32 DenseIndex, float Pitch)
+{
+	check(IsInGameThread());
+
+	MotorPitches[DenseIndex] = Pitch;
+}
+
+void FDroneRegistry::SetSightTarget(int32 DenseIndex, int32 PlayerIndex)
+{
+	check(IsInGameThread());
+
+	SightTargets[DenseIndex] = static_cast<int8>(PlayerIndex);
+
+	// Keep the can see player flag in step with the sight target.
+	if (PlayerIndex != INDEX_NONE)
+	{
+		Flags[DenseIndex] |= EDroneStateFlags::CanSeePlayer;
+	}
+	else
+	{
+		Flags[DenseIndex] &= ~EDroneStateFlags::CanSeePlayer;
+	}
+}
+
+FDroneHandle FDroneRegistry::FindNearest(const FVector& Location, float MaxDistance) const
+{
+	FDroneHandle nearest;
+	double nearestDistanceSquared = FMath::Square(static_cast<double>(MaxDistance));
+
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		if (EnumHasAnyFlags(Flags[i], EDroneStateFlags::Alive))
+		{
+			const double distanceSquared = FVector::DistSquared(Positions[i], Location);
+			if (distanceSquared <= nearestDistanceSquared)
+			{
+				nearestDistanceSquared = distanceSquared;
+				nearest = Handles[i];
+			}
+		}
+	}
+
+	return nearest;
+}
+
+FDroneHitProxyView FDroneRegistry::GetHitProxies() const
+{
+	FDroneHitProxyView proxies;
+	proxies.CenterX = HitProxyX.GetData();
+	proxies.CenterY = HitProxyY.GetData();
+	proxies.CenterZ = HitProxyZ.GetData();
+	proxies.RadiiSquared = HitProxyRadiiSquared.GetData();
+	proxies.Num = Num();
+	return proxies;
+}
+
+FDroneHandle FDroneRegistry::Raycast(const FVector& Start, const FVector& End, float MaxDistance, const FDroneHandle& Ignore, float& OutDistance) const
+{
+	const int32 hitIndex = FDroneHitProxies::Raycast(GetHitProxies(), Start, End, MaxDistance, GetDenseIndex(Ignore), OutDistance);
+	return (hitIndex != INDEX_NONE) ? Handles[hitIndex] : FDroneHandle();
+}
+
+void FDroneRegistry::GatherInRadius(const FVector& Location, float Radius, TArray<FDroneHandle>& OutHandles) const
+{
+	const double radiusSquared = FMath::Square(static_cast<double>(Radius));
+
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		if (EnumHasAnyFlags(Flags[i], EDroneStateFlags::Alive) && (FVector::DistSquared(Positions[i], Location) <= radiusSquared))
+		{
+			OutHandles.Add(Handles[i]);
+		}
+	}
+}
+
+void FDroneRegistry::ParallelForEachChunk(TFunctionRef<void(int32 Begin, int32 End)> Body, int32 ChunkSize) const
+{
+	check(IsInGameThread());
+	check(ChunkSize > 0);
+
+	const int32 count = Num();
+	const int32 numChunks = FMath::DivideAndRoundUp(count, ChunkSize);
+
+	// Run small registries inline, the task overhead would outweigh the work.
+	ParallelFor(numChunks, [&Body, ChunkSize, count](int32 ChunkIndex)
+		{
+			const int32 begin = ChunkIndex * ChunkSize;
+			Body(begin, FMath::Min(begin + ChunkSize, count));
+		}, numChunks <= 1);
+}
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Bit flags describing the state of a drone stored in the drone registry. */
+enum class EDroneStateFlags : uint8
+{
+	None = 0,
+
+	/** The drone has hitpoints remaining. */
+	Alive = 1 << 0,
+
+	/** The drone can currently see a player. */
+	CanSeePlayer = 1 << 1,
+};
+ENUM_CLASS_FLAGS(EDroneStateFlags);
+
+/** How significant a drone currently is to the players. Less significant drones update at a lower fidelity. */
+enum class EDroneSignificance : uint8
+{
+	High,
+	Medium,
+	Low,
+	Dormant,
+
+	Num
+};
+
+/** Stable handle to a drone in the drone registry. A handle to a removed drone never matches a drone added later. */
+struct FDroneHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	FORCEINLINE bool IsSet() const { return Index != INDEX_NONE; }
+	FORCEINLINE void Reset() { Index = INDEX_NONE; Generation = 0; }
+
+	FORCEINLINE bool operator==(const FDroneHandle& Other) const { return (Index == Other.Index) && (Generation == Other.Generation); }
+	FORCEINLINE bool operator!=(const FDroneHandle& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Registry of every live drone in the game, stored as densely packed arrays (one array per attribute).
+ * Batch systems iterate the packed arrays directly by dense index without touching the drone actors.
+ * Dense indices change when a drone is removed, so anything kept across frames should store an FDroneHandle.
+ *
+ * Drones are added and removed on the game thread only. The packed arrays are safe to read from worker threads
+ * while the game thread is blocked in ParallelForEachChunk, which is the intended way to fan work out.
+ */
+class UNREALSFAS_API FDroneRegistry
+{
+public:
+	/** Adds a drone to the registry and returns its handle. */
+	FDroneHandle Add(class ADroneCharacter* Drone, int32 InitialHitpoints);
+
+	/** Removes the drone referenced by the handle. Does nothing if the handle is stale. */
+	void Remove(const FDroneHandle& Handle);
+
+	/** Removes every drone from the registry. */
+	void Reset();
+
+	/** Returns whether the handle references a drone that is still in the registry. */
+	bool IsValid(const FDroneHandle& Handle) const;
+
+	/** Returns the dense index of the drone referenced by the handle, or INDEX_NONE if the handle is stale. */
+	int32 GetDenseIndex(const FDroneHandle& Handle) const;
+
+	/** Copies the current location, facing and velocity of each drone actor into the packed arrays. Called once per frame by the game mode. */
+	void SyncFromActors();
+
+	/** Updates the stored hitpoints of a drone. Clears the alive flag when the hitpoints reach 0. */
+	void SetHitpoints(const FDroneHandle& Handle, int32 Hitpoints);
+
+	/** Sets or clears state flags on a drone. */
+	void SetFlags(const FDroneHandle& Handle, EDroneStateFlags InFlags, bool Enabled);
+
+	/** Sets the significance of the drone at the dense index. */
+	void SetSignificance(int32 DenseIndex, EDroneSignificance InSignificance);
+
+	/** Records the motor audio pitch of the drone at the dense index. */
+	void SetMotorPitch(int32 DenseIndex, float Pitch);
+
+	/** Records the index of the player the drone at the dense index can see, or INDEX_NONE if it can't see a player. */
+	void SetSightTarget(int32 DenseIndex, int32 PlayerIndex);
+
+	/** Returns the handle of the alive drone nearest to the location within MaxDistance, or an unset handle if there is none. */
+	FDroneHandle FindNearest(const FVector& Location, float MaxDistance = BIG_NUMBER) const;
+
+	/**
+	 * Returns the handle of the first alive drone whose hit proxy the segment from Start to End passes through before MaxDistance
+	 * along it, or an unset handle. OutDistance is set to the distance along the segment to the hit proxy. Ignore is never hit.
+	 */
+	FDroneHandle Raycast(const FVector& Start, const FVector& End, float MaxDistance, const FDroneHandle& Ignore, float& OutDistance) const;
+
+	/** Appends the handles of every alive drone within Radius of the location to OutHandles. */
+	void GatherInRadius(const FVector& Location, float Radius, TArray<FDroneHandle>& OutHandles) const;
+
+	/**
+	 * Runs Body over the dense index range in parallel chunks. Body receives the [Begin, End) range of a chunk.
+	 * Must be called from the game thread. Body may only read the packed arrays and write to its own chunk of caller owned output.
+	 */
+	void ParallelForEachChunk(TFunctionRef<void(int32 Begin, int32 End)> Body, int32 ChunkSize = 64) const;
+
+	FORCEINLINE int32 Num() const { return Handles.Num(); }
+	FORCEINLINE const TArray<FVector>& GetPositions() const { return Positions; }
+	FORCEINLINE const TArray<int32>& GetHitpoints() const { return Hitpoints; }
+	FORCEINLINE const TArray<FVector3f>& GetForwards() const { return Forwards; }
+	FORCEINLINE const TArray<FIntPoint>& GetCells() const { return Cells; }
+	FORCEINLINE const TArray<EDroneStateFlags>& GetFlags() const { return Flags; }
+	FORCEINLINE const TArray<EDroneSignificance>& GetSignificance() const { return Significance; }
+	FORCEINLINE const TArray<float>& GetVelocityX() const { return VelocityX; }
+	FORCEINLINE const TArray<float>& GetVelocityY() const { return VelocityY; }
+	FORCEINLINE const TArray<float>& GetVelocityZ() const { return VelocityZ; }
+	FORCEINLINE const TArray<float>& GetMaxSpeeds() const { return MaxSpeeds; }
+	FORCEINLINE const TArray<float>& GetMinMotorPitches() const { return MinMotorPitches; }
+	FORCEINLINE const TArray<float>& GetMaxMotorPitches() const { return MaxMotorPitches; }
+	FORCEINLINE const TArray<float>& GetMotorPitches() const { return MotorPitches; }
+	FORCEINLINE const TArray<int8>& GetSightTargets() const { return SightTargets; }
+	FORCEINLINE const TArray<FDroneHandle>& GetHandles() const { return Handles; }
+
+	/** Returns the number of handle slots, which bounds the Index of every handle the registry has given out. */
+	FORCEINLINE int32 GetHandleCapacity() const { return SparseToDense.Num(); }
+
+	/** Returns the packed hit proxy spheres of every drone, indexed by dense index. */
+	struct FDroneHitProxyView GetHitProxies() const;
+
+	/** Returns the drone actor at the dense index. Only batch systems that need to write results back to actors should use this. */
+	FORCEINLINE class ADroneCharacter* GetActor(int32 DenseIndex) const { return Actors[DenseIndex]; }
+
+	/** Returns the drone movement component of the drone at the dense index, or nullptr if it moves with another component. */
+	FORCEINLINE class UDroneMovementComponent* GetMovement(int32 DenseIndex) const { return Movements[DenseIndex]; }
+
+private:
+	/** Packed per drone attributes. Every array has one entry per registered drone, indexed by dense index. */
+	TArray<FVector> Positions;
+	TArray<FVector3f> Forwards;
+	TArray<int32> Hitpoints;
+	TArray<FIntPoint> Cells;
+	TArray<EDroneStateFlags> Flags;
+	TArray<EDroneSignificance> Significance;
+	TArray<FDroneHandle> Handles;
+
+	/** Velocity components are stored in separate float arrays so they can be loaded straight into vector registers. */
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> MaxSpeeds;
+
+	/** Motor audio pitch range of each drone, and its current pitch. */
+	TArray<float> MinMotorPitches;
+	TArray<float> MaxMotorPitches;
+	TArray<float> MotorPitches;
+
+	/** Hit proxy sphere of each drone, in single precision for the batched ray tests. The radius is negative for dead drones. */
+	TArray<float> HitProxyX;
+	TArray<float> HitProxyY;
+	TArray<float> HitProxyZ;
+	TArray<float> HitProxyRadiiSquared;
+
+	/** Index of the player each drone can see, or INDEX_NONE. */
+	TArray<int8> SightTargets;
+
+	TArray<class ADroneCharacter*> Actors;
+
+	/** Movement component of each drone, cast once when the drone is added. */
+	TArray<class UDroneMovementComponent*> Movements;
+
+	/** Maps handle index to dense index. INDEX_NONE for free slots. */
+	TArray<int32> SparseToDense;
+
+	/** The current generation of each handle slot. Incremented when a slot is freed so old handles become stale. */
+	TArray<uint32> Generations;
+
+	/** Handle slots available for reuse. */
+	TArray<int32> FreeSlots;
+};
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneSignificance.h"
+#include "UnrealSFAS.h"
+#include "DroneCharacter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update significance"), STAT_DroneSignificanceUpdate, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Drones high significance"), STAT_DronesHighSignificance, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Drones medium significance"), STAT_DronesMediumSignificance, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Drones low significance"), STAT_DronesLowSignificance, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Drones dormant"), STAT_DronesDormant, STATGROUP_SFASDrones);
+
+FDroneSignificanceSettings::FDroneSignificanceSettings()
+{
+	// Set default member values.
+	UpdateInterval = 0.25f;
+	MediumDistance = 1500.f;
+	LowDistance = 3000.f;
+	DormantDistance = 6000.f;
+	HiddenDistanceScale = 2.f;
+
+	// High significance drones update at full fidelity, which are the tier setting defaults.
+
+	Medium.AnimationTickInterval = 1.f / 30.f;
+	Medium.MovementMaxSimulationIterations = 4;
+	Medium.BehaviorTreeTickInterval = 0.1f;
+
+	Low.AnimationTickInterval = 0.1f;
+	Low.MovementTickInterval = 1.f / 30.f;
+	Low.MovementMaxSimulationIterations = 2;
+	Low.BehaviorTreeTickInterval = 0.25f;
+	Low.MotorAudioActive = false;
+
+	Dormant.AnimationTickInterval = 0.5f;
+	Dormant.MovementTickInterval = 0.1f;
+	Dormant.MovementMaxSimulationIterations = 1;
+	Dormant.BehaviorTreeTickInterval = 0.5f;
+	Dormant.MotorAudioActive = false;
+}
+
+const FDroneSignificanceTierSettings& FDroneSignificanceSettings::GetTierSettings(EDroneSignificance Significance) const
+{
+	switch (Significance)
+	{
+	case EDroneSignificance::Medium:
+		return Medium;
+	case EDroneSignificance::Low:
+		return Low;
+	case EDroneSignificance::Dormant:
+		return Dormant;
+	default:
+		return High;
+	}
+}
+
+FDroneSignificanceManager::FDroneSignificanceManager()
+{
+	// Set default member values.
+	TimeUntilUpdate = 0.f;
+}
+
+void FDroneSignificanceManager::Tick(float DeltaSeconds, FDroneRegistry& Registry, const TArray<FDroneSignificanceViewpoint>& Viewpoints, const FDroneSignificanceSettings& Settings)
+{
+	TimeUntilUpdate -= DeltaSeconds;
+	if (TimeUntilUpdate > 0.f)
+	{
+		return;
+	}
+	TimeUntilUpdate = Settings.UpdateInterval;
+
+	SCOPE_CYCLE_COUNTER(STAT_DroneSignificanceUpdate);
+
+	// Rate every drone in parallel from the packed positions.
+	const TArray<FVector>& positions = Registry.GetPositions();
+	NewSignificance.SetNumUninitialized(Registry.Num(), false);
+	Registry.ParallelForEachChunk([this, &positions, &Viewpoints, &Settings](int32 Begin, int32 End)
+		{
+			for (int32 i = Begin; i < End; i++)
+			{
+				NewSignificance[i] = CalculateSignificance(positions[i], Viewpoints, Settings);
+			}
+		});
+
+	// Apply the new tier to drones whose tier changed and count the drones in each tier.
+	uint32 tierCounts[static_cast<int32>(EDroneSignificance::Num)] = { 0 };
+	const TArray<EDroneSignificance>& currentSignificance = Registry.GetSignificance();
+	for (int32 i = 0; i < NewSignificance.Num(); i++)
+	{
+		const EDroneSignificance significance = NewSignificance[i];
+		if (significance != currentSignificance[i])
+		{
+			Registry.SetSignificance(i, significance);
+			Registry.GetActor(i)->ApplySignificance(significance, Settings.GetTierSettings(significance));
+		}
+
+		tierCounts[static_cast<int32>(significance)]++;
+	}
+
+	SET_DWORD_STAT(STAT_DronesHighSignificance, tierCounts[static_cast<int32>(EDroneSignificance::High)]);
+	SET_DWORD_STAT(STAT_DronesMediumSignificance, tierCounts[static_cast<int32>(EDroneSignificance::Medium)]);
+	SET_DWORD_STAT(STAT_DronesLowSignificance, tierCounts[static_cast<int32>(EDroneSignificance::Low)]);
+	SET_DWORD_STAT(STAT_DronesDormant, tierCounts[static_cast<int32>(EDroneSignificance::Dormant)]);
+}
+
+EDroneSignificance FDroneSignificanceManager::CalculateSignificance(const FVector& Location, const TArray<FDroneSignificanceViewpoint>& Viewpoints, const FDroneSignificanceSettings& Settings)
+{
+	// Without any players every drone is as significant as possible.
+	if (Viewpoints.Num() == 0)
+	{
+		return EDroneSignificance::High;
+	}
+
+	// Find the distance to the nearest player and whether any player's camera is facing the drone.
+	double nearestDistanceSquared = TNumericLimits<double>::Max();
+	bool visible = false;
+	for (const auto& viewpoint : Viewpoints)
+	{
+		nearestDistanceSquared = FMath::Min(nearestDistanceSquared, FVector::DistSquared(viewpoint.PawnLocation, Location));
+
+		const FVector toDrone = (Location - viewpoint.ViewLocation).GetSafeNormal();
+		if (FVector::DotProduct(toDrone, viewpoint.ViewDirection) >= viewpoint.CosHalfFOV)
+		{
+			visible = true;
+		}
+	}
+
+	// Drones the players can't see are rated as though they were further away.
+	double distance = FMath::Sqrt(nearestDistanceSquared);
+	if (!visible)
+	{
+		distance *= Settings.HiddenDistanceScale;
+	}
+
+	if (distance > Settings.DormantDistance)
+	{
+		return EDroneSignificance::Dormant;
+	}
+	if (distance > Settings.LowDistance)
+	{
+		return EDroneSignificance::Low;
+	}
+	if (distance > Settings.MediumDistance)
+	{
+		return EDroneSignificance::Medium;
+	}
+
+	return EDroneSignificance::High;
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneRegistry.h"
+#include "DroneSignificance.generated.h"
+
+/** How a drone updates while it is in a significance tier. */
+USTRUCT(BlueprintType)
+struct FDroneSignificanceTierSettings
+{
+	GENERATED_BODY()
+
+	/** Seconds between skeletal mesh animation updates. 0 updates every frame. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	float AnimationTickInterval = 0.f;
+
+	/** Seconds between movement component updates. 0 updates every frame. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	float MovementTickInterval = 0.f;
+
+	/** The maximum number of movement substeps per update. Lower values trade collision accuracy for speed. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance, meta = (ClampMin = "1"))
+	int32 MovementMaxSimulationIterations = 8;
+
+	/** Seconds between behavior tree updates. 0 updates every frame. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	float BehaviorTreeTickInterval = 0.f;
+
+	/** Whether drones in this tier can be given a motor voice. Drones without one are only heard through the crowd bed. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	bool MotorAudioActive = true;
+};
+
+/** Thresholds used to place drones into significance tiers, and how each tier updates. */
+USTRUCT(BlueprintType)
+struct FDroneSignificanceSettings
+{
+	GENERATED_BODY()
+
+	FDroneSignificanceSettings();
+
+	/** Seconds between significance updates. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	float UpdateInterval;
+
+	/** Drones further than this from the nearest player drop to the medium tier. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	float MediumDistance;
+
+	/** Drones further than this from the nearest player drop to the low tier. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	float LowDistance;
+
+	/** Drones further than this from the nearest player drop to the dormant tier. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	float DormantDistance;
+
+	/** The distance to a drone outside of every player's view is multiplied by this before it is compared against the thresholds. */
+	UPROPERTY(EditDefaultsOnly, Category = Significance, meta = (ClampMin = "1"))
+	float HiddenDistanceScale;
+
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	FDroneSignificanceTierSettings High;
+
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	FDroneSignificanceTierSettings Medium;
+
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	FDroneSignificanceTierSettings Low;
+
+	UPROPERTY(EditDefaultsOnly, Category = Significance)
+	FDroneSignificanceTierSettings Dormant;
+
+	/** Returns the update settings for the tier. */
+	const FDroneSignificanceTierSettings& GetTierSettings(EDroneSignificance Significance) const;
+};
+
+/** A player's point of view used to rate drone significance. */
+struct FDroneSignificanceViewpoint
+{
+	/** The location of the player's pawn. Distances are measured from here. */
+	FVector PawnLocation;
+
+	/** The location and direction of the player's camera. */
+	FVector ViewLocation;
+	FVector ViewDirection;
+
+	/** Cosine of half of the camera's horizontal field of view. */
+	float CosHalfFOV;
+};
+
+/**
+ * Rates every drone in the registry by its distance and visibility to the nearest player, and applies the update settings
+ * of the resulting tier to drones whose tier changed.
+ */
+class UNREALSFAS_API FDroneSignificanceManager
+{
+public:
+	FDroneSignificanceManager();
+
+	/** Re-rates the drones once every Settings.UpdateInterval seconds. */
+	void Tick(float DeltaSeconds, FDroneRegistry& Registry, const TArray<FDroneSignificanceViewpoint>& Viewpoints, const FDroneSignificanceSettings& Settings);
+
+	/** Returns the significance tier for a drone at the location. Safe to call from any thread. */
+	static EDroneSignificance CalculateSignificance(const FVector& Location, const TArray<FDroneSignificanceViewpoint>& Viewpoints, const FDroneSignificanceSettings& Settings);
+
+private:
+	/** Seconds until the next significance update. */
+	float TimeUntilUpdate;
+
+	/** Scratch storage of the newly calculated tiers, indexed by dense index. */
+	TArray<EDroneSignificance> NewSignificance;
+};
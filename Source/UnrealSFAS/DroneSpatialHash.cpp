@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneSpatialHash.h"
+
+FDroneSpatialHash::FDroneSpatialHash()
+{
+	// Set default member values.
+	InvCellSize = 1.f;
+	BucketMask = 0;
+}
+
+void FDroneSpatialHash::Build(const TArray<FVector>& Locations, float InCellSize)
+{
+	check(InCellSize > 0.f);
+
+	const int32 count = Locations.Num();
+	InvCellSize = 1.f / InCellSize;
+
+	// Twice as many buckets as locations keeps collisions between cells rare.
+	const uint32 numBuckets = FMath::RoundUpToPowerOfTwo(FMath::Max(count * 2, 16));
+	BucketMask = numBuckets - 1;
+
+	// Count the locations in each bucket.
+	BucketStarts.Reset();
+	BucketStarts.AddZeroed(numBuckets + 1);
+	LocationBuckets.SetNumUninitialized(count, false);
+
+	for (int32 i = 0; i < count; i++)
+	{
+		const uint32 bucket = HashCell(FMath::FloorToInt(Locations[i].X * InvCellSize), FMath::FloorToInt(Locations[i].Y * InvCellSize));
+		LocationBuckets[i] = bucket;
+		BucketStarts[bucket + 1]++;
+	}
+
+	// Turn the counts into the start of each bucket's run.
+	for (uint32 bucket = 0; bucket < numBuckets; bucket++)
+	{
+		BucketStarts[bucket + 1] += BucketStarts[bucket];
+	}
+
+	// Scatter the location indices into their bucket's run, using the end of each bucket's run as a write cursor.
+	SortedIndices.SetNumUninitialized(count, false);
+	for (int32 i = count - 1; i >= 0; i--)
+	{
+		SortedIndices[--BucketStarts[LocationBuckets[i] + 1]] = i;
+	}
+
+	// Each bucket's cursor sits one slot after the bucket and now holds the bucket's start, so shift them down one slot.
+	for (uint32 bucket = 0; bucket < numBuckets; bucket++)
+	{
+		BucketStarts[bucket] = BucketStarts[bucket + 1];
+	}
+	BucketStarts[numBuckets] = count;
+}
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid over the XY plane stored as a hash table, rebuilt from scratch each frame with a counting sort.
+ * Building is O(n) and queries only visit the 3x3 cells around a location, so the cell size must be at least the query radius.
+ * Queries are safe to run from any thread once the hash is built.
+ */
+class UNREALSFAS_API FDroneSpatialHash
+{
+public:
+	FDroneSpatialHash();
+
+	/** Rebuilds the hash over the locations. Indices passed to query visitors are indices into Locations. */
+	void Build(const TArray<FVector>& Locations, float InCellSize);
+
+	/**
+	 * Calls Visitor with the index of every location in the 3x3 cells around the location, including any at the location itself.
+	 * Locations in other cells that share a hash bucket are visited too, so visitors must still test the distance.
+	 */
+	template <typename VisitorType>
+	void ForEachNearby(const FVector& Location, VisitorType&& Visitor) const
+	{
+		if (SortedIndices.Num() == 0)
+		{
+			return;
+		}
+
+		const int32 cellX = FMath::FloorToInt(Location.X * InvCellSize);
+		const int32 cellY = FMath::FloorToInt(Location.Y * InvCellSize);
+
+		// Neighbouring cells can share a bucket. Each bucket is only visited once so no location is visited twice.
+		uint32 visitedBuckets[9];
+		int32 numVisited = 0;
+
+		for (int32 y = cellY - 1; y <= cellY + 1; y++)
+		{
+			for (int32 x = cellX - 1; x <= cellX + 1; x++)
+			{
+				const uint32 bucket = HashCell(x, y);
+
+				bool visited = false;
+				for (int32 v = 0; v < numVisited; v++)
+				{
+					visited |= (visitedBuckets[v] == bucket);
+				}
+				if (visited)
+				{
+					continue;
+				}
+				visitedBuckets[numVisited++] = bucket;
+
+				for (int32 i = BucketStarts[bucket]; i < BucketStarts[bucket + 1]; i++)
+				{
+					Visitor(SortedIndices[i]);
+				}
+			}
+		}
+	}
+
+private:
+	FORCEINLINE uint32 HashCell(int32 X, int32 Y) const
+	{
+		return ((static_cast<uint32>(X) * 73856093u) ^ (static_cast<uint32>(Y) * 19349663u)) & BucketMask;
+	}
+
+private:
+	float InvCellSize;
+	uint32 BucketMask;
+
+	/** Start of each bucket's run in SortedIndices. Has one more entry than there are buckets. */
+	TArray<int32> BucketStarts;
+
+	/** Location indices sorted by bucket. */
+	TArray<int32> SortedIndices;
+
+	/** Scratch storage of the bucket of each location. */
+	TArray<uint32> LocationBuckets;
+};
@@ -0,0 +1,381 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneSquadPlanner.h"
+#include "UnrealSFAS.h"
+#include "DroneVisibilityService.h"
+#include "UnrealSFASMaze.h"
+
+DECLARE_CYCLE_STAT(TEXT("Squad planning"), STAT_DroneSquadPlanning, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Squads"), STAT_DroneSquads, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Squad evaluations"), STAT_DroneSquadEvaluations, STATGROUP_SFASDrones);
+
+FDroneSquadSettings::FDroneSquadSettings()
+{
+	// Set default member values.
+	SquadSize = 4;
+	JoinRadius = 1500.f;
+	EvaluationInterval = 1.f;
+	MaxEvaluationsPerFrame = 4;
+	TargetMemorySeconds = 3.f;
+	FlankDistance = 700.f;
+	FlankArcDegrees = 120.f;
+	ShotSpacing = 0.3f;
+}
+
+FDroneSquadPlanner::FDroneSquadPlanner()
+{
+	// Set default member values.
+	EvaluationCursor = 0;
+	NumSquadsCreated = 0;
+	ShotSpacing = 0.f;
+}
+
+void FDroneSquadPlanner::AddDrone(const FDroneHandle& Handle, const FVector& Location, const FDroneRegistry& Registry, const FDroneSquadSettings& Settings)
+{
+	if (!Handle.IsSet())
+	{
+		return;
+	}
+
+	// Join the nearest squad with space whose lead drone is close enough.
+	const TArray<FVector>& positions = Registry.GetPositions();
+	int32 squadIndex = INDEX_NONE;
+	float nearestDistanceSquared = FMath::Square(Settings.JoinRadius);
+	for (int32 i = 0; i < Squads.Num(); i++)
+	{
+		const FSquad& squad = Squads[i];
+		if ((squad.Members.Num() == 0) || (squad.Members.Num() >= Settings.SquadSize))
+		{
+			continue;
+		}
+
+		const int32 leadIndex = Registry.GetDenseIndex(squad.Members[0].Handle);
+		if (leadIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const float distanceSquared = FVector::DistSquared(positions[leadIndex], Location);
+		if (distanceSquared <= nearestDistanceSquared)
+		{
+			nearestDistanceSquared = distanceSquared;
+			squadIndex = i;
+		}
+	}
+
+	// Otherwise start a new squad. Evaluation times are spread with the golden ratio so squads created together don't evaluate together.
+	if (squadIndex == INDEX_NONE)
+	{
+		squadIndex = Squads.AddDefaulted();
+		FSquad& squad = Squads[squadIndex];
+		squad.TargetPlayerIndex = INDEX_NONE;
+		squad.TargetLocation = Location;
+		squad.TimeSinceTargetSeen = 0.f;
+		squad.TimeUntilEvaluation = Settings.EvaluationInterval * FMath::Frac(NumSquadsCreated * 0.618034f);
+		squad.TimeSinceEvaluation = 0.f;
+		squad.NumFireRanks = 0;
+		NumSquadsCreated++;
+	}
+
+	FSquadMember member;
+	member.Handle = Handle;
+	member.FlankLocation = Location;
+	member.FireRank = 0;
+	const int32 memberIndex = Squads[squadIndex].Members.Add(member);
+
+	if (!MemberSlots.IsValidIndex(Handle.Index))
+	{
+		MemberSlots.Reserve(Handle.Index + 1);
+		while (MemberSlots.Num() <= Handle.Index)
+		{
+			MemberSlots.Add(FIntPoint::NoneValue);
+		}
+	}
+	MemberSlots[Handle.Index] = FIntPoint(squadIndex, memberIndex);
+}
+
+void FDroneSquadPlanner::Reset()
+{
+	Squads.Reset();
+	MemberSlots.Reset();
+	EvaluationCursor = 0;
+}
+
+void FDroneSquadPlanner::Tick(float DeltaSeconds, const FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Targets, const AUnrealSFASMaze* Maze, const FDroneSquadSettings& Settings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneSquadPlanning);
+
+	ShotSpacing = Settings.ShotSpacing;
+
+	for (FSquad& squad : Squads)
+	{
+		squad.TimeUntilEvaluation -= DeltaSeconds;
+		squad.TimeSinceEvaluation += DeltaSeconds;
+	}
+
+	// Evaluate the squads that are due, starting from where the last frame stopped, up to the per frame budget.
+	const int32 numSquads = Squads.Num();
+	int32 numEvaluations = 0;
+	for (int32 n = 0; (n < numSquads) && (numEvaluations < Settings.MaxEvaluationsPerFrame); n++)
+	{
+		const int32 squadIndex = (EvaluationCursor + n) % numSquads;
+		FSquad& squad = Squads[squadIndex];
+		if (squad.TimeUntilEvaluation > 0.f)
+		{
+			continue;
+		}
+
+		PruneMembers(squadIndex, Registry);
+		if (squad.Members.Num() > 0)
+		{
+			Evaluate(squad, Registry, Targets, Maze, Settings);
+		}
+
+		// Keep the squad's place in the schedule unless it has fallen a whole interval behind.
+		squad.TimeUntilEvaluation += Settings.EvaluationInterval;
+		if (squad.TimeUntilEvaluation <= 0.f)
+		{
+			squad.TimeUntilEvaluation = Settings.EvaluationInterval;
+		}
+		squad.TimeSinceEvaluation = 0.f;
+
+		EvaluationCursor = squadIndex + 1;
+		numEvaluations++;
+	}
+
+	// Squads that lost every member are removed once they have been evaluated.
+	for (int32 i = Squads.Num() - 1; i >= 0; i--)
+	{
+		if (Squads[i].Members.Num() == 0)
+		{
+			RemoveSquad(i);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_DroneSquads, Squads.Num());
+	SET_DWORD_STAT(STAT_DroneSquadEvaluations, numEvaluations);
+}
+
+bool FDroneSquadPlanner::GetOrder(const FDroneHandle& Handle, FDroneSquadOrder& OutOrder) const
+{
+	const FSquad* squad = nullptr;
+	const FSquadMember* member = FindMember(Handle, squad);
+	if (!member || (squad->TargetPlayerIndex == INDEX_NONE) || !squad->Target.IsValid())
+	{
+		return false;
+	}
+
+	OutOrder.Target = squad->Target.Get();
+	OutOrder.TargetLocation = squad->TargetLocation;
+	OutOrder.FlankLocation = member->FlankLocation;
+	return true;
+}
+
+bool FDroneSquadPlanner::IsFireTurn(const FDroneHandle& Handle, float GameSeconds) const
+{
+	const FSquad* squad = nullptr;
+	const FSquadMember* member = FindMember(Handle, squad);
+	if (!member || (squad->TargetPlayerIndex == INDEX_NONE) || (squad->NumFireRanks <= 1) || (ShotSpacing <= 0.f))
+	{
+		return true;
+	}
+
+	// The turn passes to the next member every ShotSpacing seconds.
+	const int32 turn = FMath::FloorToInt(GameSeconds / ShotSpacing) % squad->NumFireRanks;
+	return turn == member->FireRank;
+}
+
+const FDroneSquadPlanner::FSquadMember* FDroneSquadPlanner::FindMember(const FDroneHandle& Handle, const FSquad*& OutSquad) const
+{
+	if (!Handle.IsSet() || !MemberSlots.IsValidIndex(Handle.Index))
+	{
+		return nullptr;
+	}
+
+	const FIntPoint slot = MemberSlots[Handle.Index];
+	if (!Squads.IsValidIndex(slot.X) || !Squads[slot.X].Members.IsValidIndex(slot.Y))
+	{
+		return nullptr;
+	}
+
+	// A slot reused by a newer drone belongs to that drone.
+	const FSquadMember& member = Squads[slot.X].Members[slot.Y];
+	if (member.Handle != Handle)
+	{
+		return nullptr;
+	}
+
+	OutSquad = &Squads[slot.X];
+	return &member;
+}
+
+void FDroneSquadPlanner::PruneMembers(int32 SquadIndex, const FDroneRegistry& Registry)
+{
+	TArray<FSquadMember>& members = Squads[SquadIndex].Members;
+	for (int32 i = members.Num() - 1; i >= 0; i--)
+	{
+		if (Registry.IsValid(members[i].Handle))
+		{
+			continue;
+		}
+
+		// Only clear the slot if it hasn't been reused by a newer drone.
+		const int32 handleIndex = members[i].Handle.Index;
+		if (MemberSlots.IsValidIndex(handleIndex) && (MemberSlots[handleIndex] == FIntPoint(SquadIndex, i)))
+		{
+			MemberSlots[handleIndex] = FIntPoint::NoneValue;
+		}
+
+		// Point the slot of the member moved into the removed member's place at its new index.
+		const int32 lastIndex = members.Num() - 1;
+		members.RemoveAtSwap(i, 1, false);
+		if (i < members.Num())
+		{
+			const int32 movedHandleIndex = members[i].Handle.Index;
+			if (MemberSlots.IsValidIndex(movedHandleIndex) && (MemberSlots[movedHandleIndex] == FIntPoint(SquadIndex, lastIndex)))
+			{
+				MemberSlots[movedHandleIndex] = FIntPoint(SquadIndex, i);
+			}
+		}
+	}
+}
+
+void FDroneSquadPlanner::RemoveSquad(int32 SquadIndex)
+{
+	const int32 lastIndex = Squads.Num() - 1;
+	Squads.RemoveAtSwap(SquadIndex, 1, false);
+
+	// Point the slots of the squad moved into the removed squad's place at its new index.
+	if (SquadIndex < Squads.Num())
+	{
+		const TArray<FSquadMember>& members = Squads[SquadIndex].Members;
+		for (int32 i = 0; i < members.Num(); i++)
+		{
+			const int32 handleIndex = members[i].Handle.Index;
+			if (MemberSlots.IsValidIndex(handleIndex) && (MemberSlots[handleIndex] == FIntPoint(lastIndex, i)))
+			{
+				MemberSlots[handleIndex] = FIntPoint(SquadIndex, i);
+			}
+		}
+	}
+}
+
+void FDroneSquadPlanner::Evaluate(FSquad& Squad, const FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Targets, const AUnrealSFASMaze* Maze, const FDroneSquadSettings& Settings)
+{
+	const TArray<FVector>& positions = Registry.GetPositions();
+	const TArray<int8>& sightTargets = Registry.GetSightTargets();
+	const int32 numMembers = Squad.Members.Num();
+
+	// Find the middle of the squad and count how many members can see each player.
+	SightVotes.Reset();
+	SightVotes.AddZeroed(Targets.Num());
+	FVector centroid = FVector::ZeroVector;
+	for (const FSquadMember& member : Squad.Members)
+	{
+		const int32 denseIndex = Registry.GetDenseIndex(member.Handle);
+		centroid += positions[denseIndex];
+
+		for (int32 t = 0; t < Targets.Num(); t++)
+		{
+			if (Targets[t].PlayerIndex == sightTargets[denseIndex])
+			{
+				SightVotes[t]++;
+			}
+		}
+	}
+	centroid /= numMembers;
+
+	// Attack the player the most members can see. Ties go to the player nearest the squad.
+	int32 bestTarget = INDEX_NONE;
+	for (int32 t = 0; t < Targets.Num(); t++)
+	{
+		if (SightVotes[t] == 0)
+		{
+			continue;
+		}
+
+		if ((bestTarget == INDEX_NONE) || (SightVotes[t] > SightVotes[bestTarget]) ||
+			((SightVotes[t] == SightVotes[bestTarget]) && (FVector::DistSquared(Targets[t].Location, centroid) < FVector::DistSquared(Targets[bestTarget].Location, centroid))))
+		{
+			bestTarget = t;
+		}
+	}
+
+	if (bestTarget != INDEX_NONE)
+	{
+		Squad.TargetPlayerIndex = Targets[bestTarget].PlayerIndex;
+		Squad.Target = Targets[bestTarget].Actor;
+		Squad.TargetLocation = Targets[bestTarget].Location;
+		Squad.TimeSinceTargetSeen = 0.f;
+	}
+	else if (Squad.TargetPlayerIndex != INDEX_NONE)
+	{
+		// Keep hunting the last known location of an unseen target for a while, unless the player has left the game.
+		Squad.TimeSinceTargetSeen += Squad.TimeSinceEvaluation;
+		const bool targetInGame = Targets.ContainsByPredicate([&Squad](const FDroneSightTarget& Target) { return Target.PlayerIndex == Squad.TargetPlayerIndex; });
+		if (!targetInGame || (Squad.TimeSinceTargetSeen > Settings.TargetMemorySeconds))
+		{
+			Squad.TargetPlayerIndex = INDEX_NONE;
+			Squad.Target.Reset();
+		}
+	}
+
+	if (Squad.TargetPlayerIndex == INDEX_NONE)
+	{
+		Squad.NumFireRanks = 0;
+		return;
+	}
+
+	// The members nearest the target fire first.
+	SortScratch.Reset();
+	for (int32 i = 0; i < numMembers; i++)
+	{
+		const int32 denseIndex = Registry.GetDenseIndex(Squad.Members[i].Handle);
+		SortScratch.Emplace(FVector::DistSquared(positions[denseIndex], Squad.TargetLocation), i);
+	}
+	SortScratch.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+	for (int32 rank = 0; rank < numMembers; rank++)
+	{
+		Squad.Members[SortScratch[rank].Value].FireRank = rank;
+	}
+	Squad.NumFireRanks = numMembers;
+
+	// Spread the members across an arc around the target facing the squad. Members keep their order around the target so their paths don't cross.
+	FVector squadDirection = (centroid - Squad.TargetLocation).GetSafeNormal2D();
+	if (squadDirection.IsNearlyZero())
+	{
+		squadDirection = FVector::ForwardVector;
+	}
+	const float squadAngle = FMath::Atan2(squadDirection.Y, squadDirection.X);
+
+	SortScratch.Reset();
+	for (int32 i = 0; i < numMembers; i++)
+	{
+		const FVector toMember = positions[Registry.GetDenseIndex(Squad.Members[i].Handle)] - Squad.TargetLocation;
+		SortScratch.Emplace(FMath::FindDeltaAngleRadians(squadAngle, FMath::Atan2(toMember.Y, toMember.X)), i);
+	}
+	SortScratch.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+	const float arc = FMath::DegreesToRadians(Settings.FlankArcDegrees);
+	for (int32 slot = 0; slot < numMembers; slot++)
+	{
+		FSquadMember& member = Squad.Members[SortScratch[slot].Value];
+		const float altitude = positions[Registry.GetDenseIndex(member.Handle)].Z;
+		const float slotAngle = squadAngle + (arc * (((slot + 0.5f) / numMembers) - 0.5f));
+		const FVector slotDirection(FMath::Cos(slotAngle), FMath::Sin(slotAngle), 0.f);
+
+		// Pull positions inside of maze walls taller than the drone in towards the target until they reach an open cell.
+		float distance = Settings.FlankDistance;
+		FVector flankLocation = Squad.TargetLocation + (slotDirection * distance);
+		flankLocation.Z = altitude;
+		while (Maze && (distance > 0.f) && (Maze->GetWallTopHeight(AUnrealSFASMaze::WorldToCell(flankLocation)) > altitude))
+		{
+			distance -= AUnrealSFASMaze::BlockSize * 0.5f;
+			flankLocation = Squad.TargetLocation + (slotDirection * FMath::Max(distance, 0.f));
+			flankLocation.Z = altitude;
+		}
+
+		member.FlankLocation = flankLocation;
+	}
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneRegistry.h"
+#include "DroneSquadPlanner.generated.h"
+
+struct FDroneSightTarget;
+
+/** How drones are grouped into squads and how often squad plans are re-evaluated. */
+USTRUCT(BlueprintType)
+struct FDroneSquadSettings
+{
+	GENERATED_BODY()
+
+	FDroneSquadSettings();
+
+	/** The most drones in a squad. */
+	UPROPERTY(EditDefaultsOnly, Category = Squad, meta = (ClampMin = "1"))
+	int32 SquadSize;
+
+	/** A spawned drone joins the nearest squad with space whose lead drone is within this distance, otherwise it starts a new squad. */
+	UPROPERTY(EditDefaultsOnly, Category = Squad)
+	float JoinRadius;
+
+	/** Seconds between re-evaluations of each squad's plan. Squads are staggered across this interval. */
+	UPROPERTY(EditDefaultsOnly, Category = Squad)
+	float EvaluationInterval;
+
+	/** The most squad plans re-evaluated in one frame. Squads over the budget are re-evaluated on the following frames. */
+	UPROPERTY(EditDefaultsOnly, Category = Squad, meta = (ClampMin = "1"))
+	int32 MaxEvaluationsPerFrame;
+
+	/** Seconds a squad keeps chasing its target after no member can see it. */
+	UPROPERTY(EditDefaultsOnly, Category = Squad)
+	float TargetMemorySeconds;
+
+	/** The distance from the target of each member's flanking position. */
+	UPROPERTY(EditDefaultsOnly, Category = Squad)
+	float FlankDistance;
+
+	/** The angle of the arc around the target that members spread across, in degrees. */
+	UPROPERTY(EditDefaultsOnly, Category = Squad, meta = (ClampMin = "0", ClampMax = "360"))
+	float FlankArcDegrees;
+
+	/** Seconds between the shots of consecutive members in the squad's firing order. */
+	UPROPERTY(EditDefaultsOnly, Category = Squad)
+	float ShotSpacing;
+};
+
+/** A squad member's part of its squad's plan. */
+struct FDroneSquadOrder
+{
+	/** The player the squad is attacking. */
+	class AActor* Target;
+
+	/** The last known location of the target. */
+	FVector TargetLocation;
+
+	/** Where the member should fly to. */
+	FVector FlankLocation;
+};
+
+/**
+ * Groups drones into squads when they spawn and plans for each squad rather than each drone. A squad's plan picks the player
+ * the squad attacks, a flanking position around that player for each member and the order members fire in. Members read their
+ * order with cheap per drone behavior tree tasks, so decision cost scales with the number of squads rather than drones.
+ *
+ * Plans are re-evaluated on a staggered schedule: each squad starts at a different point of the evaluation interval and no
+ * more than a fixed number of squads are evaluated in one frame.
+ */
+class UNREALSFAS_API FDroneSquadPlanner
+{
+public:
+	FDroneSquadPlanner();
+
+	/** Adds a drone to the nearest squad with space, or to a new squad. */
+	void AddDrone(const FDroneHandle& Handle, const FVector& Location, const FDroneRegistry& Registry, const FDroneSquadSettings& Settings);
+
+	/** Removes every squad. */
+	void Reset();
+
+	/** Re-evaluates the plans of the squads that are due. Targets are the players drones can see. Maze may be nullptr. */
+	void Tick(float DeltaSeconds, const FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Targets, const class AUnrealSFASMaze* Maze, const FDroneSquadSettings& Settings);
+
+	/** Gets the drone's part of its squad's plan. Returns false if the drone isn't in a squad or its squad has no target. */
+	bool GetOrder(const FDroneHandle& Handle, FDroneSquadOrder& OutOrder) const;
+
+	/** Returns whether it is the drone's turn in its squad's firing order. Always true for drones without a squad plan. */
+	bool IsFireTurn(const FDroneHandle& Handle, float GameSeconds) const;
+
+	FORCEINLINE int32 NumSquads() const { return Squads.Num(); }
+
+private:
+	struct FSquadMember
+	{
+		FDroneHandle Handle;
+		FVector FlankLocation;
+
+		/** The member's place in the squad's firing order. */
+		int32 FireRank;
+	};
+
+	struct FSquad
+	{
+		TArray<FSquadMember> Members;
+
+		/** The player the squad is attacking. Index of the player, or INDEX_NONE if the squad has no target. */
+		int32 TargetPlayerIndex;
+		TWeakObjectPtr<class AActor> Target;
+		FVector TargetLocation;
+
+		float TimeSinceTargetSeen;
+		float TimeUntilEvaluation;
+		float TimeSinceEvaluation;
+
+		/** The number of places in the firing order. */
+		int32 NumFireRanks;
+	};
+
+	/** Finds the member of the squad with the handle. Returns nullptr if the drone isn't in a squad. */
+	const FSquadMember* FindMember(const FDroneHandle& Handle, const FSquad*& OutSquad) const;
+
+	/** Removes members whose drones no longer exist. */
+	void PruneMembers(int32 SquadIndex, const FDroneRegistry& Registry);
+
+	/** Removes the squad, moving the last squad into its place. */
+	void RemoveSquad(int32 SquadIndex);
+
+	/** Re-plans the squad's target, flanking positions and firing order. */
+	void Evaluate(FSquad& Squad, const FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Targets, const class AUnrealSFASMaze* Maze, const FDroneSquadSettings& Settings);
+
+private:
+	TArray<FSquad> Squads;
+
+	/** The squad and member index of each drone, indexed by registry handle index. X is INDEX_NONE for drones without a squad. */
+	TArray<FIntPoint> MemberSlots;
+
+	/** The squad evaluation starts from next frame, so squads over the per frame budget aren't starved. */
+	int32 EvaluationCursor;
+
+	/** The number of squads created, used to spread their evaluation times. */
+	int32 NumSquadsCreated;
+
+	/** Seconds between the shots of consecutive members in a squad's firing order. */
+	float ShotSpacing;
+
+	/** Scratch storage used while evaluating a squad. */
+	TArray<int32> SightVotes;
+	TArray<TPair<float, int32>> SortScratch;
+};
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneSteering.h"
+#include "UnrealSFAS.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spatial hash build"), STAT_DroneSpatialHashBuild, STATGROUP_SFASDrones);
+DECLARE_CYCLE_STAT(TEXT("Steering"), STAT_DroneSteering, STATGROUP_SFASDrones);
+
+namespace DroneSteering
+{
+	/** The number of drones each parallel task steers. */
+	constexpr int32 ChunkSize = 64;
+}
+
+FDroneSteeringSettings::FDroneSteeringSettings()
+{
+	// Set default member values.
+	NeighbourRadius = 250.f;
+	SeparationWeight = 1.f;
+	AlignmentWeight = 0.3f;
+	MaxSteeringSpeed = 300.f;
+}
+
+void FDroneSteering::Calculate(const TArray<FVector>& Positions, const TArray<float>& VelocityX, const TArray<float>& VelocityY, const FDroneSteeringSettings& Settings)
+{
+	const int32 count = Positions.Num();
+	Steering.SetNumUninitialized(count, false);
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DroneSpatialHashBuild);
+		SpatialHash.Build(Positions, Settings.NeighbourRadius);
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DroneSteering);
+
+	const float radiusSquared = FMath::Square(Settings.NeighbourRadius);
+	const float invRadius = 1.f / Settings.NeighbourRadius;
+	const int32 numChunks = FMath::DivideAndRoundUp(count, DroneSteering::ChunkSize);
+
+	ParallelFor(numChunks, [this, &Positions, &VelocityX, &VelocityY, &Settings, count, radiusSquared, invRadius](int32 ChunkIndex)
+		{
+			const int32 begin = ChunkIndex * DroneSteering::ChunkSize;
+			const int32 end = FMath::Min(begin + DroneSteering::ChunkSize, count);
+
+			for (int32 i = begin; i < end; i++)
+			{
+				const FVector2f position(Positions[i].X, Positions[i].Y);
+				FVector2f separation = FVector2f::ZeroVector;
+				FVector2f neighbourVelocity = FVector2f::ZeroVector;
+				int32 numNeighbours = 0;
+
+				SpatialHash.ForEachNearby(Positions[i], [&](int32 Other)
+					{
+						if (Other == i)
+						{
+							return;
+						}
+
+						const FVector2f offset = position - FVector2f(Positions[Other].X, Positions[Other].Y);
+						const float distanceSquared = offset.SizeSquared();
+						if (distanceSquared >= radiusSquared)
+						{
+							return;
+						}
+
+						// Push away harder the closer the neighbour is. Drones on top of each other are pushed apart along an arbitrary axis.
+						const float distance = FMath::Sqrt(distanceSquared);
+						const FVector2f awayDirection = (distance > KINDA_SMALL_NUMBER) ? (offset / distance) : FVector2f((i < Other) ? 1.f : -1.f, 0.f);
+						separation += awayDirection * (1.f - (distance * invRadius));
+
+						neighbourVelocity += FVector2f(VelocityX[Other], VelocityY[Other]);
+						numNeighbours++;
+					});
+
+				FVector2f steering = separation * (Settings.SeparationWeight * Settings.MaxSteeringSpeed);
+				if (numNeighbours > 0)
+				{
+					const FVector2f averageVelocity = neighbourVelocity / static_cast<float>(numNeighbours);
+					steering += (averageVelocity - FVector2f(VelocityX[i], VelocityY[i])) * Settings.AlignmentWeight;
+				}
+
+				Steering[i] = steering.GetClampedToMaxSize(Settings.MaxSteeringSpeed);
+			}
+		}, numChunks <= 1);
+}
+
+namespace DroneSteering
+{
+	/** Results of one converge benchmark run. */
+	struct FBenchmarkResult
+	{
+		double SteeringMilliseconds;
+		float MeanNearestDistance;
+		float MinNearestDistance;
+	};
+
+	/** Flies Count drones from a ring towards one target for NumFrames frames and measures the steering cost and how tightly they pile up. */
+	static FBenchmarkResult RunConverge(int32 Count, int32 NumFrames, bool UseSteering)
+	{
+		const float deltaSeconds = 1.f / 60.f;
+		const float maxSpeed = 600.f;
+		const float maxVelocityChange = 1200.f * deltaSeconds;
+		const FDroneSteeringSettings settings;
+		FRandomStream randomStream(Count);
+
+		TArray<FVector> positions;
+		TArray<float> velocityX;
+		TArray<float> velocityY;
+		for (int32 i = 0; i < Count; i++)
+		{
+			const float angle = randomStream.FRandRange(0.f, 2.f * PI);
+			const float distance = randomStream.FRandRange(1500.f, 2500.f);
+			positions.Add(FVector(FMath::Cos(angle) * distance, FMath::Sin(angle) * distance, 150.f));
+			velocityX.Add(0.f);
+			velocityY.Add(0.f);
+		}
+
+		FDroneSteering steering;
+		double steeringSeconds = 0.0;
+
+		for (int32 frame = 0; frame < NumFrames; frame++)
+		{
+			if (UseSteering)
+			{
+				const double startSeconds = FPlatformTime::Seconds();
+				steering.Calculate(positions, velocityX, velocityY, settings);
+				steeringSeconds += FPlatformTime::Seconds() - startSeconds;
+			}
+
+			// Seek the target at the origin, stopping within 100 units of it, as the drones' move to does.
+			for (int32 i = 0; i < Count; i++)
+			{
+				const FVector2f toTarget(-positions[i].X, -positions[i].Y);
+				FVector2f desiredVelocity = (toTarget.Size() > 100.f) ? (toTarget.GetSafeNormal() * maxSpeed) : FVector2f::ZeroVector;
+				if (UseSteering)
+				{
+					desiredVelocity += steering.GetSteering()[i];
+				}
+
+				FVector2f velocity(velocityX[i], velocityY[i]);
+				velocity += (desiredVelocity - velocity).GetClampedToMaxSize(maxVelocityChange);
+				velocity = velocity.GetClampedToMaxSize(maxSpeed);
+
+				velocityX[i] = velocity.X;
+				velocityY[i] = velocity.Y;
+				positions[i].X += velocity.X * deltaSeconds;
+				positions[i].Y += velocity.Y * deltaSeconds;
+			}
+		}
+
+		// Measure how close each drone ended up to its nearest neighbour.
+		FDroneSpatialHash spatialHash;
+		spatialHash.Build(positions, settings.NeighbourRadius);
+
+		double totalNearestDistance = 0.0;
+		float minNearestDistance = settings.NeighbourRadius;
+		for (int32 i = 0; i < Count; i++)
+		{
+			float nearestDistance = settings.NeighbourRadius;
+			spatialHash.ForEachNearby(positions[i], [&](int32 Other)
+				{
+					if (Other != i)
+					{
+						nearestDistance = FMath::Min(nearestDistance, static_cast<float>(FVector::Dist2D(positions[i], positions[Other])));
+					}
+				});
+
+			totalNearestDistance += nearestDistance;
+			minNearestDistance = FMath::Min(minNearestDistance, nearestDistance);
+		}
+
+		FBenchmarkResult result;
+		result.SteeringMilliseconds = (steeringSeconds * 1000.0) / NumFrames;
+		result.MeanNearestDistance = static_cast<float>(totalNearestDistance / FMath::Max(Count, 1));
+		result.MinNearestDistance = minNearestDistance;
+		return result;
+	}
+
+	/** Runs the converge benchmark with and without steering and logs the results. */
+	static void RunBenchmark(const TArray<FString>& Args)
+	{
+		const int32 count = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 2) : 500;
+		const int32 numFrames = (Args.Num() > 1) ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 600;
+
+		const FBenchmarkResult withoutSteering = RunConverge(count, numFrames, false);
+		const FBenchmarkResult withSteering = RunConverge(count, numFrames, true);
+
+		UE_LOG(LogUnrealSFAS, Display, TEXT("Drone steering benchmark: %d drones converging for %d frames"), count, numFrames);
+		UE_LOG(LogUnrealSFAS, Display, TEXT("  Without steering: nearest neighbour mean %.1f, min %.1f"), withoutSteering.MeanNearestDistance, withoutSteering.MinNearestDistance);
+		UE_LOG(LogUnrealSFAS, Display, TEXT("  With steering: nearest neighbour mean %.1f, min %.1f, %.3f ms per frame"), withSteering.MeanNearestDistance, withSteering.MinNearestDistance, withSteering.SteeringMilliseconds);
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("SFAS.DroneSteering.Benchmark"),
+		TEXT("Flies drones onto one target with and without separation steering and logs the steering cost and spacing. Optional arguments: number of drones, number of frames."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+}
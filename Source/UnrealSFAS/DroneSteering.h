@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneSpatialHash.h"
+#include "DroneSteering.generated.h"
+
+/** How strongly drones steer to keep apart and fly with their neighbours. */
+USTRUCT(BlueprintType)
+struct FDroneSteeringSettings
+{
+	GENERATED_BODY()
+
+	FDroneSteeringSettings();
+
+	/** Drones closer than this to each other are neighbours. Also the cell size of the spatial hash. */
+	UPROPERTY(EditDefaultsOnly, Category = Steering, meta = (ClampMin = "1"))
+	float NeighbourRadius;
+
+	/** How strongly drones push away from their neighbours, in the range 0 - 1. 1 steers at MaxSteeringSpeed when touching a neighbour. */
+	UPROPERTY(EditDefaultsOnly, Category = Steering, meta = (ClampMin = "0", ClampMax = "1"))
+	float SeparationWeight;
+
+	/** How strongly drones match the velocity of their neighbours, in the range 0 - 1. */
+	UPROPERTY(EditDefaultsOnly, Category = Steering, meta = (ClampMin = "0", ClampMax = "1"))
+	float AlignmentWeight;
+
+	/** The largest velocity steering can add to a drone's desired velocity. */
+	UPROPERTY(EditDefaultsOnly, Category = Steering)
+	float MaxSteeringSpeed;
+};
+
+/**
+ * Calculates separation and alignment steering for every drone from its neighbours, found through a spatial hash that is
+ * rebuilt every frame. The steering is added to each drone's desired velocity by the movement batch, so drones spread out
+ * before their capsules touch and collision only has to stop them overlapping.
+ */
+class UNREALSFAS_API FDroneSteering
+{
+public:
+	/** Rebuilds the spatial hash and calculates the steering of every drone. Velocities are split into components by drone. */
+	void Calculate(const TArray<FVector>& Positions, const TArray<float>& VelocityX, const TArray<float>& VelocityY, const FDroneSteeringSettings& Settings);
+
+	/** Returns the steering velocity of each drone, in the same order as the positions passed to Calculate. */
+	FORCEINLINE const TArray<FVector2f>& GetSteering() const { return Steering; }
+
+private:
+	FDroneSpatialHash SpatialHash;
+
+	TArray<FVector2f> Steering;
+};
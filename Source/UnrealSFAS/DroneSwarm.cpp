@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneSwarm.h"
+#include "UnrealSFAS.h"
+#include "DroneCharacter.h"
+#include "DroneArchetype.h"
+#include "DroneVisibilityService.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Swarm instance update"), STAT_DroneSwarmInstanceUpdate, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Swarm drones"), STAT_DroneSwarmDrones, STATGROUP_SFASDrones);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Swarm drones promoted"), STAT_DroneSwarmPromotions, STATGROUP_SFASDrones);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Swarm shots fired"), STAT_DroneSwarmShots, STATGROUP_SFASDrones);
+
+// Sets default values
+ADroneSwarm::ADroneSwarm()
+{
+	// The swarm is updated by the game mode.
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Setup the instanced mesh. Shots are tested against the simulation directly, so the instances need no collision.
+	Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetGenerateOverlapEvents(false);
+	Instances->SetMobility(EComponentMobility::Movable);
+	RootComponent = Instances;
+
+	// Tag the swarm as an enemy like the drone characters it stands in for.
+	Tags.Add(FName("Enemy"));
+
+	// Set member default values.
+	DroneClass = nullptr;
+	PromotionRadius = 1500.f;
+	MaxPromotionsPerTick = 4;
+}
+
+void ADroneSwarm::SetDroneClass(TSubclassOf<ADroneCharacter> InDroneClass)
+{
+	DroneClass = InDroneClass;
+}
+
+void ADroneSwarm::SpawnDrone(const FVector& Location, int32 Hitpoints)
+{
+	Simulation.Add(Location, Hitpoints, Settings);
+	Instances->AddInstance(FTransform(Location), true);
+}
+
+void ADroneSwarm::UpdateSwarm(float DeltaSeconds, const TArray<FDroneSightTarget>& Players, const AUnrealSFASMaze* Maze, FHitscanService& HitscanService, const FDroneRegistry& Registry)
+{
+	if (Simulation.Num() == 0)
+	{
+		return;
+	}
+
+	PlayerLocations.Reset();
+	for (const auto& player : Players)
+	{
+		PlayerLocations.Add(player.Location);
+	}
+
+	// Swarm drones shoot as far as the drone characters they stand in for. Without a drone class they have nothing to shoot with.
+	const float maxShotDistance = DroneClass ? DroneClass.GetDefaultObject()->GetArchetype()->GetMaxShotDistance() : 0.f;
+	Simulation.Tick(DeltaSeconds, PlayerLocations, Maze, maxShotDistance, Settings);
+
+	// Fire before promoting, as promotion moves drones to other indices.
+	FireShots(Players, HitscanService, Registry);
+
+	// Promote the swarm drones nearest to the players. The candidates are gathered in index order, so sort them by the distance
+	// to the nearest player and keep the closest.
+	PromotionCandidates.Reset();
+	Simulation.GatherInRadius(PlayerLocations, PromotionRadius, PromotionCandidates);
+	if (PromotionCandidates.Num() > MaxPromotionsPerTick)
+	{
+		auto nearestPlayerDistanceSquared = [this](int32 Index)
+		{
+			const FVector location = Simulation.GetLocation(Index);
+			float distanceSquared = BIG_NUMBER;
+			for (const FVector& playerLocation : PlayerLocations)
+			{
+				distanceSquared = FMath::Min(distanceSquared, (float)FVector::DistSquared(location, playerLocation));
+			}
+			return distanceSquared;
+		};
+
+		PromotionCandidateDistances.Reset();
+		for (const int32 index : PromotionCandidates)
+		{
+			PromotionCandidateDistances.Emplace(nearestPlayerDistanceSquared(index), index);
+		}
+		PromotionCandidateDistances.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+		PromotionCandidates.Reset();
+		for (int32 i = 0; i < FMath::Max(MaxPromotionsPerTick, 0); i++)
+		{
+			PromotionCandidates.Add(PromotionCandidateDistances[i].Value);
+		}
+	}
+
+	// Promote highest indices first so removals don't move the remaining candidates.
+	PromotionCandidates.Sort([](int32 A, int32 B) { return A > B; });
+	for (const int32 index : PromotionCandidates)
+	{
+		Promote(index);
+	}
+
+	// Push every instance transform to the renderer in one batch.
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DroneSwarmInstanceUpdate);
+		Instances->BatchUpdateInstancesTransforms(0, Simulation.GetInstanceTransforms(), true, true, true);
+	}
+
+	SET_DWORD_STAT(STAT_DroneSwarmDrones, Simulation.Num());
+}
+
+ADroneCharacter* ADroneSwarm::PromoteHitDrone(const FVector& Start, const FVector& End, float MaxDistance)
+{
+	float distance = 0.f;
+	const int32 index = Simulation.Raycast(Start, End, Settings.HitRadius, distance);
+	if ((index == INDEX_NONE) || (distance > MaxDistance))
+	{
+		return nullptr;
+	}
+
+	return Promote(index);
+}
+
+ADroneCharacter* ADroneSwarm::Promote(int32 Index)
+{
+	ADroneCharacter* drone = nullptr;
+
+	// Check the world and drone class are valid.
+	auto* world = GetWorld();
+	if (world && DroneClass)
+	{
+		drone = world->SpawnActor<ADroneCharacter>(DroneClass.Get(), Simulation.GetLocation(Index), FRotator(0.f, Simulation.GetYaw(Index), 0.f));
+
+		// Carry the swarm drone's hitpoints over to the drone character.
+		if (drone)
+		{
+			drone->AddHitpoints(Simulation.GetHitpoints(Index) - drone->GetHitpoints());
+			INC_DWORD_STAT(STAT_DroneSwarmPromotions);
+		}
+	}
+
+	// The swarm drone is only removed once it is a drone character, so it is never lost from the wave.
+	if (drone)
+	{
+		RemoveDrone(Index);
+	}
+
+	return drone;
+}
+
+void ADroneSwarm::FireShots(const TArray<FDroneSightTarget>& Players, FHitscanService& HitscanService, const FDroneRegistry& Registry)
+{
+	if (!DroneClass)
+	{
+		return;
+	}
+
+	const auto* archetype = DroneClass.GetDefaultObject()->GetArchetype();
+
+	Shots.Reset();
+	for (int32 i = 0; i < Simulation.Num(); i++)
+	{
+		const int32 target = Simulation.GetShotTarget(i);
+		if (!Players.IsValidIndex(target))
+		{
+			continue;
+		}
+
+		// The swarm has no collision, so the trace only stops at world geometry and players. Drone characters in the way block the shot.
+		FHitscanShot& shot = Shots.AddDefaulted_GetRef();
+		shot.Source = EHitscanShotSource::Drone;
+		shot.Shooter = this;
+		shot.Target = Players[target].Actor;
+		shot.Start = Simulation.GetLocation(i);
+		shot.End = Players[target].Location;
+		shot.Damage = FMath::RandRange(archetype->GetMinShotDamage(), archetype->GetMaxShotDamage());
+	}
+
+	if (Shots.Num() > 0)
+	{
+		HitscanService.FireShots(GetWorld(), Registry, Shots);
+		INC_DWORD_STAT_BY(STAT_DroneSwarmShots, Shots.Num());
+	}
+}
+
+void ADroneSwarm::RemoveDrone(int32 Index)
+{
+	Simulation.RemoveAtSwap(Index);
+
+	// Move the last instance into the removed drone's place to match the simulation, then drop the last instance.
+	if (Index < Simulation.Num())
+	{
+		Instances->UpdateInstanceTransform(Index, Simulation.GetInstanceTransforms()[Index], true, false, true);
+	}
+	Instances->RemoveInstance(Instances->GetInstanceCount() - 1);
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "DroneSwarmSimulation.h"
+#include "HitscanService.h"
+#include "DroneSwarm.generated.h"
+
+/**
+ * Renders and drives a swarm of lightweight drones that have no actor of their own, so a wave can hold far more drones
+ * than could be simulated as characters. The swarm drones are drawn with a single instanced static mesh component.
+ *
+ * A swarm drone is promoted to a full drone character when it comes near a player or is shot. Promoted drones are
+ * removed from the swarm and count towards the wave like any other drone character. Until then, swarm drones chasing a
+ * player within the drone class's shot range fire hitscan shots at them through the game mode's hitscan service.
+ */
+UCLASS()
+class UNREALSFAS_API ADroneSwarm : public AActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Swarm, meta = (AllowPrivateAccess = "true"))
+	class UInstancedStaticMeshComponent* Instances;
+
+public:
+	// Sets default values for this actor's properties
+	ADroneSwarm();
+
+	/** Sets the drone character class swarm drones are promoted to. */
+	void SetDroneClass(TSubclassOf<class ADroneCharacter> InDroneClass);
+
+	/** Adds a swarm drone at the location. */
+	void SpawnDrone(const FVector& Location, int32 Hitpoints);
+
+	/**
+	 * Simulates the swarm, fires the shots of the swarm drones in range of a player and promotes swarm drones near the players.
+	 * Called every tick by the game mode. Maze may be nullptr.
+	 */
+	void UpdateSwarm(float DeltaSeconds, const TArray<struct FDroneSightTarget>& Players, const class AUnrealSFASMaze* Maze, FHitscanService& HitscanService, const FDroneRegistry& Registry);
+
+	/**
+	 * Promotes the first swarm drone the segment from Start to End hits before MaxDistance along it.
+	 * Returns the promoted drone character, or nullptr if no swarm drone was hit.
+	 */
+	class ADroneCharacter* PromoteHitDrone(const FVector& Start, const FVector& End, float MaxDistance);
+
+	/** Returns the number of drones in the swarm. */
+	FORCEINLINE int32 GetNumDrones() const { return Simulation.Num(); }
+
+	/** Returns the simulation of the swarm drones, for systems that read their state in bulk. */
+	FORCEINLINE const FDroneSwarmSimulation& GetSimulation() const { return Simulation; }
+
+private:
+	/** Replaces the swarm drone at the index with a drone character. Returns the drone character, or nullptr if it failed to spawn. */
+	class ADroneCharacter* Promote(int32 Index);
+
+	/** Removes the swarm drone at the index and its mesh instance. */
+	void RemoveDrone(int32 Index);
+
+	/** Queues a hitscan shot for every swarm drone the last simulation tick picked a target for. */
+	void FireShots(const TArray<struct FDroneSightTarget>& Players, FHitscanService& HitscanService, const FDroneRegistry& Registry);
+
+private:
+	FDroneSwarmSimulation Simulation;
+
+	/** Scratch storage of the swarm drones to promote this tick, and of each candidate's squared distance to the nearest player. */
+	TArray<int32> PromotionCandidates;
+	TArray<TPair<float, int32>> PromotionCandidateDistances;
+
+	/** Scratch storage of the players' locations and the shots fired this tick. */
+	TArray<FVector> PlayerLocations;
+	TArray<FHitscanShot> Shots;
+
+	/** The drone character class swarm drones are promoted to. */
+	UPROPERTY()
+	TSubclassOf<class ADroneCharacter> DroneClass;
+
+	///////////////////////////////////////////////
+	/** Swarm category */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm, meta = (AllowPrivateAccess = "true"))
+	FDroneSwarmSettings Settings;
+
+	/** Swarm drones closer than this to a player are promoted to drone characters. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm, meta = (AllowPrivateAccess = "true"))
+	float PromotionRadius;
+
+	/** The most swarm drones promoted for being near a player in a single tick. Spreads the cost of spawning across frames. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm, meta = (AllowPrivateAccess = "true"))
+	int32 MaxPromotionsPerTick;
+	///////////////////////////////////////////////
+};
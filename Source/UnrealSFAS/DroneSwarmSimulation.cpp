@@ -0,0 +1,417 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneSwarmSimulation.h"
+#include "UnrealSFAS.h"
+#include "UnrealSFASMaze.h"
+#include "DroneHitProxies.h"
+#include "DroneArchetype.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Swarm simulation"), STAT_DroneSwarmSimulation, STATGROUP_SFASDrones);
+
+namespace DroneSwarmSimulation
+{
+	/** The number of drones each parallel task processes. */
+	constexpr int32 ChunkSize = 256;
+
+	/** Wandering drones pick a new destination once they are this close to their current one. */
+	constexpr float GoalReachedDistance = 100.f;
+}
+
+FDroneSwarmSettings::FDroneSwarmSettings()
+{
+	// Set default member values.
+	MaxSpeed = 600.f;
+	Acceleration = 1200.f;
+	ChaseRadius = 2500.f;
+	WanderRadius = 800.f;
+	ThinkInterval = 0.5f;
+	HitRadius = 50.f;
+	ShotInterval = 1.f;
+}
+
+FDroneSwarmSimulation::FDroneSwarmSimulation()
+{
+	// Set default member values.
+	NumAdded = 0;
+}
+
+int32 FDroneSwarmSimulation::Add(const FVector& Location, int32 InHitpoints, const FDroneSwarmSettings& Settings)
+{
+	const FVector3f location(Location);
+
+	PositionX.Add(location.X);
+	PositionY.Add(location.Y);
+	PositionZ.Add(location.Z);
+	VelocityX.Add(0.f);
+	VelocityY.Add(0.f);
+	VelocityZ.Add(0.f);
+	Yaw.Add(0.f);
+	State.Add(EDroneSwarmState::Wander);
+	GoalX.Add(location.X);
+	GoalY.Add(location.Y);
+	ChaseTargets.Add(INDEX_NONE);
+	HomeLocations.Add(FVector2f(location.X, location.Y));
+	InstanceTransforms.Add(FTransform(Location));
+
+	// Spread the drones' decisions and shots evenly across their intervals rather than making them all on the same frame.
+	const float stagger = static_cast<float>(NumAdded % 16) / 16.f;
+	ThinkTimers.Add(stagger * Settings.ThinkInterval);
+	ShotTimers.Add(stagger * Settings.ShotInterval);
+	ShotTargets.Add(INDEX_NONE);
+
+	// Xorshift streams must not start at zero.
+	RandomStates.Add((NumAdded * 2654435761u) | 1u);
+	NumAdded++;
+
+	return Hitpoints.Add(InHitpoints);
+}
+
+void FDroneSwarmSimulation::RemoveAtSwap(int32 Index)
+{
+	PositionX.RemoveAtSwap(Index, 1, false);
+	PositionY.RemoveAtSwap(Index, 1, false);
+	PositionZ.RemoveAtSwap(Index, 1, false);
+	VelocityX.RemoveAtSwap(Index, 1, false);
+	VelocityY.RemoveAtSwap(Index, 1, false);
+	VelocityZ.RemoveAtSwap(Index, 1, false);
+	Yaw.RemoveAtSwap(Index, 1, false);
+	Hitpoints.RemoveAtSwap(Index, 1, false);
+	State.RemoveAtSwap(Index, 1, false);
+	ThinkTimers.RemoveAtSwap(Index, 1, false);
+	GoalX.RemoveAtSwap(Index, 1, false);
+	GoalY.RemoveAtSwap(Index, 1, false);
+	ChaseTargets.RemoveAtSwap(Index, 1, false);
+	HomeLocations.RemoveAtSwap(Index, 1, false);
+	RandomStates.RemoveAtSwap(Index, 1, false);
+	ShotTimers.RemoveAtSwap(Index, 1, false);
+	ShotTargets.RemoveAtSwap(Index, 1, false);
+	InstanceTransforms.RemoveAtSwap(Index, 1, false);
+}
+
+void FDroneSwarmSimulation::Reset()
+{
+	PositionX.Reset();
+	PositionY.Reset();
+	PositionZ.Reset();
+	VelocityX.Reset();
+	VelocityY.Reset();
+	VelocityZ.Reset();
+	Yaw.Reset();
+	Hitpoints.Reset();
+	State.Reset();
+	ThinkTimers.Reset();
+	GoalX.Reset();
+	GoalY.Reset();
+	ChaseTargets.Reset();
+	HomeLocations.Reset();
+	RandomStates.Reset();
+	ShotTimers.Reset();
+	ShotTargets.Reset();
+	InstanceTransforms.Reset();
+	NumAdded = 0;
+}
+
+void FDroneSwarmSimulation::Tick(float DeltaSeconds, const TArray<FVector>& PlayerLocations, const AUnrealSFASMaze* Maze, float MaxShotDistance, const FDroneSwarmSettings& Settings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneSwarmSimulation);
+
+	Players.Reset();
+	for (const auto& playerLocation : PlayerLocations)
+	{
+		Players.Add(FVector3f(playerLocation));
+	}
+
+	// Every processor only reads and writes the entries of its own drones, so each chunk runs all of them back to back.
+	const int32 count = Num();
+	const int32 numChunks = FMath::DivideAndRoundUp(count, DroneSwarmSimulation::ChunkSize);
+	// The maze is only read, so every chunk can test against it at once.
+	ParallelFor(numChunks, [this, count, DeltaSeconds, Maze, MaxShotDistance, &Settings](int32 ChunkIndex)
+		{
+			const int32 begin = ChunkIndex * DroneSwarmSimulation::ChunkSize;
+			const int32 end = FMath::Min(begin + DroneSwarmSimulation::ChunkSize, count);
+
+			ThinkProcessor(begin, end, DeltaSeconds, Settings);
+			MovementProcessor(begin, end, DeltaSeconds, Maze, Settings);
+			FireProcessor(begin, end, DeltaSeconds, MaxShotDistance, Settings);
+			TransformProcessor(begin, end);
+		}, numChunks <= 1);
+}
+
+void FDroneSwarmSimulation::ThinkProcessor(int32 Begin, int32 End, float DeltaSeconds, const FDroneSwarmSettings& Settings)
+{
+	const float chaseRadiusSquared = FMath::Square(Settings.ChaseRadius);
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		ThinkTimers[i] -= DeltaSeconds;
+		if (ThinkTimers[i] > 0.f)
+		{
+			continue;
+		}
+		ThinkTimers[i] += Settings.ThinkInterval;
+
+		// Chase the nearest player in range.
+		int32 nearestPlayer = INDEX_NONE;
+		float nearestDistanceSquared = chaseRadiusSquared;
+		for (int32 p = 0; p < Players.Num(); p++)
+		{
+			const float distanceSquared = FMath::Square(Players[p].X - PositionX[i]) + FMath::Square(Players[p].Y - PositionY[i]);
+			if (distanceSquared <= nearestDistanceSquared)
+			{
+				nearestDistanceSquared = distanceSquared;
+				nearestPlayer = p;
+			}
+		}
+
+		if (nearestPlayer != INDEX_NONE)
+		{
+			State[i] = EDroneSwarmState::Chase;
+			ChaseTargets[i] = static_cast<int8>(nearestPlayer);
+			continue;
+		}
+
+		// Otherwise wander, picking a new destination around the spawn location when the last one was reached.
+		const bool reachedGoal = (FMath::Square(GoalX[i] - PositionX[i]) + FMath::Square(GoalY[i] - PositionY[i])) <= FMath::Square(DroneSwarmSimulation::GoalReachedDistance);
+		if ((State[i] != EDroneSwarmState::Wander) || reachedGoal)
+		{
+			const float angle = NextRandom(i) * 2.f * PI;
+			const float distance = NextRandom(i) * Settings.WanderRadius;
+			GoalX[i] = HomeLocations[i].X + (FMath::Cos(angle) * distance);
+			GoalY[i] = HomeLocations[i].Y + (FMath::Sin(angle) * distance);
+		}
+
+		State[i] = EDroneSwarmState::Wander;
+		ChaseTargets[i] = INDEX_NONE;
+	}
+}
+
+void FDroneSwarmSimulation::MovementProcessor(int32 Begin, int32 End, float DeltaSeconds, const AUnrealSFASMaze* Maze, const FDroneSwarmSettings& Settings)
+{
+	const float maxVelocityChange = Settings.Acceleration * DeltaSeconds;
+	const float mazeHalfExtent = AUnrealSFASMaze::MazeSize * AUnrealSFASMaze::BlockSize * 0.5f;
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		// Chasing drones head straight for their player.
+		if ((State[i] == EDroneSwarmState::Chase) && Players.IsValidIndex(ChaseTargets[i]))
+		{
+			GoalX[i] = Players[ChaseTargets[i]].X;
+			GoalY[i] = Players[ChaseTargets[i]].Y;
+		}
+
+		// Steer towards the destination, slowing down on arrival.
+		const float toGoalX = GoalX[i] - PositionX[i];
+		const float toGoalY = GoalY[i] - PositionY[i];
+		const float distanceToGoal = FMath::Sqrt(FMath::Square(toGoalX) + FMath::Square(toGoalY));
+		const float desiredSpeed = FMath::Min(Settings.MaxSpeed, distanceToGoal * 2.f);
+		const float scale = (distanceToGoal > KINDA_SMALL_NUMBER) ? (desiredSpeed / distanceToGoal) : 0.f;
+
+		float velocityChangeX = (toGoalX * scale) - VelocityX[i];
+		float velocityChangeY = (toGoalY * scale) - VelocityY[i];
+		const float velocityChangeSquared = FMath::Square(velocityChangeX) + FMath::Square(velocityChangeY);
+		if (velocityChangeSquared > FMath::Square(maxVelocityChange))
+		{
+			const float clampScale = maxVelocityChange * FMath::InvSqrt(velocityChangeSquared);
+			velocityChangeX *= clampScale;
+			velocityChangeY *= clampScale;
+		}
+
+		VelocityX[i] += velocityChangeX;
+		VelocityY[i] += velocityChangeY;
+		VelocityZ[i] = 0.f;
+
+		float deltaX = VelocityX[i] * DeltaSeconds;
+		float deltaY = VelocityY[i] * DeltaSeconds;
+
+		// Stop movement along each axis that would take the drone's hit sphere into a maze wall taller than the bottom of the drone.
+		if (Maze)
+		{
+			const float bottom = PositionZ[i] - Settings.HitRadius;
+
+			if (deltaX != 0.f)
+			{
+				const FVector probe(PositionX[i] + deltaX + (FMath::Sign(deltaX) * Settings.HitRadius), PositionY[i], PositionZ[i]);
+				if (Maze->GetWallTopHeight(AUnrealSFASMaze::WorldToCell(probe)) > bottom)
+				{
+					deltaX = 0.f;
+					VelocityX[i] = 0.f;
+				}
+			}
+
+			if (deltaY != 0.f)
+			{
+				const FVector probe(PositionX[i] + deltaX, PositionY[i] + deltaY + (FMath::Sign(deltaY) * Settings.HitRadius), PositionZ[i]);
+				if (Maze->GetWallTopHeight(AUnrealSFASMaze::WorldToCell(probe)) > bottom)
+				{
+					deltaY = 0.f;
+					VelocityY[i] = 0.f;
+				}
+			}
+		}
+
+		// Integrate and keep the drone inside of the maze bounds.
+		PositionX[i] += deltaX;
+		PositionY[i] += deltaY;
+
+		if (FMath::Abs(PositionX[i]) > mazeHalfExtent)
+		{
+			PositionX[i] = FMath::Clamp(PositionX[i], -mazeHalfExtent, mazeHalfExtent);
+			VelocityX[i] = 0.f;
+		}
+
+		if (FMath::Abs(PositionY[i]) > mazeHalfExtent)
+		{
+			PositionY[i] = FMath::Clamp(PositionY[i], -mazeHalfExtent, mazeHalfExtent);
+			VelocityY[i] = 0.f;
+		}
+
+		// Face the direction of travel.
+		if ((FMath::Square(VelocityX[i]) + FMath::Square(VelocityY[i])) > 1.f)
+		{
+			Yaw[i] = FMath::RadiansToDegrees(FMath::Atan2(VelocityY[i], VelocityX[i]));
+		}
+	}
+}
+
+void FDroneSwarmSimulation::FireProcessor(int32 Begin, int32 End, float DeltaSeconds, float MaxShotDistance, const FDroneSwarmSettings& Settings)
+{
+	const float maxShotDistanceSquared = FMath::Square(MaxShotDistance);
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		ShotTargets[i] = INDEX_NONE;
+
+		// The shot timer holds at zero until the drone has a player to shoot at, so it fires as soon as one is in range.
+		ShotTimers[i] = FMath::Max(ShotTimers[i] - DeltaSeconds, 0.f);
+		if ((ShotTimers[i] > 0.f) || (State[i] != EDroneSwarmState::Chase) || !Players.IsValidIndex(ChaseTargets[i]))
+		{
+			continue;
+		}
+
+		const FVector3f& player = Players[ChaseTargets[i]];
+		const float distanceSquared = FMath::Square(player.X - PositionX[i]) + FMath::Square(player.Y - PositionY[i]) + FMath::Square(player.Z - PositionZ[i]);
+		if (distanceSquared <= maxShotDistanceSquared)
+		{
+			ShotTargets[i] = ChaseTargets[i];
+			ShotTimers[i] = Settings.ShotInterval;
+		}
+	}
+}
+
+void FDroneSwarmSimulation::TransformProcessor(int32 Begin, int32 End)
+{
+	for (int32 i = Begin; i < End; i++)
+	{
+		InstanceTransforms[i].SetComponents(FRotator(0.f, Yaw[i], 0.f).Quaternion(), FVector(PositionX[i], PositionY[i], PositionZ[i]), FVector::OneVector);
+	}
+}
+
+void FDroneSwarmSimulation::GatherInRadius(const TArray<FVector>& Locations, float Radius, TArray<int32>& OutIndices) const
+{
+	const float radiusSquared = FMath::Square(Radius);
+
+	for (int32 i = 0; i < Num(); i++)
+	{
+		const FVector3f position(PositionX[i], PositionY[i], PositionZ[i]);
+		for (const auto& location : Locations)
+		{
+			if (FVector3f::DistSquared(position, FVector3f(location)) <= radiusSquared)
+			{
+				OutIndices.Add(i);
+				break;
+			}
+		}
+	}
+}
+
+int32 FDroneSwarmSimulation::Raycast(const FVector& Start, const FVector& End, float HitRadius, float& OutDistance) const
+{
+	FDroneHitProxyView proxies;
+	proxies.CenterX = PositionX.GetData();
+	proxies.CenterY = PositionY.GetData();
+	proxies.CenterZ = PositionZ.GetData();
+	proxies.UniformRadiusSquared = FMath::Square(HitRadius);
+	proxies.Num = Num();
+
+	return FDroneHitProxies::Raycast(proxies, Start, End, BIG_NUMBER, INDEX_NONE, OutDistance);
+}
+
+float FDroneSwarmSimulation::NextRandom(int32 Index)
+{
+	uint32 state = RandomStates[Index];
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	RandomStates[Index] = state;
+
+	return static_cast<float>(state & 0xFFFFFF) / static_cast<float>(0x1000000);
+}
+
+namespace DroneSwarmSimulation
+{
+	/** Returns the average milliseconds per tick of a swarm of Count drones chasing and wandering around four players. */
+	static double MeasureTickMilliseconds(int32 Count, int32 NumFrames)
+	{
+		const float mazeHalfExtent = AUnrealSFASMaze::MazeSize * AUnrealSFASMaze::BlockSize * 0.5f;
+		const float deltaSeconds = 1.f / 60.f;
+		const FDroneSwarmSettings settings;
+		const float maxShotDistance = GetDefault<UDroneArchetype>()->GetMaxShotDistance();
+		FRandomStream randomStream(Count);
+
+		FDroneSwarmSimulation simulation;
+		for (int32 i = 0; i < Count; i++)
+		{
+			simulation.Add(FVector(randomStream.FRandRange(-mazeHalfExtent, mazeHalfExtent), randomStream.FRandRange(-mazeHalfExtent, mazeHalfExtent), 150.f), 100, settings);
+		}
+
+		TArray<FVector> playerLocations;
+		playerLocations.Add(FVector(-1000.f, -1000.f, 100.f));
+		playerLocations.Add(FVector(1000.f, -1000.f, 100.f));
+		playerLocations.Add(FVector(-1000.f, 1000.f, 100.f));
+		playerLocations.Add(FVector(1000.f, 1000.f, 100.f));
+
+		// Warm up so the think timers and caches settle before timing.
+		for (int32 frame = 0; frame < 10; frame++)
+		{
+			simulation.Tick(deltaSeconds, playerLocations, nullptr, maxShotDistance, settings);
+		}
+
+		const double startSeconds = FPlatformTime::Seconds();
+		for (int32 frame = 0; frame < NumFrames; frame++)
+		{
+			simulation.Tick(deltaSeconds, playerLocations, nullptr, maxShotDistance, settings);
+		}
+
+		return ((FPlatformTime::Seconds() - startSeconds) * 1000.0) / NumFrames;
+	}
+
+	/** Doubles the swarm size until a tick no longer fits in the 60 Hz frame budget and logs the timings. */
+	static void RunBenchmark(const TArray<FString>& Args)
+	{
+		const int32 numFrames = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 120;
+		const double frameBudgetMilliseconds = 1000.0 / 60.0;
+
+		int32 sustainedCount = 0;
+		for (int32 count = 1024; count <= (1 << 20); count *= 2)
+		{
+			const double milliseconds = MeasureTickMilliseconds(count, numFrames);
+			UE_LOG(LogUnrealSFAS, Display, TEXT("Drone swarm benchmark: %d drones, %.3f ms per tick"), count, milliseconds);
+
+			if (milliseconds > frameBudgetMilliseconds)
+			{
+				break;
+			}
+			sustainedCount = count;
+		}
+
+		UE_LOG(LogUnrealSFAS, Display, TEXT("Drone swarm benchmark: %d drones sustain 60 Hz"), sustainedCount);
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("SFAS.DroneSwarm.Benchmark"),
+		TEXT("Measures how many swarm drones can be simulated within a 60 Hz frame. Optional argument: number of frames to time per swarm size."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+}
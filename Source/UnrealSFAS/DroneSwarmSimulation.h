@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneSwarmSimulation.generated.h"
+
+/** How swarm drones move and react to the players. */
+USTRUCT(BlueprintType)
+struct FDroneSwarmSettings
+{
+	GENERATED_BODY()
+
+	FDroneSwarmSettings();
+
+	/** The fastest a swarm drone can fly. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm)
+	float MaxSpeed;
+
+	/** How quickly a swarm drone can change its velocity. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm)
+	float Acceleration;
+
+	/** Swarm drones closer than this to a player chase them. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm)
+	float ChaseRadius;
+
+	/** The furthest from its spawn location a wandering swarm drone picks its next destination. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm)
+	float WanderRadius;
+
+	/** Seconds between each swarm drone's decisions. Decisions are spread evenly across the interval. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm)
+	float ThinkInterval;
+
+	/** The radius of the sphere used to test whether a shot hits a swarm drone. Also keeps swarm drones clear of the maze walls. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm)
+	float HitRadius;
+
+	/** Seconds between the shots of a swarm drone chasing a player in range. Shots are spread evenly across the interval. */
+	UPROPERTY(EditDefaultsOnly, Category = Swarm)
+	float ShotInterval;
+};
+
+/** What a swarm drone is currently doing. */
+enum class EDroneSwarmState : uint8
+{
+	/** Flying between random points around its spawn location. */
+	Wander,
+
+	/** Flying towards a player. */
+	Chase,
+};
+
+/**
+ * Lightweight drone simulation with no actors or components. Each drone is a set of entries in contiguous arrays, and
+ * the per frame work is split into processors that run over chunks of drones in parallel:
+ *  - Think: staggered decisions on whether to chase a player or wander.
+ *  - Movement: steering and integration of the velocity and location, stopping at the maze walls.
+ *  - Fire: picks the chased player each drone shoots at this tick, if its shot is due and the player is in range.
+ *  - Transform: builds the instance transforms used to render the drones.
+ *
+ * Entity indices are dense and change when a drone is removed, as the last drone is swapped into the removed drone's place.
+ */
+class UNREALSFAS_API FDroneSwarmSimulation
+{
+public:
+	FDroneSwarmSimulation();
+
+	/** Adds a drone at the location and returns its index. Its first decision and shot are staggered across the settings' intervals. */
+	int32 Add(const FVector& Location, int32 Hitpoints, const FDroneSwarmSettings& Settings);
+
+	/** Removes the drone at the index. The last drone takes its index. */
+	void RemoveAtSwap(int32 Index);
+
+	/** Removes every drone. */
+	void Reset();
+
+	/**
+	 * Runs every processor over every drone. PlayerLocations are the locations of the players still in the game. Maze may be nullptr,
+	 * in which case the drones are only kept inside of the maze bounds. Drones only shoot at players within MaxShotDistance.
+	 */
+	void Tick(float DeltaSeconds, const TArray<FVector>& PlayerLocations, const class AUnrealSFASMaze* Maze, float MaxShotDistance, const FDroneSwarmSettings& Settings);
+
+	/** Appends the index of every drone within Radius of any of the locations to OutIndices, in ascending order. */
+	void GatherInRadius(const TArray<FVector>& Locations, float Radius, TArray<int32>& OutIndices) const;
+
+	/**
+	 * Returns the index of the first drone whose hit sphere the segment from Start to End passes through, or INDEX_NONE.
+	 * OutDistance is set to the distance along the segment to the hit sphere.
+	 */
+	int32 Raycast(const FVector& Start, const FVector& End, float HitRadius, float& OutDistance) const;
+
+	FORCEINLINE int32 Num() const { return Hitpoints.Num(); }
+	FORCEINLINE FVector GetLocation(int32 Index) const { return FVector(PositionX[Index], PositionY[Index], PositionZ[Index]); }
+	FORCEINLINE float GetYaw(int32 Index) const { return Yaw[Index]; }
+	FORCEINLINE int32 GetHitpoints(int32 Index) const { return Hitpoints[Index]; }
+
+	/** Returns the index into the last Tick's PlayerLocations of the player the drone shoots at this tick, or INDEX_NONE. */
+	FORCEINLINE int32 GetShotTarget(int32 Index) const { return ShotTargets[Index]; }
+
+	/** Returns the render transform of each drone, in entity index order. Built by the last Tick. */
+	FORCEINLINE const TArray<FTransform>& GetInstanceTransforms() const { return InstanceTransforms; }
+
+private:
+	/** Decides whether each drone in [Begin, End) chases a player or wanders. */
+	void ThinkProcessor(int32 Begin, int32 End, float DeltaSeconds, const FDroneSwarmSettings& Settings);
+
+	/** Steers each drone in [Begin, End) towards its destination and integrates its movement. */
+	void MovementProcessor(int32 Begin, int32 End, float DeltaSeconds, const class AUnrealSFASMaze* Maze, const FDroneSwarmSettings& Settings);
+
+	/** Picks the player each chasing drone in [Begin, End) shoots at, if its shot is due. */
+	void FireProcessor(int32 Begin, int32 End, float DeltaSeconds, float MaxShotDistance, const FDroneSwarmSettings& Settings);
+
+	/** Writes the render transform of each drone in [Begin, End). */
+	void TransformProcessor(int32 Begin, int32 End);
+
+	/** Returns the next value of a drone's random stream. Each drone owns its own stream so processors can run in parallel. */
+	float NextRandom(int32 Index);
+
+private:
+	/** Transform and velocity. Components are stored in separate arrays to keep the processors' memory access linear. */
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> Yaw;
+
+	/** Health. */
+	TArray<int32> Hitpoints;
+
+	/** AI state. */
+	TArray<EDroneSwarmState> State;
+	TArray<float> ThinkTimers;
+	TArray<float> GoalX;
+	TArray<float> GoalY;
+	TArray<int8> ChaseTargets;
+	TArray<FVector2f> HomeLocations;
+	TArray<uint32> RandomStates;
+
+	/** Weapons. */
+	TArray<float> ShotTimers;
+	TArray<int8> ShotTargets;
+
+	/** Render transforms built by the transform processor. */
+	TArray<FTransform> InstanceTransforms;
+
+	/** Locations of the players for the current tick, in single precision. */
+	TArray<FVector3f> Players;
+
+	/** The number of drones added since the last reset. Used to seed the random streams and spread the think and shot timers. */
+	uint32 NumAdded;
+};
@@ -0,0 +1,245 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DroneVisibilityService.h"
+#include "UnrealSFAS.h"
+#include "DroneCharacter.h"
+#include "EnemyDroneAIController.h"
+#include "GameCollisionDefinitions.h"
+
+DECLARE_CYCLE_STAT(TEXT("Sight queries"), STAT_DroneSightQueries, STATGROUP_SFASDrones);
+DECLARE_CYCLE_STAT(TEXT("Sight results"), STAT_DroneSightResults, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sight occlusion traces"), STAT_DroneSightTraces, STATGROUP_SFASDrones);
+
+FDroneSightSettings::FDroneSightSettings()
+{
+	// Set default member values.
+	UpdateInterval = 0.2f;
+	SightRadius = 2000.f;
+	LoseSightRadius = 3000.f;
+	PeripheralVisionAngleDegrees = 75.f;
+}
+
+FDroneVisibilityService::FDroneVisibilityService()
+{
+	// Set default member values.
+	TimeUntilUpdate = 0.f;
+	ResultsPending = false;
+}
+
+void FDroneVisibilityService::Tick(float DeltaSeconds, UWorld* World, FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Targets, const FDroneSightSettings& Settings)
+{
+	// Asynchronous traces issued last frame have completed by now.
+	if (ResultsPending)
+	{
+		ApplyResults(World, Registry);
+	}
+
+	TimeUntilUpdate -= DeltaSeconds;
+	if (TimeUntilUpdate <= 0.f)
+	{
+		TimeUntilUpdate = Settings.UpdateInterval;
+		IssueQueries(World, Registry, Targets, Settings);
+	}
+}
+
+void FDroneVisibilityService::IssueQueries(UWorld* World, const FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Targets, const FDroneSightSettings& Settings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneSightQueries);
+
+	PendingTargets = Targets;
+	PendingDrones = Registry.GetHandles();
+	PendingTraces.Reset();
+	ResultsPending = true;
+
+	// Pack the drone data into float arrays padded to a whole number of vectors.
+	// Padding drones are placed far outside of any sight radius so they always fail the range test.
+	const int32 count = Registry.Num();
+	const int32 paddedCount = Align(count, 4);
+	const TArray<FVector>& positions = Registry.GetPositions();
+	const TArray<FVector3f>& forwards = Registry.GetForwards();
+	const TArray<int8>& sightTargets = Registry.GetSightTargets();
+
+	PositionX.SetNumUninitialized(paddedCount, false);
+	PositionY.SetNumUninitialized(paddedCount, false);
+	PositionZ.SetNumUninitialized(paddedCount, false);
+	ForwardX.SetNumUninitialized(paddedCount, false);
+	ForwardY.SetNumUninitialized(paddedCount, false);
+	ForwardZ.SetNumUninitialized(paddedCount, false);
+	CurrentTarget.SetNumUninitialized(paddedCount, false);
+
+	for (int32 i = 0; i < paddedCount; i++)
+	{
+		const bool padding = (i >= count);
+		PositionX[i] = padding ? WORLD_MAX : positions[i].X;
+		PositionY[i] = padding ? WORLD_MAX : positions[i].Y;
+		PositionZ[i] = padding ? WORLD_MAX : positions[i].Z;
+		ForwardX[i] = padding ? 0.f : forwards[i].X;
+		ForwardY[i] = padding ? 0.f : forwards[i].Y;
+		ForwardZ[i] = padding ? 0.f : forwards[i].Z;
+		CurrentTarget[i] = padding ? static_cast<float>(INDEX_NONE) : static_cast<float>(sightTargets[i]);
+	}
+
+	const float cosHalfAngle = FMath::Cos(FMath::DegreesToRadians(Settings.PeripheralVisionAngleDegrees));
+	const VectorRegister4Float zero = VectorZeroFloat();
+	const VectorRegister4Float cosHalfAngleSquared = VectorSetFloat1(cosHalfAngle * cosHalfAngle);
+	const VectorRegister4Float sightRadiusSquared = VectorSetFloat1(FMath::Square(Settings.SightRadius));
+	const VectorRegister4Float loseSightRadiusSquared = VectorSetFloat1(FMath::Square(Settings.LoseSightRadius));
+
+	for (int32 targetIndex = 0; targetIndex < Targets.Num(); targetIndex++)
+	{
+		const FDroneSightTarget& target = Targets[targetIndex];
+		const VectorRegister4Float targetX = VectorSetFloat1(target.Location.X);
+		const VectorRegister4Float targetY = VectorSetFloat1(target.Location.Y);
+		const VectorRegister4Float targetZ = VectorSetFloat1(target.Location.Z);
+		const VectorRegister4Float targetPlayerIndex = VectorSetFloat1(static_cast<float>(target.PlayerIndex));
+
+		for (int32 i = 0; i < paddedCount; i += 4)
+		{
+			const VectorRegister4Float dx = VectorSubtract(targetX, VectorLoad(PositionX.GetData() + i));
+			const VectorRegister4Float dy = VectorSubtract(targetY, VectorLoad(PositionY.GetData() + i));
+			const VectorRegister4Float dz = VectorSubtract(targetZ, VectorLoad(PositionZ.GetData() + i));
+			const VectorRegister4Float distanceSquared = VectorMultiplyAdd(dz, dz, VectorMultiplyAdd(dy, dy, VectorMultiply(dx, dx)));
+
+			// Drones that can already see this player keep seeing them out to the lose sight radius.
+			const VectorRegister4Float alreadySeen = VectorCompareEQ(VectorLoad(CurrentTarget.GetData() + i), targetPlayerIndex);
+			const VectorRegister4Float radiusSquared = VectorSelect(alreadySeen, loseSightRadiusSquared, sightRadiusSquared);
+			const VectorRegister4Float inRange = VectorCompareLE(distanceSquared, radiusSquared);
+
+			// The player is inside the view cone when the angle between the drone's forward vector and the direction to the player
+			// is small enough: dot > 0 and dot^2 >= cos^2 * distance^2, which avoids normalising the direction.
+			const VectorRegister4Float dot = VectorMultiplyAdd(VectorLoad(ForwardZ.GetData() + i), dz,
+				VectorMultiplyAdd(VectorLoad(ForwardY.GetData() + i), dy, VectorMultiply(VectorLoad(ForwardX.GetData() + i), dx)));
+			const VectorRegister4Float inFront = VectorCompareGT(dot, zero);
+			const VectorRegister4Float inCone = VectorCompareGE(VectorMultiply(dot, dot), VectorMultiply(cosHalfAngleSquared, distanceSquared));
+
+			int32 passed = VectorMaskBits(VectorBitwiseAnd(inRange, VectorBitwiseAnd(inFront, inCone)));
+
+			// Send an occlusion trace for each drone that passed.
+			while (passed != 0)
+			{
+				const int32 lane = FMath::CountTrailingZeros(passed);
+				passed &= passed - 1;
+
+				const int32 droneIndex = i + lane;
+				auto* drone = Registry.GetActor(droneIndex);
+				const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(DroneSight), false, drone);
+
+				FPendingSightTrace pendingTrace;
+				pendingTrace.Drone = Registry.GetHandles()[droneIndex];
+				pendingTrace.TargetIndex = targetIndex;
+				pendingTrace.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, positions[droneIndex], target.Location, COLLISION_SIGHT, queryParams);
+				PendingTraces.Add(pendingTrace);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_DroneSightTraces, PendingTraces.Num());
+}
+
+void FDroneVisibilityService::ApplyResults(UWorld* World, FDroneRegistry& Registry)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneSightResults);
+
+	ResultsPending = false;
+
+	// Clear the last batch's results. SetNumZeroed alone only zeroes the entries it adds, which would leave stale bits at reused dense indices.
+	const int32 count = Registry.Num();
+	VisibleTargetMasks.Reset();
+	VisibleTargetMasks.SetNumZeroed(count, false);
+	Tested.Reset();
+	Tested.SetNumZeroed(count, false);
+
+	// Mark the drones that were tested. Drones spawned since the batch was issued keep their current state.
+	for (const auto& handle : PendingDrones)
+	{
+		const int32 denseIndex = Registry.GetDenseIndex(handle);
+		if (denseIndex != INDEX_NONE)
+		{
+			Tested[denseIndex] = true;
+		}
+	}
+
+	// Record which players each drone has an unobstructed line of sight to.
+	const TArray<int8>& sightTargets = Registry.GetSightTargets();
+	for (const auto& pendingTrace : PendingTraces)
+	{
+		const int32 denseIndex = Registry.GetDenseIndex(pendingTrace.Drone);
+		if (denseIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FDroneSightTarget& target = PendingTargets[pendingTrace.TargetIndex];
+
+		bool visible = false;
+		FTraceDatum traceDatum;
+		if (World->QueryTraceData(pendingTrace.Handle, traceDatum))
+		{
+			// The line of sight is clear if nothing was hit or the first thing hit was the player.
+			visible = (traceDatum.OutHits.Num() == 0) || !traceDatum.OutHits[0].bBlockingHit || (traceDatum.OutHits[0].GetActor() == target.Actor);
+		}
+		else
+		{
+			// The trace result was lost. Keep seeing a player the drone could already see rather than flickering.
+			visible = (sightTargets[denseIndex] == target.PlayerIndex);
+		}
+
+		if (visible)
+		{
+			VisibleTargetMasks[denseIndex] |= (1u << pendingTrace.TargetIndex);
+		}
+	}
+
+	// Pick a sight target for each tested drone and tell its controller if it changed.
+	const TArray<FVector>& positions = Registry.GetPositions();
+	for (int32 i = 0; i < count; i++)
+	{
+		if (!Tested[i])
+		{
+			continue;
+		}
+
+		const int32 currentPlayerIndex = sightTargets[i];
+		int32 newTargetIndex = INDEX_NONE;
+		double nearestDistanceSquared = TNumericLimits<double>::Max();
+
+		for (int32 targetIndex = 0; targetIndex < PendingTargets.Num(); targetIndex++)
+		{
+			if ((VisibleTargetMasks[i] & (1u << targetIndex)) == 0)
+			{
+				continue;
+			}
+
+			// Keep tracking the current target while it stays in sight.
+			if (PendingTargets[targetIndex].PlayerIndex == currentPlayerIndex)
+			{
+				newTargetIndex = targetIndex;
+				break;
+			}
+
+			// Otherwise prefer the nearest visible player.
+			const double distanceSquared = FVector::DistSquared(positions[i], PendingTargets[targetIndex].Location);
+			if (distanceSquared < nearestDistanceSquared)
+			{
+				nearestDistanceSquared = distanceSquared;
+				newTargetIndex = targetIndex;
+			}
+		}
+
+		const int32 newPlayerIndex = (newTargetIndex != INDEX_NONE) ? PendingTargets[newTargetIndex].PlayerIndex : INDEX_NONE;
+		if (newPlayerIndex != currentPlayerIndex)
+		{
+			Registry.SetSightTarget(i, newPlayerIndex);
+
+			auto* enemyDroneAIController = Cast<AEnemyDroneAIController>(Registry.GetActor(i)->GetController());
+			if (enemyDroneAIController)
+			{
+				enemyDroneAIController->SetSightTarget((newTargetIndex != INDEX_NONE) ? PendingTargets[newTargetIndex].Actor : nullptr);
+			}
+		}
+	}
+
+	PendingDrones.Reset();
+	PendingTraces.Reset();
+}
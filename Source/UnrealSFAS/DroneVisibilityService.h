@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+#include "DroneRegistry.h"
+#include "DroneVisibilityService.generated.h"
+
+/** How far and how wide drones can see. */
+USTRUCT(BlueprintType)
+struct FDroneSightSettings
+{
+	GENERATED_BODY()
+
+	FDroneSightSettings();
+
+	/** Seconds between sight updates. */
+	UPROPERTY(EditDefaultsOnly, Category = Sight)
+	float UpdateInterval;
+
+	/** The distance at which a drone can start seeing a player. */
+	UPROPERTY(EditDefaultsOnly, Category = Sight)
+	float SightRadius;
+
+	/** The distance at which a drone loses sight of a player it can already see. */
+	UPROPERTY(EditDefaultsOnly, Category = Sight)
+	float LoseSightRadius;
+
+	/** Half of the angle of the drone's view cone, in degrees. */
+	UPROPERTY(EditDefaultsOnly, Category = Sight, meta = (ClampMin = "0", ClampMax = "90"))
+	float PeripheralVisionAngleDegrees;
+};
+
+/** A player that drones can see. */
+struct FDroneSightTarget
+{
+	class AActor* Actor;
+	FVector Location;
+	int32 PlayerIndex;
+};
+
+/**
+ * Works out which player each drone can see, replacing a perception component per drone.
+ *
+ * Once per update window every drone is tested against every player: the distance and view cone tests run four drones at a
+ * time over packed positions, and the pairs that pass are sent as one batch of asynchronous occlusion traces. The trace results
+ * are applied on the following frame, and the drone's controller is only told when the player it can see changes.
+ */
+class UNREALSFAS_API FDroneVisibilityService
+{
+public:
+	FDroneVisibilityService();
+
+	/** Applies the results of the last batch of occlusion traces, and starts a new batch once per update window. */
+	void Tick(float DeltaSeconds, UWorld* World, FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Targets, const FDroneSightSettings& Settings);
+
+private:
+	/** Runs the range and cone tests and issues occlusion traces for the drone and player pairs that pass them. */
+	void IssueQueries(UWorld* World, const FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Targets, const FDroneSightSettings& Settings);
+
+	/** Reads the occlusion trace results and updates the sight target of each tested drone. */
+	void ApplyResults(UWorld* World, FDroneRegistry& Registry);
+
+private:
+	/** An occlusion trace between a drone and a player that is in flight. */
+	struct FPendingSightTrace
+	{
+		FTraceHandle Handle;
+		FDroneHandle Drone;
+		int32 TargetIndex;
+	};
+
+	/** Seconds until the next update window. */
+	float TimeUntilUpdate;
+
+	/** Whether a batch of traces has been issued and not yet applied. */
+	bool ResultsPending;
+
+	/** The players tested in the pending batch. */
+	TArray<FDroneSightTarget> PendingTargets;
+
+	/** Every drone tested in the pending batch. Drones not in a pending trace could not see any player. */
+	TArray<FDroneHandle> PendingDrones;
+
+	/** The occlusion traces of the pending batch. */
+	TArray<FPendingSightTrace> PendingTraces;
+
+	/** Scratch storage of the packed drone data, one float array per component so they can be loaded into vector registers. */
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+	TArray<float> ForwardX;
+	TArray<float> ForwardY;
+	TArray<float> ForwardZ;
+	TArray<float> CurrentTarget;
+
+	/** Scratch storage of which tested players each drone can see, as a bit per player. */
+	TArray<uint32> VisibleTargetMasks;
+	TArray<bool> Tested;
+};
@@ -2,32 +2,28 @@
 
 
 #include "EnemyDroneAIController.h"
-#include "Perception/AIPerceptionComponent.h"
-#include "Perception/AISenseConfig_Sight.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BrainComponent.h"
+#include "DroneBehaviorTreeComponent.h"
+#include "DroneCharacter.h"
 
 AEnemyDroneAIController::AEnemyDroneAIController()
 {
-	// Setup AI sight perception configuration
-	AiSightConfig = CreateDefaultSubobject<UAISenseConfig_Sight>(TEXT("AIConfigSight"));
-	AiSightConfig->PeripheralVisionAngleDegrees = 75.f;
-	AiSightConfig->SightRadius = 2000.f;
-	AiSightConfig->LoseSightRadius = 3000.f;
-	AiSightConfig->DetectionByAffiliation.bDetectEnemies = true;
-	AiSightConfig->DetectionByAffiliation.bDetectFriendlies = true;
-	AiSightConfig->DetectionByAffiliation.bDetectNeutrals = true;
-
-	// Setup AI perception component.
-	AiPerceptionComponent = CreateDefaultSubobject<UAIPerceptionComponent>(TEXT("AIPerceptionComponent"));
-	AiPerceptionComponent->ConfigureSense(*AiSightConfig);
-	AiPerceptionComponent->SetDominantSense(UAISenseConfig_Sight::StaticClass());
-	AiPerceptionComponent->OnTargetPerceptionUpdated.AddDynamic(this, &AEnemyDroneAIController::OnPerceptionUpdate);
+	// Use a behavior tree component that the game mode can tick at a fixed rate. RunBehaviorTree uses it instead of creating its own.
+	BrainComponent = CreateDefaultSubobject<UDroneBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
 
 	// Set default member values
 	BehaviorTreeAsset = nullptr;
-	MaxShotDistance = 1000.f;
-	MinShotDamage = 1;
-	MaxShotDamage = 5;
+	CanSeePlayerKey = FBlackboard::InvalidKey;
+	TargetKey = FBlackboard::InvalidKey;
+
+	// The deprecated shot tuning defaults to the archetype defaults.
+	const auto* defaultArchetype = GetDefault<UDroneArchetype>();
+	MaxShotDistance = defaultArchetype->GetMaxShotDistance();
+	MinShotDamage = defaultArchetype->GetMinShotDamage();
+	MaxShotDamage = defaultArchetype->GetMaxShotDamage();
 }
 
 void AEnemyDroneAIController::BeginPlay()
@@ -38,6 +34,14 @@ void AEnemyDroneAIController::BeginPlay()
 	if (BehaviorTreeAsset)
 	{
 		RunBehaviorTree(BehaviorTreeAsset);
+
+		// Resolve the blackboard keys once rather than looking them up by name on every write.
+		auto* blackboardComponent = GetBlackboardComponent();
+		if (blackboardComponent)
+		{
+			CanSeePlayerKey = blackboardComponent->GetKeyID(CanSeePlayerBlackboardValueName);
+			TargetKey = blackboardComponent->GetKeyID(TargetBlackboardValueName);
+		}
 	}
 }
 
@@ -49,27 +53,60 @@ void AEnemyDroneAIController::OnPossess(APawn* InPawn)
 	InPawn->Tags.Add(FName("Enemy"));
 }
 
-void AEnemyDroneAIController::OnPerceptionUpdate(AActor* Actor, FAIStimulus Stimulus)
+const UDroneArchetype* AEnemyDroneAIController::GetDroneArchetype() const
+{
+	auto* drone = Cast<ADroneCharacter>(GetPawn());
+	return drone ? drone->GetArchetype() : GetDefault<UDroneArchetype>();
+}
+
+float AEnemyDroneAIController::GetMaxShotDistance() const
+{
+	return GetDroneArchetype()->GetMaxShotDistance();
+}
+
+int AEnemyDroneAIController::GetMinShotDamage() const
+{
+	return GetDroneArchetype()->GetMinShotDamage();
+}
+
+int AEnemyDroneAIController::GetMaxShotDamage() const
+{
+	return GetDroneArchetype()->GetMaxShotDamage();
+}
+
+void AEnemyDroneAIController::SetBehaviorTreeTickInterval(float Interval)
 {
-	// Does the perceived actor have the "Player" tag?
-	if (Actor->ActorHasTag(FName("Player")))
+	// Check the behavior tree is running.
+	auto* brainComponent = GetBrainComponent();
+	if (brainComponent)
 	{
-		// Did the player enter or leave the AI's sight?
-		if (Stimulus.WasSuccessfullySensed())
-		{
-			// Set can see player to true
-			GetBlackboardComponent()->SetValueAsBool(CanSeePlayerBlackboardValueName, true);
+		brainComponent->SetComponentTickInterval(Interval);
 
-			// Set reference to the seen object
-			GetBlackboardComponent()->SetValueAsObject(TargetBlackboardValueName, Actor);
-		}
-		else
+		// Behavior trees ticked by the drone AI scheduler keep their own copy, as the behavior tree overwrites its tick interval.
+		auto* droneBehaviorTree = Cast<UDroneBehaviorTreeComponent>(brainComponent);
+		if (droneBehaviorTree)
 		{
-			// Set can see player to false
-			GetBlackboardComponent()->SetValueAsBool(CanSeePlayerBlackboardValueName, false);
-
-			// Set target to null
-			GetBlackboardComponent()->SetValueAsObject(TargetBlackboardValueName, nullptr);
+			droneBehaviorTree->SetScheduledTickInterval(Interval);
 		}
 	}
 }
+
+void AEnemyDroneAIController::SetSightTarget(AActor* Target)
+{
+	// Check the behavior tree is running.
+	auto* blackboardComponent = GetBlackboardComponent();
+	if (!blackboardComponent)
+	{
+		return;
+	}
+
+	// Only write to the blackboard when the target changes so observing decorators aren't re-evaluated needlessly.
+	if (blackboardComponent->GetValue<UBlackboardKeyType_Object>(TargetKey) == Target)
+	{
+		return;
+	}
+
+	// Set whether the drone can see a player and the reference to the seen player.
+	blackboardComponent->SetValue<UBlackboardKeyType_Bool>(CanSeePlayerKey, Target != nullptr);
+	blackboardComponent->SetValue<UBlackboardKeyType_Object>(TargetKey, Target);
+}
@@ -4,7 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
-#include "Perception/AIPerceptionTypes.h"
+#include "BehaviorTree/BehaviorTreeTypes.h"
 #include "EnemyDroneAIController.generated.h"
 
 /**
@@ -14,35 +14,39 @@ UCLASS()
 class UNREALSFAS_API AEnemyDroneAIController : public AAIController
 {
 	GENERATED_BODY()
-	
-	/** AI perception **/
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI Perception", meta = (AllowPrivateAccess = "true"))
-	class UAIPerceptionComponent* AiPerceptionComponent;
 
 public:
 	AEnemyDroneAIController();
 
+	/** Returns the tuning data of the controlled drone, or the archetype defaults if no drone is controlled. */
+	const class UDroneArchetype* GetDroneArchetype() const;
+
 	UFUNCTION(BlueprintCallable, Category = AI)
-	FORCEINLINE float GetMaxShotDistance() const { return MaxShotDistance; }
+	float GetMaxShotDistance() const;
 	
 	UFUNCTION(BlueprintCallable, Category = AI)
-	FORCEINLINE int GetMinShotDamage() const { return MinShotDamage; }
+	int GetMinShotDamage() const;
 
 	UFUNCTION(BlueprintCallable, Category = AI)
-	FORCEINLINE int GetMaxShotDamage() const { return MaxShotDamage; }
+	int GetMaxShotDamage() const;
+
+	/** Sets the seconds between behavior tree updates. 0 updates every frame. */
+	void SetBehaviorTreeTickInterval(float Interval);
+
+	/** Sets the player the drone can see, or nullptr if it can't see any. Called by the game mode's drone visibility service. */
+	void SetSightTarget(AActor* Target);
 
 protected:
 	void BeginPlay() override;
 	void OnPossess(APawn* InPawn) override;
 
 private:
-	/** Bound as delegate to OnTargetPerceptionUpdate */
-	UFUNCTION()
-	void OnPerceptionUpdate(AActor* Actor, FAIStimulus Stimulus);
+	/** Drones copy the deprecated shot tuning into their legacy archetype. */
+	friend class ADroneCharacter;
 
-private:
-	/** Sight sense configuration */
-	class UAISenseConfig_Sight* AiSightConfig;
+	/** Blackboard key IDs resolved from the key names when the behavior tree starts. */
+	FBlackboard::FKey CanSeePlayerKey;
+	FBlackboard::FKey TargetKey;
 
 	///////////////////////////////////////////////
 	/** Drone AI category */
@@ -58,16 +62,17 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true"))
 	FName TargetBlackboardValueName;
 
-	/** Set in the derived blueprint */
-	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true"))
+	/**
+	 * Deprecated shot tuning. Still loaded so the values set on existing controller blueprints aren't lost, and copied into the
+	 * legacy archetype of drones without an archetype asset. Remove once the content has been moved over.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the shot distance on the drone archetype instead."))
 	float MaxShotDistance;
 
-	/** Set in the derived blueprint */
-	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the shot damage on the drone archetype instead."))
 	int MinShotDamage;
 
-	/** Set in the derived blueprint */
-	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(EditDefaultsOnly, Category = "Drone AI", meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Set the shot damage on the drone archetype instead."))
 	int MaxShotDamage;
 	///////////////////////////////////////////////
 };
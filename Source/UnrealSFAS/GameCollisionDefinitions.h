@@ -4,4 +4,25 @@
 
 #include "CoreMinimal.h"
 
+// The game's collision channels, object types and profiles. Their names and default responses are set up in DefaultEngine.ini.
+// Both trace channels are blocked by default, so the floor and the rest of the level geometry stop shots and drone sight
+// without any content changes, and rendering visibility settings can't change what a shot or a drone's line of sight hits.
+// Gameplay shapes that shouldn't stop them, such as drone capsules, pickups, spawn volumes and weapons, ignore both explicitly.
 
+/** Trace channel of player and drone shots. Blocked by world geometry and player capsules. Drones are tested against their hit proxies in the drone registry instead. */
+#define COLLISION_SHOT ECC_GameTraceChannel1
+
+/** Trace channel of drone line of sight checks. Blocked by world geometry and players. Drones never block each other's sight. */
+#define COLLISION_SIGHT ECC_GameTraceChannel2
+
+/**
+ * Object type of drone capsules. Blocked by default like pawns, so walls, players and other drones still stop drone movement,
+ * but overlap-only shapes such as pickups and spawn volumes can ignore drones without ignoring the players.
+ */
+#define COLLISION_DRONE ECC_GameTraceChannel3
+
+/** Collision profile of maze walls. Blocks every channel, including drones, shots and drone sight. */
+#define COLLISION_PROFILE_MAZE_WALL FName(TEXT("MazeWall"))
+
+/** Collision profile of drone capsules. Drone object type that ignores shots, drone sight and visibility. */
+#define COLLISION_PROFILE_DRONE FName(TEXT("Drone"))
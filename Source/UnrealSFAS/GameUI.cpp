@@ -2,6 +2,27 @@
 
 
 #include "GameUI.h"
+#include "Components/Widget.h"
+
+UGameUI::UGameUI(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Set default member values.
+	DynamicDotMaterial = nullptr;
+	ReticleOffset = 0.f;
+	AppliedReticleOffset = -1.f;
+	ReticleNorth = nullptr;
+	ReticleSouth = nullptr;
+	ReticleEast = nullptr;
+	ReticleWest = nullptr;
+	ReticleNorthTargetPosition = FVector2D::ZeroVector;
+	ReticleSouthTargetPosition = FVector2D::ZeroVector;
+	ReticleEastTargetPosition = FVector2D::ZeroVector;
+	ReticleWestTargetPosition = FVector2D::ZeroVector;
+	ParentDotMaterial = nullptr;
+	MaxReticleSlateUnitOffset = 0.f;
+	ReticleInterpolationSpeed = 0.f;
+}
 
 void UGameUI::NativeConstruct()
 {
@@ -19,3 +40,84 @@ void UGameUI::NativeConstruct()
 		}
 	}
 }
+
+void UGameUI::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+	Super::NativeTick(MyGeometry, InDeltaTime);
+
+	UpdateReticle(InDeltaTime);
+	FlushViewModel();
+}
+
+void UGameUI::FlushViewModel()
+{
+	const EGameUIField dirtyFields = ViewModel.DirtyFields;
+	if (dirtyFields == EGameUIField::None)
+	{
+		return;
+	}
+	ViewModel.DirtyFields = EGameUIField::None;
+
+	if (EnumHasAnyFlags(dirtyFields, EGameUIField::WaveNumber))
+	{
+		SetWaveNumber(ViewModel.WaveNumber);
+	}
+	if (EnumHasAnyFlags(dirtyFields, EGameUIField::Hitpoints))
+	{
+		SetHitpointsValue(ViewModel.Hitpoints);
+	}
+	if (EnumHasAnyFlags(dirtyFields, EGameUIField::RoundsRemaining))
+	{
+		SetWeaponRoundsRemaining(ViewModel.RoundsRemaining);
+	}
+	if (EnumHasAnyFlags(dirtyFields, EGameUIField::ClipSize))
+	{
+		SetWeaponClipSize(ViewModel.ClipSize);
+	}
+	if (EnumHasAnyFlags(dirtyFields, EGameUIField::ReticleVisible))
+	{
+		SetReticleVisibility(ViewModel.ReticleVisible);
+	}
+	if (EnumHasAnyFlags(dirtyFields, EGameUIField::HitMarkerVisible))
+	{
+		SetHitMarkerVisibility(ViewModel.HitMarkerVisible);
+	}
+	if (EnumHasAnyFlags(dirtyFields, EGameUIField::ReloadPromptVisible))
+	{
+		ShowReloadPrompt(ViewModel.ReloadPromptVisible);
+	}
+}
+
+void UGameUI::UpdateReticle(float DeltaTime)
+{
+	// Ease the spread towards the target, snapping once it is within a tenth of a slate unit.
+	ReticleOffset = FMath::FInterpTo(ReticleOffset, ViewModel.ReticleTargetOffset, DeltaTime, ReticleInterpolationSpeed);
+	if (FMath::IsNearlyEqual(ReticleOffset, ViewModel.ReticleTargetOffset, 0.1f))
+	{
+		ReticleOffset = ViewModel.ReticleTargetOffset;
+	}
+
+	// Only move the reticle parts when the spread has changed, so a settled reticle costs nothing.
+	if (ReticleOffset == AppliedReticleOffset)
+	{
+		return;
+	}
+	AppliedReticleOffset = ReticleOffset;
+
+	if (ReticleNorth)
+	{
+		ReticleNorth->SetRenderTranslation(FVector2D(0.f, -ReticleOffset));
+	}
+	if (ReticleSouth)
+	{
+		ReticleSouth->SetRenderTranslation(FVector2D(0.f, ReticleOffset));
+	}
+	if (ReticleEast)
+	{
+		ReticleEast->SetRenderTranslation(FVector2D(ReticleOffset, 0.f));
+	}
+	if (ReticleWest)
+	{
+		ReticleWest->SetRenderTranslation(FVector2D(-ReticleOffset, 0.f));
+	}
+}
@@ -6,6 +6,62 @@
 #include "Blueprint/UserWidget.h"
 #include "GameUI.generated.h"
 
+/** The fields of the game UI view model, used to mark which have changed since they were last shown. */
+enum class EGameUIField : uint8
+{
+	None = 0,
+	WaveNumber = 1 << 0,
+	Hitpoints = 1 << 1,
+	RoundsRemaining = 1 << 2,
+	ClipSize = 1 << 3,
+	ReticleVisible = 1 << 4,
+	HitMarkerVisible = 1 << 5,
+	ReloadPromptVisible = 1 << 6,
+	All = 0x7f
+};
+ENUM_CLASS_FLAGS(EGameUIField);
+
+/**
+ * The values a player's game UI shows. Gameplay code sets them as they change, and the widget shows the changed ones once per
+ * frame. Setting a field to the value it already has doesn't mark it changed, so the widget's events only run on real changes.
+ */
+struct FGameUIViewModel
+{
+	FORCEINLINE void SetWaveNumber(int32 Value) { SetField(WaveNumber, Value, EGameUIField::WaveNumber); }
+	FORCEINLINE void SetHitpoints(int32 Value) { SetField(Hitpoints, Value, EGameUIField::Hitpoints); }
+	FORCEINLINE void SetRoundsRemaining(int32 Value) { SetField(RoundsRemaining, Value, EGameUIField::RoundsRemaining); }
+	FORCEINLINE void SetClipSize(int32 Value) { SetField(ClipSize, Value, EGameUIField::ClipSize); }
+	FORCEINLINE void SetReticleVisible(bool Value) { SetField(ReticleVisible, Value, EGameUIField::ReticleVisible); }
+	FORCEINLINE void SetHitMarkerVisible(bool Value) { SetField(HitMarkerVisible, Value, EGameUIField::HitMarkerVisible); }
+	FORCEINLINE void SetReloadPromptVisible(bool Value) { SetField(ReloadPromptVisible, Value, EGameUIField::ReloadPromptVisible); }
+
+	/** Sets how far, in slate units, the reticle parts should spread from the centre. The widget eases them there. */
+	FORCEINLINE void SetReticleTargetOffset(float Value) { ReticleTargetOffset = Value; }
+
+	int32 WaveNumber = 0;
+	int32 Hitpoints = 0;
+	int32 RoundsRemaining = 0;
+	int32 ClipSize = 0;
+	bool ReticleVisible = false;
+	bool HitMarkerVisible = false;
+	bool ReloadPromptVisible = false;
+	float ReticleTargetOffset = 0.f;
+
+	/** The fields changed since the widget last showed them. Every field is shown on the first frame. */
+	EGameUIField DirtyFields = EGameUIField::All;
+
+private:
+	template<typename T>
+	FORCEINLINE void SetField(T& Field, T Value, EGameUIField FieldFlag)
+	{
+		if (Field != Value)
+		{
+			Field = Value;
+			DirtyFields |= FieldFlag;
+		}
+	}
+};
+
 /**
  * 
  */
@@ -15,17 +71,10 @@ class UNREALSFAS_API UGameUI : public UUserWidget
 	GENERATED_BODY()
 	
 public:
-	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
-	void SetDotMaterial(UMaterialInstanceDynamic* Material);
+	UGameUI(const FObjectInitializer& ObjectInitializer);
 
 	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
-	void SetReticleVisibility(bool Visible);
-
-	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
-	void SetHitMarkerVisibility(bool Visible);
-
-	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
-	void SetWaveNumber(int wave);
+	void SetDotMaterial(UMaterialInstanceDynamic* Material);
 
 	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
 	void Show(bool Show);
@@ -37,14 +86,37 @@ public:
 	void HideWaveStatusNotification();
 
 	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
-	void SetHitpointsValue(int Hitpoints);
+	void PlayImpactAnim();
 
-	UFUNCTION(BlueprintImplementableEvent, Category = "Reticle")
+	/**
+	 * Deprecated reticle events. No longer called: the reticle is eased in C++ and its parts are moved through the ReticleNorth,
+	 * ReticleSouth, ReticleEast and ReticleWest bindings. Kept so the derived blueprint still compiles. Remove once it no longer implements them.
+	 */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Reticle", meta = (DeprecatedFunction, DeprecationMessage = "The reticle is eased in C++. Set the target spread on the view model instead."))
 	void UpdateReticleTargetPosition(float Accuracy);
 
-	UFUNCTION(BlueprintImplementableEvent, Category = "Reticle")
+	UFUNCTION(BlueprintImplementableEvent, Category = "Reticle", meta = (DeprecatedFunction, DeprecationMessage = "The reticle is eased in C++ as the widget ticks."))
 	void InterpReticleToTargetPosition(float DeltaTime);
 
+	/** Returns the values shown by the UI. Changes are shown the next time the widget ticks. */
+	FORCEINLINE FGameUIViewModel& GetViewModel() { return ViewModel; }
+
+	FORCEINLINE float GetMaxReticleSlateUnitOffset() const { return MaxReticleSlateUnitOffset; }
+
+protected:
+	/** The events below are called by FlushViewModel when their field of the view model has changed. Implemented in the derived blueprint. */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
+	void SetReticleVisibility(bool Visible);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
+	void SetHitMarkerVisibility(bool Visible);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
+	void SetWaveNumber(int wave);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
+	void SetHitpointsValue(int Hitpoints);
+
 	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
 	void SetWeaponRoundsRemaining(int RoundsRemaining);
 
@@ -54,24 +126,45 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
 	void ShowReloadPrompt(bool Show);
 
-	UFUNCTION(BlueprintImplementableEvent, Category = "Game UI")
-	void PlayImpactAnim();
+	void NativeConstruct() override;
 
-	FORCEINLINE float GetMaxReticleSlateUnitOffset() const { return MaxReticleSlateUnitOffset; }
+	/** Eases the reticle towards its target spread and shows the view model fields that changed this frame. */
+	void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
 
-protected:
-	void NativeConstruct() override;
+private:
+	/** Calls the blueprint event of each changed view model field, then marks them all shown. */
+	void FlushViewModel();
+
+	/** Eases the reticle spread towards the view model's target and moves the reticle parts when it changes. */
+	void UpdateReticle(float DeltaTime);
 
 private:
 	UMaterialInstanceDynamic* DynamicDotMaterial;
 
-	UPROPERTY(BlueprintReadWrite, Category = "Reticle", meta = (AllowPrivateAccess = "true"))
+	FGameUIViewModel ViewModel;
+
+	/** The reticle spread being shown, and the spread the reticle parts were last moved to. */
+	float ReticleOffset;
+	float AppliedReticleOffset;
+
+	/** The parts of the reticle, moved out from their designer positions as the spread grows. Named in the derived blueprint. */
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UWidget* ReticleNorth;
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UWidget* ReticleSouth;
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UWidget* ReticleEast;
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UWidget* ReticleWest;
+
+	/** Deprecated reticle target positions, only used by the deprecated reticle events. Remove with them. */
+	UPROPERTY(BlueprintReadWrite, Category = "Reticle", meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "The reticle is eased in C++."))
 	FVector2D ReticleNorthTargetPosition;
-	UPROPERTY(BlueprintReadWrite, Category = "Reticle", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(BlueprintReadWrite, Category = "Reticle", meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "The reticle is eased in C++."))
 	FVector2D ReticleSouthTargetPosition;
-	UPROPERTY(BlueprintReadWrite, Category = "Reticle", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(BlueprintReadWrite, Category = "Reticle", meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "The reticle is eased in C++."))
 	FVector2D ReticleEastTargetPosition;
-	UPROPERTY(BlueprintReadWrite, Category = "Reticle", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(BlueprintReadWrite, Category = "Reticle", meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "The reticle is eased in C++."))
 	FVector2D ReticleWestTargetPosition;
 
 	////////////////////////////////////
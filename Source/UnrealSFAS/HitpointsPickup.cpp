@@ -17,10 +17,15 @@ void AHitpointsPickup::OnPickedUpByPlayer(AUnrealSFASCharacter* Player)
 	// Check Player is valid.
 	if (Player)
 	{
-		// Deal negative damage to the player, which will heal them.
-		Player->RecieveDamage(-Amount);
+		ApplyToPlayer(Player);
 
 		// Destroy the pickup actor.
 		this->Destroy();
 	}
 }
+
+void AHitpointsPickup::ApplyToPlayer(AUnrealSFASCharacter* Player) const
+{
+	// Deal negative damage to the player, which will heal them.
+	Player->RecieveDamage(-Amount);
+}
@@ -20,6 +20,9 @@ public:
 	/** Override of APickup's OnPickedUpByPlayer method. */
 	void OnPickedUpByPlayer(class AUnrealSFASCharacter* Player) override;
 
+	/** Override of APickup's ApplyToPlayer method. Heals the player. */
+	void ApplyToPlayer(class AUnrealSFASCharacter* Player) const override;
+
 private:
 	/** The amount of hitpoints to add to the player's hitpoints total on pickup. The player's total hitpoints will be clamped to their maximum hitpoints value if the maximum is exceeded. */
 	UPROPERTY(EditDefaultsOnly,Category = Pickup, Meta = (AllowPrivateAccess = "true"))
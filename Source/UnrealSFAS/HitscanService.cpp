@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HitscanService.h"
+#include "UnrealSFAS.h"
+#include "UnrealSFASCharacter.h"
+#include "DroneCharacter.h"
+#include "DroneSwarm.h"
+#include "ShotLatencyTracker.h"
+#include "GameCollisionDefinitions.h"
+#include "DroneHitProxyHistory.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Apply hitscan results"), STAT_HitscanResults, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan shots applied"), STAT_HitscanShotsApplied, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan results lost and retraced"), STAT_HitscanResultsLost, STATGROUP_SFASDrones);
+
+FHitscanService::FHitscanService()
+{
+}
+
+void FHitscanService::FireShot(UWorld* World, const FDroneRegistry& Registry, const FHitscanShot& Shot, FDroneHitProxyHistory* History)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	// The ignored actor fits the query params' inline storage, so queuing a shot doesn't allocate.
+	const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(HitscanShot), false, Shot.Shooter.Get());
+
+	FPendingShot& pendingShot = PendingShots.AddDefaulted_GetRef();
+	pendingShot.Shot = Shot;
+	pendingShot.FrameNumber = GFrameCounter;
+	pendingShot.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Shot.Start, Shot.End, COLLISION_SHOT, queryParams);
+
+	// Drone shots pass through other drones, so only player shots are tested against the drone hit proxies.
+	if (Shot.Source == EHitscanShotSource::Drone)
+	{
+		return;
+	}
+
+	// Drones are tested now, against where they were when the fire input was received, or where they are if it wasn't recorded.
+	auto* shooterDrone = Cast<ADroneCharacter>(Shot.Shooter.Get());
+	const FDroneHandle ignore = shooterDrone ? shooterDrone->GetRegistryHandle() : FDroneHandle();
+	if (History && (Shot.InputCycles != 0))
+	{
+		pendingShot.DroneHit = History->Raycast(Registry, Shot.InputCycles, Shot.Start, Shot.End, BIG_NUMBER, ignore, pendingShot.DroneHitDistance);
+	}
+	else
+	{
+		pendingShot.DroneHit = Registry.Raycast(Shot.Start, Shot.End, BIG_NUMBER, ignore, pendingShot.DroneHitDistance);
+	}
+}
+
+void FHitscanService::FireShots(UWorld* World, const FDroneRegistry& Registry, TArrayView<const FHitscanShot> Shots, FDroneHitProxyHistory* History)
+{
+	PendingShots.Reserve(PendingShots.Num() + Shots.Num());
+	for (const FHitscanShot& shot : Shots)
+	{
+		FireShot(World, Registry, shot, History);
+	}
+}
+
+void FHitscanService::Tick(UWorld* World, const FDroneRegistry& Registry, ADroneSwarm* Swarm, FShotLatencyTracker& ShotLatency)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HitscanResults);
+
+	if (!World)
+	{
+		return;
+	}
+
+	uint32 applied = 0;
+	uint32 lost = 0;
+	RemainingShots.Reset();
+	for (const FPendingShot& pendingShot : PendingShots)
+	{
+		// Shots fired earlier this frame are traced at the end of it.
+		if (pendingShot.FrameNumber == GFrameCounter)
+		{
+			RemainingShots.Add(pendingShot);
+			continue;
+		}
+
+		FTraceDatum traceDatum;
+		FHitResult retraceHit;
+		const FHitResult* blockingHit = nullptr;
+		if (World->QueryTraceData(pendingShot.Handle, traceDatum))
+		{
+			if ((traceDatum.OutHits.Num() > 0) && traceDatum.OutHits[0].bBlockingHit)
+			{
+				blockingHit = &traceDatum.OutHits[0];
+			}
+		}
+		// A lost result can't be treated as a clear shot, or shots would pass through walls. Trace it again, blocking this time.
+		else
+		{
+			const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(HitscanShotRetrace), false, pendingShot.Shot.Shooter.Get());
+			if (World->LineTraceSingleByChannel(retraceHit, pendingShot.Shot.Start, pendingShot.Shot.End, COLLISION_SHOT, queryParams))
+			{
+				blockingHit = &retraceHit;
+			}
+			lost++;
+		}
+		ShotLatency.MarkStage(pendingShot.Shot.LatencyRecord, EShotLatencyStage::Traced);
+
+		switch (pendingShot.Shot.Source)
+		{
+		case EHitscanShotSource::Player:
+			ApplyPlayerShot(pendingShot, blockingHit, Registry, Swarm, ShotLatency);
+			break;
+		case EHitscanShotSource::Drone:
+			ApplyDroneShot(pendingShot, blockingHit);
+			break;
+		}
+		applied++;
+	}
+
+	Swap(PendingShots, RemainingShots);
+
+	SET_DWORD_STAT(STAT_HitscanShotsApplied, applied);
+	SET_DWORD_STAT(STAT_HitscanResultsLost, lost);
+}
+
+void FHitscanService::Reset()
+{
+	PendingShots.Reset();
+	RemainingShots.Reset();
+}
+
+void FHitscanService::ApplyPlayerShot(const FPendingShot& PendingShot, const FHitResult* BlockingHit, const FDroneRegistry& Registry, ADroneSwarm* Swarm, FShotLatencyTracker& ShotLatency)
+{
+	const FHitscanShot& shot = PendingShot.Shot;
+	auto* shooter = Cast<AUnrealSFASCharacter>(shot.Shooter.Get());
+	if (!shooter)
+	{
+		ShotLatency.EndShot(shot.LatencyRecord);
+		return;
+	}
+
+	// The drone hit counts if it is in front of the world geometry the trace hit. Drones destroyed or killed since the shot was fired
+	// are missed.
+	ADroneCharacter* enemy = nullptr;
+	float hitDistance = BlockingHit ? BlockingHit->Distance : FVector::Distance(shot.Start, shot.End);
+	const int32 denseIndex = Registry.GetDenseIndex(PendingShot.DroneHit);
+	if ((denseIndex != INDEX_NONE) && EnumHasAnyFlags(Registry.GetFlags()[denseIndex], EDroneStateFlags::Alive) && (PendingShot.DroneHitDistance <= hitDistance))
+	{
+		enemy = Registry.GetActor(denseIndex);
+		hitDistance = PendingShot.DroneHitDistance;
+	}
+
+	// Swarm drones have no collision. Check whether the shot hit one before anything else, promoting it to a drone character if it did.
+	if (Swarm)
+	{
+		auto* swarmDrone = Swarm->PromoteHitDrone(shot.Start, shot.End, hitDistance);
+		if (swarmDrone)
+		{
+			enemy = swarmDrone;
+		}
+	}
+
+	// The damage queue ends the latency record of a hit once the hit marker is updated.
+	if (enemy)
+	{
+		shooter->OnShotHitEnemy(enemy, shot.Damage, shot.LatencyRecord);
+	}
+	else
+	{
+		ShotLatency.EndShot(shot.LatencyRecord);
+	}
+}
+
+void FHitscanService::ApplyDroneShot(const FPendingShot& PendingShot, const FHitResult* BlockingHit)
+{
+	const FHitscanShot& shot = PendingShot.Shot;
+	auto* target = Cast<AUnrealSFASCharacter>(shot.Target.Get());
+	if (!target || target->GetDefeated())
+	{
+		return;
+	}
+
+	// World geometry in the way blocks the shot. Other drones don't, as the shot was never tested against them.
+	const bool blockedByWorld = BlockingHit && (BlockingHit->GetActor() != target);
+	if (!blockedByWorld)
+	{
+		target->RecieveDamage(shot.Damage);
+	}
+}
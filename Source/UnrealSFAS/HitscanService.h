@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+#include "DroneRegistry.h"
+
+/** Who fired a hitscan shot, which decides how its result is applied. */
+enum class EHitscanShotSource : uint8
+{
+	/** Fired by a player character. Damages the drone hit, including swarm drones. */
+	Player,
+
+	/** Fired by a drone. Damages its target player if no world geometry is in the way. Passes through other drones. */
+	Drone,
+};
+
+/** A hitscan shot to trace. */
+struct FHitscanShot
+{
+	EHitscanShotSource Source = EHitscanShotSource::Player;
+
+	/** The actor that fired the shot. Ignored by the trace and the drone hit proxies. */
+	TWeakObjectPtr<class AActor> Shooter;
+
+	/** The player a drone shot is aimed at. Unused by player shots. */
+	TWeakObjectPtr<class AActor> Target;
+
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+
+	/** The damage dealt if the shot hits. Rolled when the shot is fired. */
+	int32 Damage = 0;
+
+	/** When the input that fired the shot was received, in cycles. The shot is tested against the drones where they were then. 0 tests where they are now. */
+	uint64 InputCycles = 0;
+
+	/** The shot's record in the game mode's shot latency tracker. INDEX_NONE if the shot isn't timed. */
+	int32 LatencyRecord = INDEX_NONE;
+};
+
+/**
+ * Traces every hitscan shot fired in a frame as one batch of asynchronous scene queries, instead of a blocking trace per shot.
+ * Drones are not part of the scene query: each shot is tested against the drones' hit proxies in the registry when it is fired,
+ * and the trace only has to find world geometry and players. Shots are queued as they are fired and their traces run alongside
+ * the rest of the frame. The results are applied at the start of the game mode's tick on the following frame: player shots
+ * damage the drone hit on behalf of the player and drone shots damage their target player, both through the game mode's damage
+ * queue. A shot whose result was lost is traced again there with a blocking trace, so it is never treated as unobstructed.
+ * Drones never block another drone's shot, matching drone projectiles in FProjectileSimulation.
+ */
+class UNREALSFAS_API FHitscanService
+{
+public:
+	FHitscanService();
+
+	/**
+	 * Tests a player shot against the drone hit proxies and queues the shot's trace. Its result is applied on the next call to Tick after this frame.
+	 * Shots with an input time are tested against the drones where History says they were then, if History is set.
+	 */
+	void FireShot(UWorld* World, const FDroneRegistry& Registry, const FHitscanShot& Shot, class FDroneHitProxyHistory* History = nullptr);
+
+	/** Queues every shot's trace in one batch, such as the pellets of a shotgun shot. */
+	void FireShots(UWorld* World, const FDroneRegistry& Registry, TArrayView<const FHitscanShot> Shots, class FDroneHitProxyHistory* History = nullptr);
+
+	/** Applies the results of the shots fired on previous frames, marking when each timed shot was traced. Swarm may be nullptr. */
+	void Tick(UWorld* World, const FDroneRegistry& Registry, class ADroneSwarm* Swarm, class FShotLatencyTracker& ShotLatency);
+
+	/** Drops every shot still in flight. */
+	void Reset();
+
+	FORCEINLINE int32 NumPendingShots() const { return PendingShots.Num(); }
+
+private:
+	/** A shot whose trace is in flight. */
+	struct FPendingShot
+	{
+		FHitscanShot Shot;
+		FTraceHandle Handle;
+
+		/** The frame the shot was fired on. Its trace result can be read from the following frame. */
+		uint64 FrameNumber;
+
+		/** The first drone hit proxy the shot passed through, and the distance to it. Unset if the shot missed every drone. */
+		FDroneHandle DroneHit;
+		float DroneHitDistance;
+	};
+
+	/** Applies a player shot: damages the first drone hit, promoting a swarm drone if one was hit first. Ends the shot's latency record if it missed. */
+	static void ApplyPlayerShot(const FPendingShot& PendingShot, const FHitResult* BlockingHit, const FDroneRegistry& Registry, class ADroneSwarm* Swarm, class FShotLatencyTracker& ShotLatency);
+
+	/** Applies a drone shot: damages the target if no world geometry blocked the shot. */
+	static void ApplyDroneShot(const FPendingShot& PendingShot, const FHitResult* BlockingHit);
+
+private:
+	TArray<FPendingShot> PendingShots;
+
+	/** Shots fired this frame, kept for the next Tick. Scratch storage. */
+	TArray<FPendingShot> RemainingShots;
+};
@@ -5,6 +5,9 @@
 #include "Components/SphereComponent.h"
 #include "GameFramework/RotatingMovementComponent.h"
 #include "UnrealSFASCharacter.h"
+#include "UnrealSFASGameMode.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameCollisionDefinitions.h"
 
 // Sets default values
 APickup::APickup()
@@ -23,6 +26,10 @@ APickup::APickup()
 	Sphere->SetupAttachment(RootComponent);
 	Sphere->InitSphereRadius(32.f);
 	Sphere->OnComponentBeginOverlap.AddDynamic(this, &APickup::OnBeginOverlap);
+	// The sphere is only for overlaps with players, so it doesn't stop shots or drone sight and drones don't overlap it.
+	Sphere->SetCollisionResponseToChannel(COLLISION_SHOT, ECR_Ignore);
+	Sphere->SetCollisionResponseToChannel(COLLISION_SIGHT, ECR_Ignore);
+	Sphere->SetCollisionResponseToChannel(COLLISION_DRONE, ECR_Ignore);
 
 	// Setup rotating movement component
 	RotatingMovement = CreateDefaultSubobject<URotatingMovementComponent>(TEXT("RotatingMovement"));
@@ -51,17 +58,38 @@ void APickup::BeginPlay()
 	Super::BeginPlay();
 	
 	// Set a timer that destroys the pickup after its alive duration has expired.
-	GetWorldTimerManager().SetTimer(AliveTimerHandle, this, &APickup::OnAliveDurationExpired, AliveDuration, false);
+	// Under any other game mode there is no timing wheel, so fall back to the actor's own life span.
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		AliveTimerHandle = unrealSFASGameMode->GetTimingWheel().SetTimer(AliveDuration, &APickup::OnAliveDurationExpired, this);
+	}
+	else
+	{
+		SetLifeSpan(AliveDuration);
+	}
+}
+
+void APickup::ApplyToPlayer(AUnrealSFASCharacter* Player) const
+{
 }
 
 void APickup::OnPickedUpByPlayer(AUnrealSFASCharacter* Player)
 {
 	// Stop the alive timer. The pickup actor state should be managed by the OnBeginOverlap override.
-	GetWorldTimerManager().ClearTimer(AliveTimerHandle);
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		unrealSFASGameMode->GetTimingWheel().ClearTimer(AliveTimerHandle);
+	}
+	else
+	{
+		SetLifeSpan(0.f);
+	}
 }
 
-void APickup::OnAliveDurationExpired()
+void APickup::OnAliveDurationExpired(UObject* Context, int32 Payload)
 {
 	// Destroy the actor.
-	this->Destroy();
+	CastChecked<APickup>(Context)->Destroy();
 }
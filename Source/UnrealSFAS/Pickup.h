@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "TimingWheel.h"
 #include "Pickup.generated.h"
 
 UCLASS()
@@ -30,6 +31,14 @@ public:
 	UFUNCTION()
 	void OnBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
+	/** Gives the pickup's effect to the player. Called on the default object for pickups held by the pickup manager. */
+	virtual void ApplyToPlayer(class AUnrealSFASCharacter* Player) const;
+
+	FORCEINLINE const UStaticMeshComponent* GetMesh() const { return Mesh; }
+	FORCEINLINE const class USphereComponent* GetSphere() const { return Sphere; }
+	FORCEINLINE const class URotatingMovementComponent* GetRotatingMovement() const { return RotatingMovement; }
+	FORCEINLINE float GetAliveDuration() const { return AliveDuration; }
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -38,9 +47,9 @@ protected:
 	virtual void OnPickedUpByPlayer(class AUnrealSFASCharacter* Player);
 
 private:
-	UFUNCTION()
-	void OnAliveDurationExpired();
-	FTimerHandle AliveTimerHandle;
+	/** Timing wheel callback of the alive timer. Context is the pickup. */
+	static void OnAliveDurationExpired(UObject* Context, int32 Payload);
+	FTimingWheelHandle AliveTimerHandle;
 
 	/** The duration in seconds to remain alive for once dropped. Upon expiration the pickup is destroyed. */
 	UPROPERTY(EditDefaultsOnly, Category = Pickup, Meta = (AllowPrivateAccess = "true"))
@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupManager.h"
+#include "UnrealSFAS.h"
+#include "Pickup.h"
+#include "UnrealSFASCharacter.h"
+#include "DroneVisibilityService.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SphereComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/RotatingMovementComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup update"), STAT_PickupUpdate, STATGROUP_SFASGameplay);
+DECLARE_CYCLE_STAT(TEXT("Pickup instance update"), STAT_PickupInstanceUpdate, STATGROUP_SFASGameplay);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickups"), STAT_Pickups, STATGROUP_SFASGameplay);
+
+// Sets default values
+APickupManager::APickupManager()
+{
+	// The pickups are updated by the game mode.
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	// Set member default values.
+	NumPickups = 0;
+}
+
+void APickupManager::DropPickup(TSubclassOf<APickup> PickupClass, const FVector& Location, const FRotator& Rotation)
+{
+	if (!PickupClass || !GetWorld())
+	{
+		return;
+	}
+
+	FPickupKind& kind = FindOrAddKind(PickupClass);
+	const float timeSeconds = GetWorld()->GetTimeSeconds();
+
+	FPickupRecord& pickup = kind.Pickups.AddDefaulted_GetRef();
+	pickup.Location = Location;
+	pickup.Rotation = Rotation.Quaternion();
+	pickup.DroppedTime = timeSeconds;
+	pickup.ExpireTime = timeSeconds + kind.Definition->GetAliveDuration();
+	NumPickups++;
+}
+
+void APickupManager::UpdatePickups(const TArray<FDroneSightTarget>& Players)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PickupUpdate);
+
+	auto* world = GetWorld();
+	if (!world || (Kinds.Num() == 0))
+	{
+		return;
+	}
+	const float timeSeconds = world->GetTimeSeconds();
+
+	// Gather the capsules of the players once for every pickup.
+	PlayerCapsules.Reset();
+	for (const FDroneSightTarget& player : Players)
+	{
+		auto* unrealSFASCharacter = Cast<AUnrealSFASCharacter>(player.Actor);
+		if (unrealSFASCharacter && unrealSFASCharacter->GetCapsuleComponent())
+		{
+			FPlayerCapsule& capsule = PlayerCapsules.AddDefaulted_GetRef();
+			capsule.Player = unrealSFASCharacter;
+			capsule.Location = player.Location;
+			unrealSFASCharacter->GetCapsuleComponent()->GetScaledCapsuleSize(capsule.Radius, capsule.HalfHeight);
+		}
+	}
+
+	NumPickups = 0;
+	for (FPickupKind& kind : Kinds)
+	{
+		// Remove expired pickups and the ones a player has reached. Order doesn't matter, so the last pickup fills the gap.
+		for (int32 i = 0; i < kind.Pickups.Num();)
+		{
+			const FPickupRecord& pickup = kind.Pickups[i];
+			if (timeSeconds >= pickup.ExpireTime)
+			{
+				kind.Pickups.RemoveAtSwap(i, 1, false);
+				continue;
+			}
+
+			// The sphere spins with the mesh it is attached to.
+			const FQuat spin = (kind.RotationRate * (timeSeconds - pickup.DroppedTime)).Quaternion();
+			const FVector sphereLocation = pickup.Location + (pickup.Rotation * spin).RotateVector(kind.SphereOffset);
+			auto* player = FindOverlappingPlayer(sphereLocation, kind.Radius);
+			if (player)
+			{
+				kind.Definition->ApplyToPlayer(player);
+				kind.Pickups.RemoveAtSwap(i, 1, false);
+				continue;
+			}
+
+			i++;
+		}
+
+		UpdateInstances(kind, timeSeconds);
+		NumPickups += kind.Pickups.Num();
+	}
+
+	SET_DWORD_STAT(STAT_Pickups, NumPickups);
+}
+
+APickupManager::FPickupKind& APickupManager::FindOrAddKind(TSubclassOf<APickup> PickupClass)
+{
+	for (FPickupKind& kind : Kinds)
+	{
+		if (kind.PickupClass == PickupClass)
+		{
+			return kind;
+		}
+	}
+
+	// Set the kind up from the class's default components, which hold the mesh, radius and spin set in the derived blueprint.
+	const auto* definition = PickupClass->GetDefaultObject<APickup>();
+	const auto* definitionMesh = definition->GetMesh();
+
+	auto* instances = NewObject<UInstancedStaticMeshComponent>(this);
+	instances->SetStaticMesh(definitionMesh->GetStaticMesh());
+	for (int32 i = 0; i < definitionMesh->GetNumMaterials(); i++)
+	{
+		instances->SetMaterial(i, definitionMesh->GetMaterial(i));
+	}
+	instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	instances->SetGenerateOverlapEvents(false);
+	instances->SetCanEverAffectNavigation(false);
+	instances->SetCastShadow(definitionMesh->CastShadow);
+	instances->SetMobility(EComponentMobility::Movable);
+	instances->SetupAttachment(RootComponent);
+	instances->RegisterComponent();
+
+	FPickupKind& kind = Kinds.AddDefaulted_GetRef();
+	kind.PickupClass = PickupClass;
+	kind.Definition = definition;
+	kind.InstancesIndex = Instances.Add(instances);
+	kind.RotationRate = definition->GetRotatingMovement()->RotationRate;
+	kind.Scale = definitionMesh->GetRelativeScale3D();
+
+	// The default object isn't placed in a world, so its sphere's scaled radius and offset are worked out from the relative
+	// transforms: the sphere is attached to the mesh, which is scaled by Scale. Spheres take their smallest axis scale.
+	const auto* definitionSphere = definition->GetSphere();
+	const FVector sphereScale = definitionSphere->GetRelativeScale3D() * kind.Scale;
+	kind.Radius = definitionSphere->GetUnscaledSphereRadius() * sphereScale.GetAbsMin();
+	kind.SphereOffset = definitionSphere->GetRelativeLocation() * kind.Scale;
+	kind.NumVisibleInstances = 0;
+	return kind;
+}
+
+AUnrealSFASCharacter* APickupManager::FindOverlappingPlayer(const FVector& Location, float Radius) const
+{
+	for (const FPlayerCapsule& capsule : PlayerCapsules)
+	{
+		// Distance from the pickup to the segment through the middle of the upright capsule.
+		const float segmentHalfHeight = FMath::Max(capsule.HalfHeight - capsule.Radius, 0.f);
+		const float closestZ = FMath::Clamp((float)Location.Z, (float)capsule.Location.Z - segmentHalfHeight, (float)capsule.Location.Z + segmentHalfHeight);
+		const FVector closest(capsule.Location.X, capsule.Location.Y, closestZ);
+		if (FVector::DistSquared(Location, closest) <= FMath::Square(Radius + capsule.Radius))
+		{
+			return capsule.Player;
+		}
+	}
+
+	return nullptr;
+}
+
+void APickupManager::UpdateInstances(FPickupKind& Kind, float TimeSeconds)
+{
+	if ((Kind.Pickups.Num() == 0) && (Kind.NumVisibleInstances == 0))
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_PickupInstanceUpdate);
+
+	auto* instances = Instances[Kind.InstancesIndex];
+
+	// Spin each pickup by how long it has been dropped, in its own space, as its rotating movement component did.
+	InstanceTransforms.Reset();
+	for (const FPickupRecord& pickup : Kind.Pickups)
+	{
+		const FQuat spin = (Kind.RotationRate * (TimeSeconds - pickup.DroppedTime)).Quaternion();
+		InstanceTransforms.Emplace(pickup.Rotation * spin, pickup.Location, Kind.Scale);
+	}
+
+	// Instances are never removed. Grow to the most pickups seen and hide the spare instances by scaling them to 0.
+	const int32 numPickups = InstanceTransforms.Num();
+	const int32 numInstances = instances->GetInstanceCount();
+	if (numPickups > numInstances)
+	{
+		TArray<FTransform> newInstances;
+		newInstances.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), numPickups - numInstances);
+		instances->AddInstances(newInstances, false);
+	}
+	InstanceTransforms.SetNum(FMath::Max(numPickups, numInstances));
+	for (int32 i = numPickups; i < InstanceTransforms.Num(); i++)
+	{
+		InstanceTransforms[i] = FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	}
+
+	// Push every instance transform to the renderer in one batch.
+	instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, true);
+	Kind.NumVisibleInstances = numPickups;
+}
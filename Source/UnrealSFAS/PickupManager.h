@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PickupManager.generated.h"
+
+/**
+ * Holds the pickups dropped by drones as plain records instead of actors. Each pickup class is drawn with one instanced static
+ * mesh component set up from its default object, so a pickup needs no components, overlap events, movement tick or timer of its
+ * own. Once per frame the game mode updates the manager, which expires old pickups, tests the rest against the players' capsules,
+ * and pushes the spinning transforms of every pickup of a class to its instanced mesh in one batch.
+ */
+UCLASS()
+class UNREALSFAS_API APickupManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	APickupManager();
+
+	/** Drops a pickup of the class at the location. It is applied to the first player to reach it, or expires after the class's alive duration. */
+	void DropPickup(TSubclassOf<class APickup> PickupClass, const FVector& Location, const FRotator& Rotation);
+
+	/** Expires pickups, applies the ones reached by players and updates the instanced meshes. Called every tick by the game mode. Players are the players still in the game. */
+	void UpdatePickups(const TArray<struct FDroneSightTarget>& Players);
+
+	/** Returns the number of pickups in the world. */
+	FORCEINLINE int32 GetNumPickups() const { return NumPickups; }
+
+private:
+	/** A dropped pickup. */
+	struct FPickupRecord
+	{
+		FVector Location;
+		FQuat Rotation;
+		float DroppedTime;
+		float ExpireTime;
+	};
+
+	/** The pickups of a class, and how they are drawn and collected. */
+	struct FPickupKind
+	{
+		TSubclassOf<class APickup> PickupClass;
+
+		/** The default object of the class, which applies the pickup to a player. */
+		const class APickup* Definition;
+
+		/** The index of the kind's component in Instances. */
+		int32 InstancesIndex;
+
+		/** Copied from the default object's components. The radius and offset of the sphere are scaled by the sphere and the mesh. */
+		float Radius;
+		FVector SphereOffset;
+		FRotator RotationRate;
+		FVector Scale;
+
+		TArray<FPickupRecord> Pickups;
+
+		/** The number of instances showing a pickup after the last update. The rest are hidden. */
+		int32 NumVisibleInstances;
+	};
+
+	/** The capsule of a player still in the game. */
+	struct FPlayerCapsule
+	{
+		class AUnrealSFASCharacter* Player;
+		FVector Location;
+		float Radius;
+		float HalfHeight;
+	};
+
+	/** Returns the kind of the pickup class, adding it and its instanced mesh if this is its first drop. */
+	FPickupKind& FindOrAddKind(TSubclassOf<class APickup> PickupClass);
+
+	/** Returns the player whose capsule overlaps the pickup sphere, or nullptr. */
+	class AUnrealSFASCharacter* FindOverlappingPlayer(const FVector& Location, float Radius) const;
+
+	/** Pushes the transform of every pickup of the kind to its instanced mesh. */
+	void UpdateInstances(FPickupKind& Kind, float TimeSeconds);
+
+private:
+	/** The instanced mesh of each pickup kind. */
+	UPROPERTY()
+	TArray<class UInstancedStaticMeshComponent*> Instances;
+
+	TArray<FPickupKind> Kinds;
+
+	int32 NumPickups;
+
+	/** Scratch storage of the players' capsules. */
+	TArray<FPlayerCapsule> PlayerCapsules;
+
+	/** Scratch storage of the instance transforms. */
+	TArray<FTransform> InstanceTransforms;
+};
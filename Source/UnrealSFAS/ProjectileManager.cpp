@@ -0,0 +1,329 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectileManager.h"
+#include "UnrealSFAS.h"
+#include "UnrealSFASCharacter.h"
+#include "DroneCharacter.h"
+#include "DroneVisibilityService.h"
+#include "DroneHitProxyHistory.h"
+#include "ShotLatencyTracker.h"
+#include "UnrealSFASMaze.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile impacts"), STAT_ProjectileImpacts, STATGROUP_SFASDrones);
+DECLARE_CYCLE_STAT(TEXT("Projectile instance update"), STAT_ProjectileInstanceUpdate, STATGROUP_SFASDrones);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles in flight"), STAT_ProjectilesInFlight, STATGROUP_SFASDrones);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectiles dropped"), STAT_ProjectilesDropped, STATGROUP_SFASDrones);
+
+namespace ProjectileManager
+{
+	/**
+	 * Pushes the transform of every projectile in flight to the instanced mesh in one batch and returns how many there are.
+	 * Instances are never removed: the mesh grows to the most projectiles seen in flight and the spare instances are hidden by scaling them to 0.
+	 */
+	static int32 UpdateInstanceTransforms(UInstancedStaticMeshComponent& Instances, const FProjectileSimulation& Simulation, TArray<FTransform>& Transforms)
+	{
+		Transforms.Reset();
+		Simulation.GatherTransforms(Transforms);
+
+		const int32 numProjectiles = Transforms.Num();
+		const int32 numInstances = Instances.GetInstanceCount();
+		if (numProjectiles > numInstances)
+		{
+			TArray<FTransform> newInstances;
+			newInstances.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), numProjectiles - numInstances);
+			Instances.AddInstances(newInstances, false);
+		}
+		Transforms.SetNum(FMath::Max(numProjectiles, numInstances));
+		for (int32 i = numProjectiles; i < Transforms.Num(); i++)
+		{
+			Transforms[i] = FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+		}
+
+		Instances.BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+		return numProjectiles;
+	}
+}
+
+// Sets default values
+AProjectileManager::AProjectileManager()
+{
+	// The projectiles are updated by the game mode.
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Setup the instanced mesh. Projectiles are tested against hit proxies and the maze directly, so the instances need no collision.
+	Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetGenerateOverlapEvents(false);
+	Instances->SetCastShadow(false);
+	Instances->SetMobility(EComponentMobility::Movable);
+	RootComponent = Instances;
+
+	// Set member default values.
+	NumVisibleInstances = 0;
+}
+
+void AProjectileManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Simulation.Initialize(Settings);
+}
+
+bool AProjectileManager::FireProjectile(const FProjectileSpawn& Spawn)
+{
+	const int32 slot = Simulation.Spawn(Spawn);
+	if (slot == INDEX_NONE)
+	{
+		INC_DWORD_STAT(STAT_ProjectilesDropped);
+		return false;
+	}
+
+	if (Spawn.LatencyRecord != INDEX_NONE)
+	{
+		FirstStepLatencyRecords.Emplace(slot, Spawn.LatencyRecord);
+	}
+
+	return true;
+}
+
+void AProjectileManager::UpdateProjectiles(float DeltaSeconds, const FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Players, const AUnrealSFASMaze* Maze,
+	FDroneHitProxyHistory* History, FShotLatencyTracker& ShotLatency)
+{
+	if ((Simulation.Num() == 0) && (NumVisibleInstances == 0))
+	{
+		return;
+	}
+
+	// Pack the player hit spheres.
+	PlayerX.Reset();
+	PlayerY.Reset();
+	PlayerZ.Reset();
+	for (const FDroneSightTarget& player : Players)
+	{
+		PlayerX.Add(player.Location.X);
+		PlayerY.Add(player.Location.Y);
+		PlayerZ.Add(player.Location.Z);
+	}
+
+	FProjectileStepContext context;
+	context.Drones = Registry.GetHitProxies();
+	context.Registry = &Registry;
+	context.History = History;
+	context.Players.CenterX = PlayerX.GetData();
+	context.Players.CenterY = PlayerY.GetData();
+	context.Players.CenterZ = PlayerZ.GetData();
+	context.Players.UniformRadiusSquared = FMath::Square(Settings.PlayerHitRadius);
+	context.Players.Num = Players.Num();
+	context.WallTopHeights = Maze ? Maze->GetWallTopHeights() : TArrayView<const float>();
+	context.SIMD = FDroneHitProxies::IsSIMDEnabled();
+
+	Simulation.Step(DeltaSeconds, context, StepImpacts);
+	ApplyImpacts(Registry, Players, ShotLatency);
+	UpdateInstances();
+
+	SET_DWORD_STAT(STAT_ProjectilesInFlight, Simulation.Num());
+}
+
+void AProjectileManager::ApplyImpacts(const FDroneRegistry& Registry, const TArray<FDroneSightTarget>& Players, FShotLatencyTracker& ShotLatency)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileImpacts);
+
+	// Every projectile fired since the last step has now taken its first step.
+	for (const TPair<int32, int32>& record : FirstStepLatencyRecords)
+	{
+		ShotLatency.MarkStage(record.Value, EShotLatencyStage::Traced);
+	}
+
+	// Damage is queued with the game mode's damage queue, so no drone leaves the registry and the impacts' dense indices stay valid.
+	for (const FProjectileImpact& impact : StepImpacts)
+	{
+		// Only player projectiles test drones. A hit on a drone killed earlier this frame does no damage.
+		if ((impact.Kind == EProjectileImpact::Drone) && EnumHasAnyFlags(Registry.GetFlags()[impact.HitIndex], EDroneStateFlags::Alive))
+		{
+			auto* enemy = Registry.GetActor(impact.HitIndex);
+			if (enemy)
+			{
+				auto* shooter = Cast<AUnrealSFASCharacter>(Simulation.GetShooter(impact.Slot));
+				if (shooter)
+				{
+					// A projectile that hits on its first step hands its latency record on to the damage queue.
+					const int32 recordIndex = FirstStepLatencyRecords.IndexOfByPredicate([&impact](const TPair<int32, int32>& Record) { return Record.Key == impact.Slot; });
+					int32 latencyRecord = INDEX_NONE;
+					if (recordIndex != INDEX_NONE)
+					{
+						latencyRecord = FirstStepLatencyRecords[recordIndex].Value;
+						FirstStepLatencyRecords.RemoveAtSwap(recordIndex, 1, false);
+					}
+					shooter->OnShotHitEnemy(enemy, Simulation.GetDamage(impact.Slot), latencyRecord);
+				}
+				else
+				{
+					enemy->RecieveDamage(Simulation.GetDamage(impact.Slot));
+				}
+			}
+		}
+		else if ((impact.Kind == EProjectileImpact::Player) && Players.IsValidIndex(impact.HitIndex))
+		{
+			auto* player = Cast<AUnrealSFASCharacter>(Players[impact.HitIndex].Actor);
+			if (player && !player->GetDefeated())
+			{
+				player->RecieveDamage(Simulation.GetDamage(impact.Slot));
+			}
+		}
+
+		Simulation.Release(impact.Slot);
+	}
+
+	// The rest missed on their first step. Their flight time isn't latency, so their records end here.
+	for (const TPair<int32, int32>& record : FirstStepLatencyRecords)
+	{
+		ShotLatency.EndShot(record.Value);
+	}
+	FirstStepLatencyRecords.Reset();
+}
+
+void AProjectileManager::UpdateInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileInstanceUpdate);
+
+	NumVisibleInstances = ProjectileManager::UpdateInstanceTransforms(*Instances, Simulation, InstanceTransforms);
+}
+
+namespace ProjectileManager
+{
+	/**
+	 * Returns the average milliseconds per frame of Count projectiles in flight through a field of drone hit proxies and a walled
+	 * maze grid, as the manager runs them: the step, then the instance transform update. The instanced mesh isn't registered
+	 * with a world, so the cost of uploading the instances to the renderer isn't included.
+	 */
+	static double MeasureFrameMilliseconds(int32 Count, int32 NumFrames, double& OutStepMilliseconds)
+	{
+		const float deltaSeconds = 1.f / 60.f;
+		FRandomStream randomStream(Count);
+
+		// A wall around the edge of the maze and a third of the cells inside it, as tall as the maze's wall blocks.
+		constexpr int32 mazeSize = AUnrealSFASMaze::MazeSize;
+		TArray<float> wallTopHeights;
+		wallTopHeights.Init(TNumericLimits<float>::Lowest(), mazeSize * mazeSize);
+		TArray<FIntPoint> openCells;
+		for (int32 y = 0; y < mazeSize; y++)
+		{
+			for (int32 x = 0; x < mazeSize; x++)
+			{
+				const bool edge = (x == 0) || (y == 0) || (x == (mazeSize - 1)) || (y == (mazeSize - 1));
+				if (edge || (randomStream.FRand() < 0.33f))
+				{
+					wallTopHeights[(y * mazeSize) + x] = AUnrealSFASMaze::BlockSize;
+				}
+				else
+				{
+					openCells.Emplace(x, y);
+				}
+			}
+		}
+
+		// A few hundred drones scattered around the maze, as in a heavy wave.
+		constexpr int32 numDrones = 256;
+		const float mazeHalfExtent = AUnrealSFASMaze::MazeSize * AUnrealSFASMaze::BlockSize * 0.5f;
+		TArray<float> droneX;
+		TArray<float> droneY;
+		TArray<float> droneZ;
+		for (int32 i = 0; i < numDrones; i++)
+		{
+			droneX.Add(randomStream.FRandRange(-mazeHalfExtent, mazeHalfExtent));
+			droneY.Add(randomStream.FRandRange(-mazeHalfExtent, mazeHalfExtent));
+			droneZ.Add(randomStream.FRandRange(50.f, 300.f));
+		}
+
+		FProjectileStepContext context;
+		context.Drones.CenterX = droneX.GetData();
+		context.Drones.CenterY = droneY.GetData();
+		context.Drones.CenterZ = droneZ.GetData();
+		context.Drones.UniformRadiusSquared = FMath::Square(50.f);
+		context.Drones.Num = numDrones;
+		context.WallTopHeights = wallTopHeights;
+		context.SIMD = FDroneHitProxies::IsSIMDEnabled();
+
+		FProjectileSettings settings;
+		settings.Capacity = Count;
+		FProjectileSimulation simulation;
+		simulation.Initialize(settings);
+
+		auto* instances = NewObject<UInstancedStaticMeshComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+		TArray<FTransform> transforms;
+
+		// Keep the simulation full: every projectile that stops is replaced by a new one, fired from an open cell.
+		auto spawnProjectile = [&simulation, &randomStream, &openCells]()
+		{
+			const FIntPoint cell = openCells[randomStream.RandHelper(openCells.Num())];
+			FProjectileSpawn spawn;
+			spawn.Location = AUnrealSFASMaze::CellToWorld(cell) + FVector(0.f, 0.f, 150.f);
+			spawn.Velocity = FVector(randomStream.GetUnitVector().GetSafeNormal2D() * 3000.f);
+			spawn.Lifetime = 2.f;
+			simulation.Spawn(spawn);
+		};
+
+		for (int32 i = 0; i < Count; i++)
+		{
+			spawnProjectile();
+		}
+
+		TArray<FProjectileImpact> impacts;
+		double stepSeconds = 0.0;
+		double frameSeconds = 0.0;
+		for (int32 frame = 0; frame < NumFrames; frame++)
+		{
+			const double startSeconds = FPlatformTime::Seconds();
+			simulation.Step(deltaSeconds, context, impacts);
+			const double stepEndSeconds = FPlatformTime::Seconds();
+			UpdateInstanceTransforms(*instances, simulation, transforms);
+			const double endSeconds = FPlatformTime::Seconds();
+			stepSeconds += stepEndSeconds - startSeconds;
+			frameSeconds += endSeconds - startSeconds;
+
+			for (const FProjectileImpact& impact : impacts)
+			{
+				simulation.Release(impact.Slot);
+				spawnProjectile();
+			}
+		}
+
+		instances->MarkAsGarbage();
+
+		OutStepMilliseconds = (stepSeconds * 1000.0) / NumFrames;
+		return (frameSeconds * 1000.0) / NumFrames;
+	}
+
+	/** Doubles the number of projectiles in flight until a frame of them no longer fits in a quarter of the 60 Hz frame budget. */
+	static void RunBenchmark(const TArray<FString>& Args)
+	{
+		const int32 numFrames = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 120;
+		const double frameBudgetMilliseconds = (1000.0 / 60.0) * 0.25;
+
+		int32 sustainedCount = 0;
+		for (int32 count = 1024; count <= (1 << 18); count *= 2)
+		{
+			double stepMilliseconds = 0.0;
+			const double milliseconds = MeasureFrameMilliseconds(count, numFrames, stepMilliseconds);
+			UE_LOG(LogUnrealSFAS, Display, TEXT("Projectile benchmark: %d projectiles, %.3f ms per frame (%.3f ms step, %.3f ms instance update)"),
+				count, milliseconds, stepMilliseconds, milliseconds - stepMilliseconds);
+
+			if (milliseconds > frameBudgetMilliseconds)
+			{
+				break;
+			}
+			sustainedCount = count;
+		}
+
+		UE_LOG(LogUnrealSFAS, Display, TEXT("Projectile benchmark: %d projectiles step and update their instances within a quarter of a 60 Hz frame"), sustainedCount);
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("SFAS.Projectiles.Benchmark"),
+		TEXT("Measures how many projectiles can be stepped through drones and maze walls and have their instance transforms updated within a quarter of a 60 Hz frame. ")
+		TEXT("Excludes the upload of the instances to the renderer. Optional argument: number of frames to time per projectile count."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+}
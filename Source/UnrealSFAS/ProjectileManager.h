@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ProjectileSimulation.h"
+#include "ProjectileManager.generated.h"
+
+/**
+ * Renders and applies the projectiles fired by weapons and drones that fire projectiles instead of hitscan shots. The
+ * projectiles have no actor of their own: they are stepped by a projectile simulation and drawn with a single instanced
+ * static mesh component. Hits are applied on the game thread after each step, in the same way as hitscan shots. See
+ * FProjectileSimulation for what projectiles are tested against.
+ */
+UCLASS()
+class UNREALSFAS_API AProjectileManager : public AActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Projectiles, meta = (AllowPrivateAccess = "true"))
+	class UInstancedStaticMeshComponent* Instances;
+
+public:
+	// Sets default values for this actor's properties
+	AProjectileManager();
+
+	/** Fires a projectile. Returns false if there is no free projectile slot. */
+	bool FireProjectile(const FProjectileSpawn& Spawn);
+
+	/**
+	 * Steps every projectile and applies their hits. Called every tick by the game mode. Players are the players still in the game.
+	 * The first step of player projectiles fired with an input time is tested against the drones where History says they were then.
+	 */
+	void UpdateProjectiles(float DeltaSeconds, const FDroneRegistry& Registry, const TArray<struct FDroneSightTarget>& Players, const class AUnrealSFASMaze* Maze,
+		class FDroneHitProxyHistory* History, class FShotLatencyTracker& ShotLatency);
+
+	/** Returns the number of projectiles in flight. */
+	FORCEINLINE int32 GetNumProjectiles() const { return Simulation.Num(); }
+
+protected:
+	/** Called when the game starts or when spawned. Allocates the projectile slots. */
+	void BeginPlay() override;
+
+private:
+	/** Applies the hit of each projectile that stopped this step and releases it, then ends the latency records of the projectiles fired since the last step. */
+	void ApplyImpacts(const FDroneRegistry& Registry, const TArray<struct FDroneSightTarget>& Players, class FShotLatencyTracker& ShotLatency);
+
+	/** Pushes the transform of every projectile in flight to the instanced mesh. */
+	void UpdateInstances();
+
+private:
+	FProjectileSimulation Simulation;
+
+	/** Scratch storage of the projectiles that stopped this step. */
+	TArray<FProjectileImpact> StepImpacts;
+
+	/** The slot and latency record of each timed projectile fired since the last step. Ended once the projectile has taken its first step. */
+	TArray<TPair<int32, int32>> FirstStepLatencyRecords;
+
+	/** Scratch storage of the player hit spheres. */
+	TArray<float> PlayerX;
+	TArray<float> PlayerY;
+	TArray<float> PlayerZ;
+
+	/** Scratch storage of the instance transforms. */
+	TArray<FTransform> InstanceTransforms;
+
+	/** The number of instances showing a projectile after the last update. The rest are hidden. */
+	int32 NumVisibleInstances;
+
+	///////////////////////////////////////////////
+	/** Projectiles category */
+	UPROPERTY(EditDefaultsOnly, Category = Projectiles, meta = (AllowPrivateAccess = "true"))
+	FProjectileSettings Settings;
+	///////////////////////////////////////////////
+};
@@ -0,0 +1,299 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectileSimulation.h"
+#include "UnrealSFAS.h"
+#include "UnrealSFASMaze.h"
+#include "DroneHitProxyHistory.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile step"), STAT_ProjectileStep, STATGROUP_SFASDrones);
+
+namespace ProjectileSimulation
+{
+	/** The number of projectiles each parallel task processes. */
+	constexpr int32 ChunkSize = 256;
+}
+
+FProjectileSettings::FProjectileSettings()
+{
+	// Set default member values.
+	Capacity = 4096;
+	MaxSubstepLength = 50.f;
+	PlayerHitRadius = 60.f;
+	FloorHeight = 0.f;
+}
+
+FProjectileSimulation::FProjectileSimulation()
+{
+	// Set default member values.
+	MaxSubstepLength = 50.f;
+	FloorHeight = 0.f;
+}
+
+void FProjectileSimulation::Initialize(const FProjectileSettings& Settings)
+{
+	const int32 capacity = FMath::Max(Settings.Capacity, 1);
+	MaxSubstepLength = FMath::Max(Settings.MaxSubstepLength, 1.f);
+	FloorHeight = Settings.FloorHeight;
+
+	Active.Init(false, capacity);
+	PositionX.SetNumZeroed(capacity);
+	PositionY.SetNumZeroed(capacity);
+	PositionZ.SetNumZeroed(capacity);
+	VelocityX.SetNumZeroed(capacity);
+	VelocityY.SetNumZeroed(capacity);
+	VelocityZ.SetNumZeroed(capacity);
+	TimeRemaining.SetNumZeroed(capacity);
+	Sources.Init(EHitscanShotSource::Player, capacity);
+	Shooters.Reset();
+	Shooters.SetNum(capacity);
+	Damage.SetNumZeroed(capacity);
+	InputCycles.SetNumZeroed(capacity);
+	Rewound.Init(false, capacity);
+	RewoundDroneIndices.Init(INDEX_NONE, capacity);
+	RewoundDroneDistances.SetNumZeroed(capacity);
+	Impacts.Init(EProjectileImpact::None, capacity);
+	ImpactIndices.Init(INDEX_NONE, capacity);
+
+	// Pop the lowest slots first so projectiles in flight stay near the start of the arrays.
+	FreeSlots.Reset(capacity);
+	for (int32 slot = capacity - 1; slot >= 0; slot--)
+	{
+		FreeSlots.Add(slot);
+	}
+}
+
+int32 FProjectileSimulation::Spawn(const FProjectileSpawn& Spawn)
+{
+	if (FreeSlots.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 slot = FreeSlots.Pop(false);
+	Active[slot] = true;
+	PositionX[slot] = Spawn.Location.X;
+	PositionY[slot] = Spawn.Location.Y;
+	PositionZ[slot] = Spawn.Location.Z;
+	VelocityX[slot] = Spawn.Velocity.X;
+	VelocityY[slot] = Spawn.Velocity.Y;
+	VelocityZ[slot] = Spawn.Velocity.Z;
+	TimeRemaining[slot] = Spawn.Lifetime;
+	Sources[slot] = Spawn.Source;
+	Shooters[slot] = Spawn.Shooter;
+	Damage[slot] = Spawn.Damage;
+	InputCycles[slot] = (Spawn.Source == EHitscanShotSource::Player) ? Spawn.InputCycles : 0;
+	Rewound[slot] = false;
+	Impacts[slot] = EProjectileImpact::None;
+	return slot;
+}
+
+void FProjectileSimulation::Release(int32 Slot)
+{
+	if (Active[Slot])
+	{
+		Active[Slot] = false;
+		Shooters[Slot].Reset();
+		FreeSlots.Add(Slot);
+	}
+}
+
+void FProjectileSimulation::Step(float DeltaSeconds, const FProjectileStepContext& Context, TArray<FProjectileImpact>& OutImpacts)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileStep);
+
+	OutImpacts.Reset();
+	if (Num() == 0)
+	{
+		return;
+	}
+
+	RewindFirstSteps(DeltaSeconds, Context);
+
+	// Step in parallel chunks. Each chunk only writes to its own projectiles.
+	const int32 capacity = GetCapacity();
+	const int32 numChunks = FMath::DivideAndRoundUp(capacity, ProjectileSimulation::ChunkSize);
+	ParallelFor(numChunks, [this, DeltaSeconds, &Context, capacity](int32 ChunkIndex)
+		{
+			const int32 begin = ChunkIndex * ProjectileSimulation::ChunkSize;
+			StepProcessor(begin, FMath::Min(begin + ProjectileSimulation::ChunkSize, capacity), DeltaSeconds, Context);
+		}, numChunks <= 1);
+
+	// Gather the projectiles that stopped this step.
+	for (int32 slot = 0; slot < capacity; slot++)
+	{
+		if (Active[slot] && (Impacts[slot] != EProjectileImpact::None))
+		{
+			FProjectileImpact& impact = OutImpacts.AddDefaulted_GetRef();
+			impact.Slot = slot;
+			impact.Kind = Impacts[slot];
+			impact.HitIndex = ImpactIndices[slot];
+			impact.Location = FVector(PositionX[slot], PositionY[slot], PositionZ[slot]);
+		}
+	}
+}
+
+void FProjectileSimulation::GatherTransforms(TArray<FTransform>& OutTransforms) const
+{
+	for (int32 slot = 0; slot < GetCapacity(); slot++)
+	{
+		if (Active[slot])
+		{
+			const FVector velocity(VelocityX[slot], VelocityY[slot], VelocityZ[slot]);
+			OutTransforms.Emplace(velocity.ToOrientationQuat(), FVector(PositionX[slot], PositionY[slot], PositionZ[slot]));
+		}
+	}
+}
+
+void FProjectileSimulation::RewindFirstSteps(float DeltaSeconds, const FProjectileStepContext& Context)
+{
+	const bool canRewind = Context.History && Context.Registry;
+	for (int32 slot = 0; slot < GetCapacity(); slot++)
+	{
+		if (!Active[slot] || (InputCycles[slot] == 0))
+		{
+			continue;
+		}
+
+		// The history interpolates every drone to the input time, so this runs on the game thread. The pellets of a shot share one rewind.
+		if (canRewind)
+		{
+			const FVector start(PositionX[slot], PositionY[slot], PositionZ[slot]);
+			const FVector velocity(VelocityX[slot], VelocityY[slot], VelocityZ[slot]);
+			const FVector end = start + (velocity * DeltaSeconds);
+			float distance = 0.f;
+			const FDroneHandle droneHit = Context.History->Raycast(*Context.Registry, InputCycles[slot], start, end, BIG_NUMBER, FDroneHandle(), distance);
+			Rewound[slot] = true;
+			RewoundDroneIndices[slot] = Context.Registry->GetDenseIndex(droneHit);
+			RewoundDroneDistances[slot] = distance;
+		}
+		InputCycles[slot] = 0;
+	}
+}
+
+void FProjectileSimulation::StepProcessor(int32 Begin, int32 End, float DeltaSeconds, const FProjectileStepContext& Context)
+{
+	for (int32 i = Begin; i < End; i++)
+	{
+		if (!Active[i])
+		{
+			continue;
+		}
+
+		const FVector3f start(PositionX[i], PositionY[i], PositionZ[i]);
+		const FVector3f velocity(VelocityX[i], VelocityY[i], VelocityZ[i]);
+		const FVector3f end = start + (velocity * DeltaSeconds);
+		const float length = velocity.Size() * DeltaSeconds;
+
+		EProjectileImpact impact = EProjectileImpact::None;
+		int32 impactIndex = INDEX_NONE;
+		float impactDistance = length;
+
+		if (length > KINDA_SMALL_NUMBER)
+		{
+			// Player projectiles can hit drones, tested against the whole segment at once. Drone projectiles pass through other drones.
+			// The first step of a projectile fired with an input time uses the drone the rewind found instead.
+			float distance = 0.f;
+			if (Rewound[i])
+			{
+				if ((RewoundDroneIndices[i] != INDEX_NONE) && (RewoundDroneDistances[i] <= impactDistance))
+				{
+					impact = EProjectileImpact::Drone;
+					impactIndex = RewoundDroneIndices[i];
+					impactDistance = RewoundDroneDistances[i];
+				}
+			}
+			else if (Sources[i] == EHitscanShotSource::Player)
+			{
+				const int32 droneIndex = FDroneHitProxies::RaycastAnyThread(Context.Drones, start, end, impactDistance, INDEX_NONE, Context.SIMD, distance);
+				if (droneIndex != INDEX_NONE)
+				{
+					impact = EProjectileImpact::Drone;
+					impactIndex = droneIndex;
+					impactDistance = distance;
+				}
+			}
+
+			// Drone projectiles can hit players.
+			if (Sources[i] == EHitscanShotSource::Drone)
+			{
+				const int32 playerIndex = FDroneHitProxies::RaycastAnyThread(Context.Players, start, end, impactDistance, INDEX_NONE, false, distance);
+				if (playerIndex != INDEX_NONE)
+				{
+					impact = EProjectileImpact::Player;
+					impactIndex = playerIndex;
+					impactDistance = distance;
+				}
+			}
+
+			// The floor stops a descending projectile if it is in front of anything else it hit.
+			if ((velocity.Z < 0.f) && (end.Z < FloorHeight))
+			{
+				const float floorDistance = FMath::Max((start.Z - FloorHeight) / (start.Z - end.Z), 0.f) * length;
+				if (floorDistance < impactDistance)
+				{
+					impact = EProjectileImpact::Floor;
+					impactIndex = INDEX_NONE;
+					impactDistance = floorDistance;
+				}
+			}
+
+			// Walls stop the projectile if they are in front of anything else it hit.
+			if (Context.WallTopHeights.Num() > 0)
+			{
+				const FVector3f direction = velocity.GetSafeNormal();
+				const float wallDistance = TraceMaze(start, direction, impactDistance, Context.WallTopHeights);
+				if (wallDistance < impactDistance)
+				{
+					impact = EProjectileImpact::Wall;
+					impactIndex = INDEX_NONE;
+					impactDistance = wallDistance;
+				}
+			}
+		}
+
+		// Move the projectile up to where it stopped.
+		const FVector3f location = (length > KINDA_SMALL_NUMBER) ? FMath::Lerp(start, end, impactDistance / length) : start;
+		PositionX[i] = location.X;
+		PositionY[i] = location.Y;
+		PositionZ[i] = location.Z;
+
+		TimeRemaining[i] -= DeltaSeconds;
+		if ((impact == EProjectileImpact::None) && (TimeRemaining[i] <= 0.f))
+		{
+			impact = EProjectileImpact::Expired;
+		}
+
+		Impacts[i] = impact;
+		ImpactIndices[i] = impactIndex;
+		Rewound[i] = false;
+	}
+}
+
+float FProjectileSimulation::TraceMaze(const FVector3f& Start, const FVector3f& Direction, float MaxDistance, TArrayView<const float> WallTopHeights) const
+{
+	// Walk the segment in substeps shorter than a maze block, testing the cell at the end of each substep.
+	const int32 numSubsteps = FMath::Max(FMath::CeilToInt(MaxDistance / MaxSubstepLength), 1);
+	const float substepLength = MaxDistance / numSubsteps;
+	FIntPoint previousCell(INDEX_NONE, INDEX_NONE);
+	for (int32 substep = 1; substep <= numSubsteps; substep++)
+	{
+		const float distance = substep * substepLength;
+		const FVector location(Start + (Direction * distance));
+		const FIntPoint cell = AUnrealSFASMaze::WorldToCell(location);
+
+		// Substeps in the same cell as the last one can only be under the wall top if the projectile is descending.
+		if ((cell != previousCell) || (Direction.Z < 0.f))
+		{
+			if (location.Z < AUnrealSFASMaze::GetWallTopHeight(WallTopHeights, cell))
+			{
+				// Report the start of the substep the wall was entered in, so the impact is in front of the wall.
+				return distance - substepLength;
+			}
+			previousCell = cell;
+		}
+	}
+
+	return MaxDistance;
+}
@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DroneRegistry.h"
+#include "DroneHitProxies.h"
+#include "HitscanService.h"
+#include "ProjectileSimulation.generated.h"
+
+/** How projectiles are stored and stepped. */
+USTRUCT(BlueprintType)
+struct FProjectileSettings
+{
+	GENERATED_BODY()
+
+	FProjectileSettings();
+
+	/** The most projectiles in flight at once. Projectiles fired beyond it are dropped. */
+	UPROPERTY(EditDefaultsOnly, Category = Projectiles, meta = (ClampMin = "1"))
+	int32 Capacity;
+
+	/** The longest step along a projectile's path between maze wall tests. Keep below the maze block size so walls aren't skipped. */
+	UPROPERTY(EditDefaultsOnly, Category = Projectiles, meta = (ClampMin = "1"))
+	float MaxSubstepLength;
+
+	/** The radius of the sphere used to test whether a projectile hits a player. */
+	UPROPERTY(EditDefaultsOnly, Category = Projectiles)
+	float PlayerHitRadius;
+
+	/** The height of the level floor. Projectiles that descend below it stop there. */
+	UPROPERTY(EditDefaultsOnly, Category = Projectiles)
+	float FloorHeight;
+};
+
+/** A projectile to fire. */
+struct FProjectileSpawn
+{
+	EHitscanShotSource Source = EHitscanShotSource::Player;
+
+	/** The actor that fired the projectile. */
+	TWeakObjectPtr<class AActor> Shooter;
+
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+
+	/** Seconds until the projectile expires if it hits nothing. */
+	float Lifetime = 1.f;
+
+	/** The damage dealt if the projectile hits. */
+	int32 Damage = 0;
+
+	/** When the input that fired a player projectile was received, in cycles. Its first step is tested against the drones where they were then. 0 tests where they are now. */
+	uint64 InputCycles = 0;
+
+	/** The projectile's record in the game mode's shot latency tracker, timed up to its first step. INDEX_NONE if the projectile isn't timed. */
+	int32 LatencyRecord = INDEX_NONE;
+};
+
+/** What a projectile hit this step. */
+enum class EProjectileImpact : uint8
+{
+	None,
+	Expired,
+	Wall,
+	Floor,
+	Drone,
+	Player,
+};
+
+/** A projectile that stopped this step. */
+struct FProjectileImpact
+{
+	int32 Slot;
+	EProjectileImpact Kind;
+
+	/** The dense index of the drone or the index of the player hit. */
+	int32 HitIndex;
+
+	FVector Location;
+};
+
+/** Everything a projectile step tests projectiles against. */
+struct FProjectileStepContext
+{
+	FDroneHitProxyView Drones;
+
+	/** Resolves rewound drone hits to dense indices. May be nullptr, in which case no projectile is rewound. */
+	const FDroneRegistry* Registry = nullptr;
+
+	/** Where the drones were on previous frames. May be nullptr, in which case no projectile is rewound. Only read on the game thread. */
+	class FDroneHitProxyHistory* History = nullptr;
+
+	/** Hit spheres of the players still in the game. Only drone projectiles are tested against them. */
+	FDroneHitProxyView Players;
+
+	/** The height of the top of the wall in each maze cell, laid out like AUnrealSFASMaze::GetWallTopHeights. May be empty, in which case projectiles hit no walls. */
+	TArrayView<const float> WallTopHeights;
+
+	/** Whether the ray tests run four proxies at a time. Read on the game thread. */
+	bool SIMD = true;
+};
+
+/**
+ * Projectiles with no actor of their own, stored in fixed capacity arrays with one array per attribute. Spawning pops a free
+ * slot and expiry pushes it back, so neither allocates. Each step moves every projectile in parallel chunks: the segment it
+ * travels is tested analytically against the drone hit spheres for player projectiles, the player hit spheres for drone
+ * projectiles and the floor, and walked in substeps through the maze grid to find the first wall it enters. Projectiles that
+ * hit something are reported as impacts for the caller to apply on the game thread before they are released.
+ *
+ * Drones never block another drone's projectile, matching drone hitscan shots in FHitscanService.
+ *
+ * Limits: only the first step of a player projectile fired with an input time is tested against the drones where they were
+ * at that time, on the game thread before the parallel step; later steps test the drones where they are. The floor is a single height, and other level geometry is not tested. Projectiles are only fired by
+ * weapons and drone archetypes with a projectile speed, when the game mode has a projectile manager class, and none do by default.
+ */
+class UNREALSFAS_API FProjectileSimulation
+{
+public:
+	FProjectileSimulation();
+
+	/** Sets the capacity and the substep length. Releases every projectile. */
+	void Initialize(const FProjectileSettings& Settings);
+
+	/** Fires a projectile. Returns its slot, or INDEX_NONE if every slot is in use. */
+	int32 Spawn(const FProjectileSpawn& Spawn);
+
+	/** Frees the projectile's slot. */
+	void Release(int32 Slot);
+
+	/** Moves every projectile and fills OutImpacts with the projectiles that hit something or expired. The projectiles stay in flight until released. */
+	void Step(float DeltaSeconds, const FProjectileStepContext& Context, TArray<FProjectileImpact>& OutImpacts);
+
+	/** Appends the render transform of every projectile in flight to OutTransforms. */
+	void GatherTransforms(TArray<FTransform>& OutTransforms) const;
+
+	FORCEINLINE int32 Num() const { return Active.Num() - FreeSlots.Num(); }
+	FORCEINLINE int32 GetCapacity() const { return Active.Num(); }
+	FORCEINLINE EHitscanShotSource GetSource(int32 Slot) const { return Sources[Slot]; }
+	FORCEINLINE class AActor* GetShooter(int32 Slot) const { return Shooters[Slot].Get(); }
+	FORCEINLINE int32 GetDamage(int32 Slot) const { return Damage[Slot]; }
+
+private:
+	/** Tests the first step of the player projectiles fired with an input time against the drones where they were then. */
+	void RewindFirstSteps(float DeltaSeconds, const FProjectileStepContext& Context);
+
+	/** Moves the projectiles in [Begin, End) and records what each one hit. */
+	void StepProcessor(int32 Begin, int32 End, float DeltaSeconds, const FProjectileStepContext& Context);
+
+	/** Returns the distance along the segment to the first maze wall it enters, or MaxDistance if it enters none before it. */
+	float TraceMaze(const FVector3f& Start, const FVector3f& Direction, float MaxDistance, TArrayView<const float> WallTopHeights) const;
+
+private:
+	/** Whether each slot holds a projectile in flight. */
+	TArray<bool> Active;
+
+	/** Slots available for spawning. */
+	TArray<int32> FreeSlots;
+
+	/** Transform and velocity. Components are stored in separate arrays to keep the step's memory access linear. */
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> TimeRemaining;
+
+	/** Who fired each projectile and the damage it deals. */
+	TArray<EHitscanShotSource> Sources;
+	TArray<TWeakObjectPtr<class AActor>> Shooters;
+	TArray<int32> Damage;
+
+	/** The input time each player projectile's first step is rewound to. 0 once the projectile has taken its first step. */
+	TArray<uint64> InputCycles;
+
+	/** Whether each slot's drone hit this step was found by the rewind, and the dense index of and distance to the drone it found. */
+	TArray<bool> Rewound;
+	TArray<int32> RewoundDroneIndices;
+	TArray<float> RewoundDroneDistances;
+
+	/** The result of the last step for each slot. Written by the parallel step, one entry per slot. */
+	TArray<EProjectileImpact> Impacts;
+	TArray<int32> ImpactIndices;
+
+	float MaxSubstepLength;
+	float FloorHeight;
+};
@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShotLatencyTracker.h"
+#include "UnrealSFAS.h"
+#include "UnrealSFASGameMode.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shot latency samples"), STAT_ShotLatencySamples, STATGROUP_SFASGameplay);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Shot latency to trace p50 (ms)"), STAT_ShotLatencyTraceP50, STATGROUP_SFASGameplay);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Shot latency to trace p95 (ms)"), STAT_ShotLatencyTraceP95, STATGROUP_SFASGameplay);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Shot latency to trace p99 (ms)"), STAT_ShotLatencyTraceP99, STATGROUP_SFASGameplay);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Shot latency to hit marker p50 (ms)"), STAT_ShotLatencyUIP50, STATGROUP_SFASGameplay);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Shot latency to hit marker p95 (ms)"), STAT_ShotLatencyUIP95, STATGROUP_SFASGameplay);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Shot latency to hit marker p99 (ms)"), STAT_ShotLatencyUIP99, STATGROUP_SFASGameplay);
+
+static TAutoConsoleVariable<int32> CVarShotLatencyEnabled(
+	TEXT("SFAS.ShotLatency.Enabled"),
+	1,
+	TEXT("1: player shots are timed from the fire input to the hit marker. 0: new shots are not recorded."),
+	ECVF_Default);
+
+namespace ShotLatencyTracker
+{
+	static const TCHAR* StageNames[] = { TEXT("Validated"), TEXT("Traced"), TEXT("DamageApplied"), TEXT("UIUpdated") };
+	static_assert(UE_ARRAY_COUNT(StageNames) == (int32)EShotLatencyStage::Num, "Every shot latency stage needs a name.");
+}
+
+FShotLatencyHistogram::FShotLatencyHistogram()
+{
+	Buckets.SetNumZeroed(NumBuckets + 1);
+	NumSamples = 0;
+	TotalMilliseconds = 0.0;
+	MaxMilliseconds = 0.0;
+}
+
+void FShotLatencyHistogram::Add(double Milliseconds)
+{
+	const int32 bucket = FMath::Min((int32)FMath::FloorToDouble(Milliseconds / BucketMilliseconds), NumBuckets);
+	Buckets[FMath::Max(bucket, 0)]++;
+	NumSamples++;
+	TotalMilliseconds += Milliseconds;
+	MaxMilliseconds = FMath::Max(MaxMilliseconds, Milliseconds);
+}
+
+double FShotLatencyHistogram::GetPercentile(double Percentile) const
+{
+	if (NumSamples == 0)
+	{
+		return 0.0;
+	}
+
+	// Walk the buckets until they hold the wanted share of the samples. The overflow bucket only knows the largest sample.
+	const uint64 wantedSamples = FMath::Max<uint64>((uint64)FMath::CeilToDouble(Percentile * NumSamples), 1);
+	uint64 samples = 0;
+	for (int32 bucket = 0; bucket < NumBuckets; bucket++)
+	{
+		samples += Buckets[bucket];
+		if (samples >= wantedSamples)
+		{
+			return FMath::Min((bucket + 1) * BucketMilliseconds, MaxMilliseconds);
+		}
+	}
+
+	return MaxMilliseconds;
+}
+
+void FShotLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets.GetData(), Buckets.Num() * sizeof(uint32));
+	NumSamples = 0;
+	TotalMilliseconds = 0.0;
+	MaxMilliseconds = 0.0;
+}
+
+FShotLatencyTracker::FShotLatencyTracker()
+{
+	StatsDirty = false;
+}
+
+int32 FShotLatencyTracker::BeginShot(uint64 InputCycles)
+{
+	if (!IsEnabled())
+	{
+		return INDEX_NONE;
+	}
+
+	int32 record = INDEX_NONE;
+	if (FreeRecords.Num() > 0)
+	{
+		record = FreeRecords.Pop(false);
+	}
+	else if (Records.Num() < MaxRecords)
+	{
+		record = Records.AddUninitialized();
+	}
+	else
+	{
+		return INDEX_NONE;
+	}
+
+	FRecord& shotRecord = Records[record];
+	FMemory::Memzero(shotRecord.StageCycles);
+	shotRecord.InputCycles = InputCycles;
+	shotRecord.StageCycles[(int32)EShotLatencyStage::Validated] = FPlatformTime::Cycles64();
+	shotRecord.InUse = true;
+	return record;
+}
+
+void FShotLatencyTracker::MarkStage(int32 Record, EShotLatencyStage Stage)
+{
+	if (!Records.IsValidIndex(Record) || !Records[Record].InUse)
+	{
+		return;
+	}
+
+	uint64& stageCycles = Records[Record].StageCycles[(int32)Stage];
+	if (stageCycles == 0)
+	{
+		stageCycles = FPlatformTime::Cycles64();
+	}
+}
+
+void FShotLatencyTracker::EndShot(int32 Record)
+{
+	if (!Records.IsValidIndex(Record) || !Records[Record].InUse)
+	{
+		return;
+	}
+
+	FRecord& shotRecord = Records[Record];
+	for (int32 stage = 0; stage < (int32)EShotLatencyStage::Num; stage++)
+	{
+		if (shotRecord.StageCycles[stage] != 0)
+		{
+			Histograms[stage].Add(FPlatformTime::ToMilliseconds64(shotRecord.StageCycles[stage] - shotRecord.InputCycles));
+		}
+	}
+
+	shotRecord.InUse = false;
+	FreeRecords.Add(Record);
+	StatsDirty = true;
+}
+
+void FShotLatencyTracker::UpdateStats()
+{
+	if (!StatsDirty)
+	{
+		return;
+	}
+	StatsDirty = false;
+
+	const FShotLatencyHistogram& traced = GetHistogram(EShotLatencyStage::Traced);
+	const FShotLatencyHistogram& uiUpdated = GetHistogram(EShotLatencyStage::UIUpdated);
+	SET_DWORD_STAT(STAT_ShotLatencySamples, GetHistogram(EShotLatencyStage::Validated).NumSamples);
+	SET_FLOAT_STAT(STAT_ShotLatencyTraceP50, traced.GetPercentile(0.5));
+	SET_FLOAT_STAT(STAT_ShotLatencyTraceP95, traced.GetPercentile(0.95));
+	SET_FLOAT_STAT(STAT_ShotLatencyTraceP99, traced.GetPercentile(0.99));
+	SET_FLOAT_STAT(STAT_ShotLatencyUIP50, uiUpdated.GetPercentile(0.5));
+	SET_FLOAT_STAT(STAT_ShotLatencyUIP95, uiUpdated.GetPercentile(0.95));
+	SET_FLOAT_STAT(STAT_ShotLatencyUIP99, uiUpdated.GetPercentile(0.99));
+}
+
+bool FShotLatencyTracker::WriteCSV(const FString& Filename) const
+{
+	// The percentiles of each stage.
+	FString csv = TEXT("Stage,Samples,MeanMs,P50Ms,P95Ms,P99Ms,MaxMs\n");
+	for (int32 stage = 0; stage < (int32)EShotLatencyStage::Num; stage++)
+	{
+		const FShotLatencyHistogram& histogram = Histograms[stage];
+		const double meanMilliseconds = (histogram.NumSamples > 0) ? (histogram.TotalMilliseconds / histogram.NumSamples) : 0.0;
+		csv += FString::Printf(TEXT("%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n"), ShotLatencyTracker::StageNames[stage], histogram.NumSamples, meanMilliseconds,
+			histogram.GetPercentile(0.5), histogram.GetPercentile(0.95), histogram.GetPercentile(0.99), histogram.MaxMilliseconds);
+	}
+
+	// The histogram of each stage, up to the last bucket with a sample. The overflow bucket has no upper edge.
+	int32 lastBucket = INDEX_NONE;
+	for (int32 stage = 0; stage < (int32)EShotLatencyStage::Num; stage++)
+	{
+		for (int32 bucket = FShotLatencyHistogram::NumBuckets; bucket > lastBucket; bucket--)
+		{
+			if (Histograms[stage].Buckets[bucket] > 0)
+			{
+				lastBucket = bucket;
+				break;
+			}
+		}
+	}
+
+	csv += TEXT("\nBucketUpperMs");
+	for (int32 stage = 0; stage < (int32)EShotLatencyStage::Num; stage++)
+	{
+		csv += FString::Printf(TEXT(",%s"), ShotLatencyTracker::StageNames[stage]);
+	}
+	csv += TEXT("\n");
+
+	for (int32 bucket = 0; bucket <= lastBucket; bucket++)
+	{
+		csv += (bucket < FShotLatencyHistogram::NumBuckets) ? FString::Printf(TEXT("%.2f"), (bucket + 1) * FShotLatencyHistogram::BucketMilliseconds) : FString(TEXT("Overflow"));
+		for (int32 stage = 0; stage < (int32)EShotLatencyStage::Num; stage++)
+		{
+			csv += FString::Printf(TEXT(",%u"), Histograms[stage].Buckets[bucket]);
+		}
+		csv += TEXT("\n");
+	}
+
+	return FFileHelper::SaveStringToFile(csv, *Filename);
+}
+
+void FShotLatencyTracker::LogSummary() const
+{
+	for (int32 stage = 0; stage < (int32)EShotLatencyStage::Num; stage++)
+	{
+		const FShotLatencyHistogram& histogram = Histograms[stage];
+		UE_LOG(LogUnrealSFAS, Display, TEXT("Shot latency to %s: %u samples, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms"),
+			ShotLatencyTracker::StageNames[stage], histogram.NumSamples, histogram.GetPercentile(0.5), histogram.GetPercentile(0.95),
+			histogram.GetPercentile(0.99), histogram.MaxMilliseconds);
+	}
+}
+
+void FShotLatencyTracker::Reset()
+{
+	Records.Reset();
+	FreeRecords.Reset();
+	ResetSamples();
+}
+
+void FShotLatencyTracker::ResetSamples()
+{
+	for (FShotLatencyHistogram& histogram : Histograms)
+	{
+		histogram.Reset();
+	}
+	StatsDirty = true;
+}
+
+bool FShotLatencyTracker::IsEnabled()
+{
+	return CVarShotLatencyEnabled.GetValueOnGameThread() != 0;
+}
+
+namespace ShotLatencyTracker
+{
+	/** Returns the shot latency tracker of the world's game mode, or nullptr if the game mode doesn't have one. */
+	static FShotLatencyTracker* GetTracker(UWorld* World)
+	{
+		auto* unrealSFASGameMode = World ? World->GetAuthGameMode<AUnrealSFASGameMode>() : nullptr;
+		return unrealSFASGameMode ? &unrealSFASGameMode->GetShotLatencyTracker() : nullptr;
+	}
+
+	/** Writes the session's shot latencies to a CSV file in the profiling directory. Optional argument: file name. */
+	static void DumpCSV(const TArray<FString>& Args, UWorld* World)
+	{
+		const auto* tracker = GetTracker(World);
+		if (!tracker)
+		{
+			UE_LOG(LogUnrealSFAS, Warning, TEXT("Shot latency: no game is running."));
+			return;
+		}
+
+		const FString name = (Args.Num() > 0) ? Args[0] : FString::Printf(TEXT("ShotLatency-%s.csv"), *FDateTime::Now().ToString());
+		const FString filename = FPaths::Combine(FPaths::ProfilingDir(), TEXT("ShotLatency"), name);
+		if (tracker->WriteCSV(filename))
+		{
+			UE_LOG(LogUnrealSFAS, Display, TEXT("Shot latency written to %s"), *filename);
+		}
+		else
+		{
+			UE_LOG(LogUnrealSFAS, Warning, TEXT("Shot latency: failed to write %s"), *filename);
+		}
+		tracker->LogSummary();
+	}
+
+	/** Drops the session's shot latency samples. */
+	static void ResetSamples(const TArray<FString>& Args, UWorld* World)
+	{
+		auto* tracker = GetTracker(World);
+		if (tracker)
+		{
+			tracker->ResetSamples();
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs DumpCommand(
+		TEXT("SFAS.ShotLatency.Dump"),
+		TEXT("Writes the percentiles and histograms of player shot latency this session to a CSV file in the profiling directory. Optional argument: file name."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&DumpCSV));
+
+	static FAutoConsoleCommandWithWorldAndArgs ResetCommand(
+		TEXT("SFAS.ShotLatency.Reset"),
+		TEXT("Drops the player shot latency samples recorded this session."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ResetSamples));
+}
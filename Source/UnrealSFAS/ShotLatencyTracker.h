@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** The points a player shot passes on its way from the fire input to the hit marker, each timed from the input. */
+enum class EShotLatencyStage : uint8
+{
+	/** The weapon checked it could fire and built the shot. */
+	Validated,
+
+	/** The shot's trace result was read. Shots that miss stop here. */
+	Traced,
+
+	/** The damage queue applied the shot's damage. */
+	DamageApplied,
+
+	/** The shooter's hit marker and stats were updated. */
+	UIUpdated,
+
+	Num
+};
+
+/** The latencies recorded for one stage, bucketed so percentiles can be read without keeping every sample. */
+struct FShotLatencyHistogram
+{
+	FShotLatencyHistogram();
+
+	/** Adds a sample. Samples past the last bucket are counted in an overflow bucket. */
+	void Add(double Milliseconds);
+
+	/** Returns the latency under which Percentile of the samples fall, to the bucket's upper edge. 0 if there are no samples. */
+	double GetPercentile(double Percentile) const;
+
+	void Reset();
+
+	/** The width of each bucket and the number of buckets before the overflow bucket. */
+	static constexpr double BucketMilliseconds = 0.25;
+	static constexpr int32 NumBuckets = 800;
+
+	/** NumBuckets buckets followed by the overflow bucket. */
+	TArray<uint32> Buckets;
+	uint32 NumSamples;
+	double TotalMilliseconds;
+	double MaxMilliseconds;
+};
+
+/**
+ * Measures how long player shots take from the fire input to the hit marker, across the whole session.
+ * A record is started for each pellet when the weapon fires, and its id travels with the shot through the hitscan service or
+ * projectile manager and the damage queue, which timestamp each stage it reaches. The latency of each stage from the input is added to
+ * that stage's histogram when the record ends, and the percentiles are published as stats and can be dumped to CSV.
+ * Shots fired while the trigger is held, and the later shots of a burst, are timed from when they came due instead of from the
+ * input. Projectile records end once the projectile has taken its first step, since their flight time is not latency. Game
+ * thread only.
+ */
+class UNREALSFAS_API FShotLatencyTracker
+{
+public:
+	FShotLatencyTracker();
+
+	/** Starts a record for a shot whose input was received at InputCycles, and marks it validated. Returns INDEX_NONE if recording is disabled or full. */
+	int32 BeginShot(uint64 InputCycles);
+
+	/** Marks the time the record reached Stage. Only the first mark of each stage counts. Does nothing for INDEX_NONE. */
+	void MarkStage(int32 Record, EShotLatencyStage Stage);
+
+	/** Adds the stages the record reached to the histograms and frees the record. Does nothing for INDEX_NONE. */
+	void EndShot(int32 Record);
+
+	/** Publishes the percentiles as stats if samples were added since the last call. */
+	void UpdateStats();
+
+	/** Writes each stage's percentiles followed by the histograms to a CSV file. Returns whether the file was written. */
+	bool WriteCSV(const FString& Filename) const;
+
+	/** Logs each stage's sample count and percentiles. */
+	void LogSummary() const;
+
+	/** Drops the records in flight and every sample. */
+	void Reset();
+
+	/** Drops every sample, keeping the records in flight. */
+	void ResetSamples();
+
+	FORCEINLINE const FShotLatencyHistogram& GetHistogram(EShotLatencyStage Stage) const { return Histograms[(int32)Stage]; }
+
+	/** Returns whether new shots are recorded. Set by the SFAS.ShotLatency.Enabled console variable. */
+	static bool IsEnabled();
+
+	/** The most shots in flight at once. Shots fired beyond this aren't recorded. */
+	static constexpr int32 MaxRecords = 4096;
+
+private:
+	/** A shot in flight. A stage's cycles are 0 until it is reached. */
+	struct FRecord
+	{
+		uint64 InputCycles;
+		uint64 StageCycles[(int32)EShotLatencyStage::Num];
+		bool InUse;
+	};
+
+	TArray<FRecord> Records;
+	TArray<int32> FreeRecords;
+
+	FShotLatencyHistogram Histograms[(int32)EShotLatencyStage::Num];
+
+	/** Whether samples were added since the stats were last published. */
+	bool StatsDirty;
+};
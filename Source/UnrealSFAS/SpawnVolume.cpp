@@ -3,6 +3,7 @@
 
 #include "SpawnVolume.h"
 #include "Components/BoxComponent.h"
+#include "GameCollisionDefinitions.h"
 
 // Sets default values
 ASpawnVolume::ASpawnVolume()
@@ -13,4 +14,8 @@ ASpawnVolume::ASpawnVolume()
 	// Setup box component.
 	Volume = CreateDefaultSubobject<UBoxComponent>(TEXT("BoxVolume"));
 	RootComponent = Volume;
+	// The volume only marks where drones spawn, so it doesn't stop shots, drone sight or the drones themselves.
+	Volume->SetCollisionResponseToChannel(COLLISION_SHOT, ECR_Ignore);
+	Volume->SetCollisionResponseToChannel(COLLISION_SIGHT, ECR_Ignore);
+	Volume->SetCollisionResponseToChannel(COLLISION_DRONE, ECR_Ignore);
 }
@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TimingWheel.h"
+#include "UnrealSFAS.h"
+
+DECLARE_CYCLE_STAT(TEXT("Timing wheel tick"), STAT_TimingWheelTick, STATGROUP_SFASGameplay);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gameplay timers active"), STAT_TimingWheelActive, STATGROUP_SFASGameplay);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gameplay timers expired"), STAT_TimingWheelExpired, STATGROUP_SFASGameplay);
+
+FTimingWheel::FTimingWheel()
+{
+	// Set default member values. 10 ms ticks give the wheels a range of about 46 hours.
+	SecondsPerTick = 0.01;
+	NextGeneration = 0;
+	Reset();
+}
+
+FTimingWheelHandle FTimingWheel::SetTimer(float DelaySeconds, FTimingWheelCallback Callback, UObject* Context, int32 Payload)
+{
+	FTimingWheelHandle handle;
+	if (!Callback)
+	{
+		return handle;
+	}
+
+	// Reuse a free timer before growing the pool.
+	int32 index = FreeHead;
+	if (index != INDEX_NONE)
+	{
+		FreeHead = Timers[index].Next;
+	}
+	else
+	{
+		index = Timers.AddDefaulted();
+	}
+
+	// The delay is counted from now, which is part way through the current tick. Expire in the tick it ends in, and never in the
+	// current tick, which has already been expired.
+	const double delayTicks = FMath::CeilToDouble((TickRemainder + FMath::Max(DelaySeconds, 0.f)) / SecondsPerTick);
+	const uint64 clampedDelayTicks = FMath::Clamp<uint64>((uint64)delayTicks, 1, MaxDelayTicks);
+
+	FTimer& timer = Timers[index];
+	timer.ExpireTick = CurrentTick + clampedDelayTicks;
+	timer.Callback = Callback;
+	timer.Context = Context;
+	timer.Payload = Payload;
+	timer.Generation = ++NextGeneration;
+	Link(index);
+	NumActiveTimers++;
+
+	handle.Index = index;
+	handle.Generation = timer.Generation;
+	return handle;
+}
+
+void FTimingWheel::ClearTimer(FTimingWheelHandle& Handle)
+{
+	if (IsTimerActive(Handle))
+	{
+		Unlink(Handle.Index);
+		Release(Handle.Index);
+	}
+
+	Handle = FTimingWheelHandle();
+}
+
+bool FTimingWheel::IsTimerActive(const FTimingWheelHandle& Handle) const
+{
+	return Timers.IsValidIndex(Handle.Index) && (Timers[Handle.Index].Generation == Handle.Generation) && (Timers[Handle.Index].Slot != INDEX_NONE);
+}
+
+void FTimingWheel::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TimingWheelTick);
+
+	int32 numExpired = 0;
+	TickRemainder += FMath::Max(DeltaSeconds, 0.f);
+	while (TickRemainder >= SecondsPerTick)
+	{
+		TickRemainder -= SecondsPerTick;
+		CurrentTick++;
+
+		// When a wheel turns over, move the next slot of the wheel above down into it.
+		for (int32 level = 1; level < NumLevels; level++)
+		{
+			if ((CurrentTick & ((1ull << (BitsPerLevel * level)) - 1)) != 0)
+			{
+				break;
+			}
+			Cascade(level);
+		}
+
+		// Expire every timer in the due slot. Each is released before it is called, so the callback can set its timer again.
+		// Timers set by a callback expire in a later tick, and timers it clears are unlinked from this slot before they are reached.
+		int32& head = Slots[CurrentTick & (SlotsPerLevel - 1)];
+		while (head != INDEX_NONE)
+		{
+			const int32 index = head;
+			const FTimingWheelCallback callback = Timers[index].Callback;
+			auto* context = Timers[index].Context.Get();
+			const int32 payload = Timers[index].Payload;
+			Unlink(index);
+			Release(index);
+			numExpired++;
+
+			if (context)
+			{
+				callback(context, payload);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_TimingWheelActive, NumActiveTimers);
+	SET_DWORD_STAT(STAT_TimingWheelExpired, numExpired);
+}
+
+void FTimingWheel::Reset()
+{
+	Timers.Reset();
+	FreeHead = INDEX_NONE;
+	for (int32& slot : Slots)
+	{
+		slot = INDEX_NONE;
+	}
+	CurrentTick = 0;
+	TickRemainder = 0.0;
+	NumActiveTimers = 0;
+}
+
+void FTimingWheel::Link(int32 Index)
+{
+	FTimer& timer = Timers[Index];
+
+	// Find the lowest wheel whose span covers how far away the timer expires, and the slot its expiry tick falls in.
+	const uint64 ticksAway = timer.ExpireTick - CurrentTick;
+	int32 level = 0;
+	while ((level < (NumLevels - 1)) && (ticksAway >= (1ull << (BitsPerLevel * (level + 1)))))
+	{
+		level++;
+	}
+	const int32 slot = (level * SlotsPerLevel) + (int32)((timer.ExpireTick >> (BitsPerLevel * level)) & (SlotsPerLevel - 1));
+
+	timer.Slot = slot;
+	timer.Prev = INDEX_NONE;
+	timer.Next = Slots[slot];
+	if (timer.Next != INDEX_NONE)
+	{
+		Timers[timer.Next].Prev = Index;
+	}
+	Slots[slot] = Index;
+}
+
+void FTimingWheel::Unlink(int32 Index)
+{
+	FTimer& timer = Timers[Index];
+	if (timer.Prev != INDEX_NONE)
+	{
+		Timers[timer.Prev].Next = timer.Next;
+	}
+	else
+	{
+		Slots[timer.Slot] = timer.Next;
+	}
+
+	if (timer.Next != INDEX_NONE)
+	{
+		Timers[timer.Next].Prev = timer.Prev;
+	}
+}
+
+void FTimingWheel::Release(int32 Index)
+{
+	FTimer& timer = Timers[Index];
+	timer.Slot = INDEX_NONE;
+	timer.Context.Reset();
+	timer.Prev = INDEX_NONE;
+	timer.Next = FreeHead;
+	FreeHead = Index;
+	NumActiveTimers--;
+}
+
+void FTimingWheel::Cascade(int32 Level)
+{
+	// Detach the slot's list, then link each timer again. They are all now close enough to land in a lower wheel.
+	const int32 slot = (Level * SlotsPerLevel) + (int32)((CurrentTick >> (BitsPerLevel * Level)) & (SlotsPerLevel - 1));
+	int32 index = Slots[slot];
+	Slots[slot] = INDEX_NONE;
+	while (index != INDEX_NONE)
+	{
+		const int32 next = Timers[index].Next;
+		Link(index);
+		index = next;
+	}
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Called when a timer expires with the object and value it was set with. Not called if the object has been destroyed. */
+typedef void (*FTimingWheelCallback)(UObject* Context, int32 Payload);
+
+/** Identifies a timer set on a timing wheel. Stays safe to clear after the timer has expired or the wheel has been reset. */
+struct FTimingWheelHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+};
+
+/**
+ * Runs the short-lived gameplay timers, such as hit markers, wave notifications and pickup lifetimes, in place of the world
+ * timer manager. Time is split into ticks of SecondsPerTick, and timers are kept in intrusive lists in the slots of four wheels
+ * of 64 slots each: the first wheel holds the timers due in the next 64 ticks, and each wheel after covers 64 times the span of
+ * the one before. Setting and clearing a timer is O(1). Each tick the due slot of the first wheel is expired as a batch, and when
+ * the first wheel turns over the next slot of the wheel above is moved down into it. Timers live in a pool reused through a free
+ * list, so setting a timer allocates nothing once the pool has grown to the most timers active at once.
+ */
+class UNREALSFAS_API FTimingWheel
+{
+public:
+	FTimingWheel();
+
+	/** Sets a timer that calls Callback with Context and Payload after DelaySeconds of game time, rounded up to the next tick. */
+	FTimingWheelHandle SetTimer(float DelaySeconds, FTimingWheelCallback Callback, UObject* Context, int32 Payload = 0);
+
+	/** Clears the timer if it is still active, and unsets the handle. */
+	void ClearTimer(FTimingWheelHandle& Handle);
+
+	/** Returns whether the timer is waiting to expire. */
+	bool IsTimerActive(const FTimingWheelHandle& Handle) const;
+
+	/** Advances the wheel by DeltaSeconds and calls every timer that expired. Called every tick by the game mode. */
+	void Tick(float DeltaSeconds);
+
+	/** Drops every timer without calling them. */
+	void Reset();
+
+	/** Returns the number of timers waiting to expire. */
+	FORCEINLINE int32 NumActive() const { return NumActiveTimers; }
+
+private:
+	static constexpr int32 BitsPerLevel = 6;
+	static constexpr int32 SlotsPerLevel = 1 << BitsPerLevel;
+	static constexpr int32 NumLevels = 4;
+
+	/** The longest delay in ticks. Longer timers are clamped to it. */
+	static constexpr uint64 MaxDelayTicks = (1ull << (BitsPerLevel * NumLevels)) - 1;
+
+	/** A timer in the pool. Timers in the same slot are linked through Prev and Next. Free timers are linked through Next. */
+	struct FTimer
+	{
+		uint64 ExpireTick;
+		FTimingWheelCallback Callback;
+		TWeakObjectPtr<UObject> Context;
+		int32 Payload;
+		uint32 Generation;
+		int32 Prev;
+		int32 Next;
+
+		/** The slot the timer is linked into. INDEX_NONE while the timer is free. */
+		int32 Slot;
+	};
+
+	/** Links the timer into the slot of the wheel that covers how far away it expires. */
+	void Link(int32 Index);
+
+	/** Removes the timer from its slot. */
+	void Unlink(int32 Index);
+
+	/** Returns the timer to the pool. Handles to it stop being active. */
+	void Release(int32 Index);
+
+	/** Moves the timers in the current slot of the wheel at Level down to the wheels below. */
+	void Cascade(int32 Level);
+
+private:
+	TArray<FTimer> Timers;
+	int32 FreeHead;
+
+	/** The first timer of each slot of each wheel, at (level * SlotsPerLevel) + slot. */
+	int32 Slots[NumLevels * SlotsPerLevel];
+
+	/** The length of a tick. Timers expire at most this late. */
+	double SecondsPerTick;
+
+	/** The ticks elapsed, and the time elapsed since the last tick. */
+	uint64 CurrentTick;
+	double TickRemainder;
+
+	/** Never reused, so a handle can't match a timer set after it was cleared. */
+	uint32 NextGeneration;
+
+	int32 NumActiveTimers;
+};
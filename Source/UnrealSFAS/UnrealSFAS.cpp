@@ -3,5 +3,7 @@
 #include "UnrealSFAS.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogUnrealSFAS);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, UnrealSFAS, "UnrealSFAS" );
  
\ No newline at end of file
@@ -3,3 +3,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogUnrealSFAS, Log, All);
+
+/** Stats for the drone batch systems. Shown in game with "stat SFASDrones". */
+DECLARE_STATS_GROUP(TEXT("SFAS Drones"), STATGROUP_SFASDrones, STATCAT_Advanced);
+
+/** Stats for the player and gameplay systems. Shown in game with "stat SFASGameplay". */
+DECLARE_STATS_GROUP(TEXT("SFAS Gameplay"), STATGROUP_SFASGameplay, STATCAT_Advanced);
@@ -11,14 +11,14 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/GameplayStatics.h"
 #include "Weapon.h"
-#include "Perception/AIPerceptionStimuliSourceComponent.h"
-#include "Perception/AISenseConfig_Sight.h"
-#include "Perception/AIPerceptionSystem.h"
 #include "UnrealSFASPlayerController.h"
 #include "GameUI.h"
 #include "DroneCharacter.h"
 #include "Pause/PauseUserWidget.h"
 #include "UnrealSFASGameMode.h"
+#include "ProjectileManager.h"
+#include "GameCollisionDefinitions.h"
+#include "CameraRigComponent.h"
 
 //////////////////////////////////////////////////////////////////////////
 // AUnrealSFASCharacter
@@ -54,12 +54,8 @@ AUnrealSFASCharacter::AUnrealSFASCharacter()
 	CameraBoom->bUsePawnControlRotation = true; // Rotate the arm based on the controller
 	CameraBoom->TargetOffset.Z = 65.0f;
 
-	// Initialise TargetBoomLength to CameraBoom->TargetArmLength's default length
+	// Store CameraBoom->TargetArmLength's default length
 	DefaultBoomLength = CameraBoom->TargetArmLength;
-	TargetBoomLength = DefaultBoomLength;
-
-	// Initialise TargetCameraOffset to CameraBoom's socket offset
-	TargetCameraOffset = CameraBoom->SocketOffset;
 
 	// Create a follow camera
 	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
@@ -69,17 +65,17 @@ AUnrealSFASCharacter::AUnrealSFASCharacter()
 
 	DefaultCameraRelativeLocation = FollowCamera->GetRelativeLocation();
 
+	// Create the camera rig that moves the boom and view pitch limits between stances
+	CameraRig = CreateDefaultSubobject<UCameraRigComponent>(TEXT("CameraRig"));
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named MyCharacter (to avoid direct content references in C++)
 
-	// Create AI stimuli source component
-	AiStimuliSource = CreateDefaultSubobject<UAIPerceptionStimuliSourceComponent>(TEXT("SightStimuliSource"));
-
 	// Add "Player" tag to actor
 	Tags.Add(FName("Player"));
 
-	// Set collision response to visibility channel to block.
-	GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
+	// Set collision response to the shot channel to block, so drone shots hit the player's capsule.
+	GetCapsuleComponent()->SetCollisionResponseToChannel(COLLISION_SHOT, ECollisionResponse::ECR_Block);
 
 	// Enable custom depth stencil render on the player's mesh. This is used to mask the player in a post process material.
 	GetMesh()->SetRenderCustomDepth(true);
@@ -98,9 +94,10 @@ AUnrealSFASCharacter::AUnrealSFASCharacter()
 	CameraAimOffset = FVector(0.f, 50.f, 50.f);
 	CameraAimMinPitch = -35.f;
 	CameraAimMaxPitch = 35.f;
-	TargetViewPitchMin = 0.f;
-	TargetViewPitchMax = 0.f;
-	GameSecondsAtLastShot = 0.f;
+	NextShotGameSeconds = 0.0;
+	QueuedShots = 0;
+	FireHeld = false;
+	FireInputCycles = 0;
 	AimMaxWalkSpeed = 275.f;
 	MovingAccuracyDecreaseScale = 1.f;
 	Aiming = false;
@@ -129,18 +126,16 @@ void AUnrealSFASCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Register AI stimuli source as a sight source
-	AiStimuliSource->bAutoRegister = true;
-	AiStimuliSource->RegisterForSense(UAISense_Sight::StaticClass());
+	// Start the camera rig from the boom's default placement.
+	CameraRig->Initialize(CameraBoom, FollowCamera, CameraZoomSpeed, CameraMoveSpeed, ViewPitchAdjustSpeed);
 }
 
 void AUnrealSFASCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	UpdateCameraZoom(DeltaTime);
-	UpdateCameraLocationOffset(DeltaTime);
-	UpdateViewPitch(DeltaTime);
+	// Fire the shots of held triggers and bursts that have come due.
+	UpdateWeaponFire();
 
 	// Calculate accuracy offset based on velocity. Standing still is 0, moving is up to max aim offset
 	Accuracy = GetVelocity().Size() * MovingAccuracyDecreaseScale;
@@ -155,20 +150,14 @@ void AUnrealSFASCharacter::Tick(float DeltaTime)
 			auto* gameUI = unrealSFASController->GetGameUI();
 			if (gameUI)
 			{
-				gameUI->UpdateReticleTargetPosition(FMath::GetMappedRangeValueClamped(
+				// The widget eases the reticle to the target spread as it ticks.
+				gameUI->GetViewModel().SetReticleTargetOffset(FMath::GetMappedRangeValueClamped(
 					FVector2D(0.f, GetCharacterMovement()->MaxWalkSpeed * MovingAccuracyDecreaseScale),
 					FVector2D(0.f, gameUI->GetMaxReticleSlateUnitOffset()),
 					Accuracy));
-				gameUI->InterpReticleToTargetPosition(DeltaTime);
 			}
 		}
 	}
-
-	// Force follow camera to look at the capsule component when the player has been defeated.
-	if (Hitpoints <= 0)
-	{
-		FollowCamera->SetWorldRotation(UKismetMathLibrary::FindLookAtRotation(FollowCamera->GetComponentLocation(), GetCapsuleComponent()->GetComponentLocation()));
-	}
 }
 
 float AUnrealSFASCharacter::GetPitchOffset() const
@@ -199,56 +188,20 @@ void AUnrealSFASCharacter::SpawnWeapon(UGameUI* GameUI)
 				// Update game ui
 				if (GameUI)
 				{
-					GameUI->SetWeaponRoundsRemaining(Weapon->GetRoundsRemaining());
-					GameUI->SetWeaponClipSize(Weapon->GetClipCapacity());
+					GameUI->GetViewModel().SetRoundsRemaining(Weapon->GetRoundsRemaining());
+					GameUI->GetViewModel().SetClipSize(Weapon->GetClipCapacity());
 				}
 			}
 		}
 	}
 }
 
-void AUnrealSFASCharacter::UpdateCameraZoom(const float DeltaTime)
-{
-	// If CameraBoom's target arm length is not nearly equal to target camera boom length
-	if (!FMath::IsNearlyEqual(CameraBoom->TargetArmLength, TargetBoomLength, 1.f))
-	{
-		// Smoothly interpolate CameraBoom's target arm length towards the target camera boom length
-		CameraBoom->TargetArmLength = FMath::FInterpTo(CameraBoom->TargetArmLength, TargetBoomLength, DeltaTime, CameraZoomSpeed);
-	}
-}
-
-void AUnrealSFASCharacter::UpdateCameraLocationOffset(const float DeltaTime)
-{
-	// If CameraBoom's socket offset does not equal the target camera offset
-	if (CameraBoom->SocketOffset != TargetCameraOffset)
-	{
-		// Smoothly interpolate CameraBoom's socket offset to the target camera offset
-		CameraBoom->SocketOffset = FMath::VInterpTo(CameraBoom->SocketOffset, TargetCameraOffset, DeltaTime, CameraMoveSpeed);
-	}
-}
-
-void AUnrealSFASCharacter::UpdateViewPitch(const float DeltaTime)
-{
-	if (CameraManager)
-	{
-		if (!FMath::IsNearlyEqual(CameraManager->ViewPitchMin, TargetViewPitchMin, 1.f))
-		{
-			CameraManager->ViewPitchMin = FMath::FInterpTo(CameraManager->ViewPitchMin, TargetViewPitchMin, DeltaTime, ViewPitchAdjustSpeed);
-		}
-
-		if (!FMath::IsNearlyEqual(CameraManager->ViewPitchMax, TargetViewPitchMax, 1.f))
-		{
-			CameraManager->ViewPitchMax = FMath::FInterpTo(CameraManager->ViewPitchMax, TargetViewPitchMax, DeltaTime, ViewPitchAdjustSpeed);
-		}
-	}
-}
-
 void AUnrealSFASCharacter::SwapAimingShoulder()
 {
 	if (AimingOverRightShoulder)
 	{
 		// Swap to over left shoulder
-		TargetCameraOffset.Y = -CameraAimOffset.Y;
+		CameraRig->SetSocketOffsetTargetY(-CameraAimOffset.Y);
 		FVector camRelLoc = FollowCamera->GetRelativeLocation();
 		FollowCamera->SetRelativeLocation(FVector(camRelLoc.X, -camRelLoc.Y, camRelLoc.Z));
 		GetMesh()->SetRelativeScale3D(FVector(-1.f, 1.f, 1.f));
@@ -262,7 +215,7 @@ void AUnrealSFASCharacter::SwapAimingShoulder()
 	else
 	{
 		// Swap to over right shoulder
-		TargetCameraOffset.Y = CameraAimOffset.Y;
+		CameraRig->SetSocketOffsetTargetY(CameraAimOffset.Y);
 		GetMesh()->SetRelativeScale3D(FVector(1.f, 1.f, 1.f));
 		FollowCamera->SetRelativeLocation(DefaultCameraRelativeLocation);
 		AimingOverRightShoulder = true;
@@ -336,13 +289,18 @@ bool AUnrealSFASCharacter::IsGamePaused() const
 void AUnrealSFASCharacter::ShowHitMarker()
 {
 	auto* UnrealSFASPlayerController = CastChecked<AUnrealSFASPlayerController>(Controller);
-	UnrealSFASPlayerController->GetGameUI()->SetHitMarkerVisibility(true);
+	UnrealSFASPlayerController->GetGameUI()->GetViewModel().SetHitMarkerVisible(true);
+}
+
+void AUnrealSFASCharacter::OnHitMarkerTimerExpired(UObject* Context, int32 Payload)
+{
+	CastChecked<AUnrealSFASCharacter>(Context)->HideHitMarker();
 }
 
 void AUnrealSFASCharacter::HideHitMarker()
 {
 	auto* UnrealSFASPlayerController = CastChecked<AUnrealSFASPlayerController>(Controller);
-	UnrealSFASPlayerController->GetGameUI()->SetHitMarkerVisibility(false);
+	UnrealSFASPlayerController->GetGameUI()->GetViewModel().SetHitMarkerVisible(false);
 }
 
 void AUnrealSFASCharacter::OnPlayerDefeated()
@@ -357,9 +315,9 @@ void AUnrealSFASCharacter::OnPlayerDefeated()
 		GetMesh()->SetSimulatePhysics(true);
 		GetMesh()->SetCollisionEnabled(ECollisionEnabled::PhysicsOnly);
 
-		// Set target camera offsets to be above and away from the player.
-		TargetCameraOffset = DefeatedTargetCameraOffset;
-		TargetBoomLength = DefeatedTargetCameraBoomLength;
+		// Set target camera offsets to be above and away from the player, and look down at the player.
+		CameraRig->SetBoomTarget(DefeatedTargetCameraBoomLength, DefeatedTargetCameraOffset);
+		CameraRig->SetLookAtTarget(GetCapsuleComponent());
 
 		// Stop the character moving.
 		GetCharacterMovement()->MaxWalkSpeed = 0.f;
@@ -367,9 +325,6 @@ void AUnrealSFASCharacter::OnPlayerDefeated()
 		// Disable collision with the player capsule.
 		GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
-		// Unregister the player from the AI sight sense.
-		AiStimuliSource->UnregisterFromSense(UAISense_Sight::StaticClass());
-
 		// Check the world is valid.
 		auto* world = GetWorld();
 		if (world)
@@ -390,7 +345,7 @@ void AUnrealSFASCharacter::OnPlayerDefeated()
 			unrealSFASPlayerController->GetGameUI()->Show(false);
 
 			// Show the game over UI.
-			unrealSFASPlayerController->SpawnGameOverUI(NumberOfEnemiesDefeated, DamageDealt);
+			unrealSFASPlayerController->ShowGameOverUI(NumberOfEnemiesDefeated, DamageDealt);
 
 			// Notify the game mode a player has been defeated.
 			auto* unrealSFASGameMode = CastChecked<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(world));
@@ -407,7 +362,7 @@ void AUnrealSFASCharacter::UpdateHitpointsUI()
 	{
 		// Set the new HP value.
 		auto* unrealSFASPlayerController = CastChecked<AUnrealSFASPlayerController>(UGameplayStatics::GetPlayerController(world, PlayerIndex));
-		unrealSFASPlayerController->GetGameUI()->SetHitpointsValue(Hitpoints);
+		unrealSFASPlayerController->GetGameUI()->GetViewModel().SetHitpoints(Hitpoints);
 	}
 }
 
@@ -441,13 +396,30 @@ void AUnrealSFASCharacter::ReturnToMainMenu()
 }
 
 void AUnrealSFASCharacter::RecieveDamage(int Amount)
+{
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		unrealSFASGameMode->GetDamageQueue().QueueDamage(this, Amount);
+	}
+}
+
+bool AUnrealSFASCharacter::ApplyQueuedDamage(int Amount)
+{
+	// Apply damage, ensuring hitpoints cannot exceed maximum.
+	Hitpoints = FMath::Clamp(Hitpoints - Amount, 0, MaximumHitpoints);
+
+	return Hitpoints == 0;
+}
+
+void AUnrealSFASCharacter::PlayDamageEffects(int Damage, int Healing, bool WasDefeated)
 {
 	// Check the world is valid.
 	auto* world = GetWorld();
 	if (world)
 	{
-		// Check if the incoming damage is negative.
-		if (Amount < 0)
+		// Check if the player was healed.
+		if (Healing > 0)
 		{
 			// Play healing sound.
 			if (HealingSound)
@@ -455,7 +427,9 @@ void AUnrealSFASCharacter::RecieveDamage(int Amount)
 				UGameplayStatics::PlaySoundAtLocation(world, HealingSound, GetActorLocation());
 			}
 		}
-		else
+
+		// Check if the player was damaged.
+		if (Damage > 0)
 		{
 			// Play impact sound.
 			if (BulletImpactSound)
@@ -473,11 +447,8 @@ void AUnrealSFASCharacter::RecieveDamage(int Amount)
 		}
 	}
 
-	// Apply damage, ensuring hitpoints cannot exceed maximum.
-	Hitpoints = FMath::Clamp(Hitpoints -= Amount, 0, MaximumHitpoints);
-
 	// Check if the player has been defeated.
-	if (Hitpoints == 0)
+	if (WasDefeated)
 	{
 		OnPlayerDefeated();
 	}
@@ -501,10 +472,10 @@ void AUnrealSFASCharacter::OnFinishedReload()
 			auto* gameUI = sfasPC->GetGameUI();
 			if (gameUI)
 			{
-				gameUI->SetWeaponRoundsRemaining(Weapon->GetRoundsRemaining());
+				gameUI->GetViewModel().SetRoundsRemaining(Weapon->GetRoundsRemaining());
 
 				// Hide reload prompt.
-				gameUI->ShowReloadPrompt(false);
+				gameUI->GetViewModel().SetReloadPromptVisible(false);
 			}
 		}
 	}
@@ -524,6 +495,7 @@ void AUnrealSFASCharacter::SetupPlayerInputComponent(class UInputComponent* Play
 	PlayerInputComponent->BindAction("Aim", IE_Pressed, this, &AUnrealSFASCharacter::AimWeapon);
 	PlayerInputComponent->BindAction("Aim", IE_Released, this, &AUnrealSFASCharacter::StopAimingWeapon);
 	PlayerInputComponent->BindAction("FireWeapon", IE_Pressed, this, &AUnrealSFASCharacter::FireWeapon);
+	PlayerInputComponent->BindAction("FireWeapon", IE_Released, this, &AUnrealSFASCharacter::StopFiringWeapon);
 	PlayerInputComponent->BindAction("SwapShoulder", IE_Pressed, this, &AUnrealSFASCharacter::SwapShoulder);
 	PlayerInputComponent->BindAction("ReloadWeapon", IE_Pressed, this, &AUnrealSFASCharacter::ReloadWeapon);
 
@@ -573,8 +545,7 @@ void AUnrealSFASCharacter::SetupOnPossessed()
 		{
 			DefaultViewMinPitch = CameraManager->ViewPitchMin;
 			DefaultViewMaxPitch = CameraManager->ViewPitchMax;
-			TargetViewPitchMin = DefaultViewMinPitch;
-			TargetViewPitchMax = DefaultViewMaxPitch;
+			CameraRig->SetCameraManager(CameraManager);
 		}
 	}
 }
@@ -615,11 +586,9 @@ void AUnrealSFASCharacter::AimWeapon()
 	if (!Defeated)
 	{
 		Aiming = true;
-		TargetBoomLength = AimBoomLength;
-		TargetCameraOffset = CameraAimOffset;
+		CameraRig->SetBoomTarget(AimBoomLength, CameraAimOffset);
+		CameraRig->SetViewPitchTarget(CameraAimMinPitch, CameraAimMaxPitch);
 		AimBlendWeight = 1.f;
-		TargetViewPitchMin = CameraAimMinPitch;
-		TargetViewPitchMax = CameraAimMaxPitch;
 		GetCharacterMovement()->MaxWalkSpeed = AimMaxWalkSpeed;
 		bUseControllerRotationYaw = true;
 
@@ -632,7 +601,7 @@ void AUnrealSFASCharacter::AimWeapon()
 				auto* gameUI = unrealSFASController->GetGameUI();
 				if (gameUI)
 				{
-					gameUI->SetReticleVisibility(true);
+					gameUI->GetViewModel().SetReticleVisible(true);
 				}
 			}
 		}
@@ -644,11 +613,9 @@ void AUnrealSFASCharacter::StopAimingWeapon()
 	if (!Defeated)
 	{
 		Aiming = false;
-		TargetBoomLength = DefaultBoomLength;
-		TargetCameraOffset = FVector::ZeroVector;
+		CameraRig->SetBoomTarget(DefaultBoomLength, FVector::ZeroVector);
+		CameraRig->SetViewPitchTarget(DefaultViewMinPitch, DefaultViewMaxPitch);
 		AimBlendWeight = 0.f;
-		TargetViewPitchMin = DefaultViewMinPitch;
-		TargetViewPitchMax = DefaultViewMaxPitch;
 		GetCharacterMovement()->MaxWalkSpeed = DefaultMaxWalkSpeed;
 		bUseControllerRotationYaw = false;
 		if (!AimingOverRightShoulder)
@@ -665,7 +632,7 @@ void AUnrealSFASCharacter::StopAimingWeapon()
 				auto* gameUI = unrealSFASController->GetGameUI();
 				if (gameUI)
 				{
-					gameUI->SetReticleVisibility(false);
+					gameUI->GetViewModel().SetReticleVisible(false);
 				}
 			}
 		}
@@ -674,6 +641,12 @@ void AUnrealSFASCharacter::StopAimingWeapon()
 
 void AUnrealSFASCharacter::FireWeapon()
 {
+	// Time the press from when the viewport received it, if the player controller recorded it.
+	auto* unrealSFASPlayerController = Cast<AUnrealSFASPlayerController>(Controller);
+	const uint64 receivedCycles = unrealSFASPlayerController ? unrealSFASPlayerController->ConsumeFireInputCycles() : 0;
+	const uint64 inputCycles = (receivedCycles != 0) ? receivedCycles : FPlatformTime::Cycles64();
+	FireHeld = true;
+
 	// Is the player aiming and the weapon reference is valid?
 	if (Aiming && !Reloading && (Weapon != nullptr))
 	{
@@ -684,118 +657,30 @@ void AUnrealSFASCharacter::FireWeapon()
 			// Check the weapon has rounds left in its clip.
 			if (!Weapon->IsClipEmpty())
 			{
-				// Has enough game time elapsed since the last shot?
-				const float currentGameSeconds = UKismetSystemLibrary::GetGameTimeInSeconds(world);
-				if ((currentGameSeconds - GameSecondsAtLastShot) > Weapon->GetShotRecoverTime())
+				// Has the weapon recovered from the last shot? Shots missed while the trigger was released are not fired later.
+				const double currentGameSeconds = world->GetTimeSeconds();
+				if ((QueuedShots == 0) && (currentGameSeconds >= NextShotGameSeconds))
 				{
-					// Is the camera manager reference vallid?
-					if (CameraManager)
+					NextShotGameSeconds = currentGameSeconds;
+
+					// Semi automatic and burst weapons queue their shots. Automatic weapons fire while the trigger is held.
+					const auto* definition = Weapon->GetDefinition();
+					switch (definition->GetFireMode())
 					{
-						GameSecondsAtLastShot = currentGameSeconds;
-
-						// Play the weapon shot effects.
-							// Play the weapon shot animation montage.
-						auto* montage = Weapon->GetShotAnimMontage();
-						if (montage)
-						{
-							PlayAnimMontage(montage);
-						}
-
-						// Play the weapon fire sound at the player's location.
-						auto* sound = Weapon->GetFireSound();
-						if (sound)
-						{
-							UGameplayStatics::PlaySoundAtLocation(world, sound, GetActorLocation());
-						}
-
-						// Spawn muzzle flash particles system.
-						auto* muzzleEmitterTemplate = Weapon->GetMuzzleFlashEmitterTemplate();
-						if (muzzleEmitterTemplate)
-						{
-							auto* muzzleScene = Weapon->GetMuzzeFlashScene();
-							UGameplayStatics::SpawnEmitterAttached(muzzleEmitterTemplate, muzzleScene, FName("None"), muzzleScene->GetComponentLocation(),
-								muzzleScene->GetComponentRotation(), EAttachLocation::KeepWorldPosition, true, EPSCPoolMethod::AutoRelease);
-						}
-
-						CameraManager = UGameplayStatics::GetPlayerCameraManager(world, PlayerIndex);
-						auto cameraLoc = CameraManager->GetCameraLocation();
-						auto cameraForward = CameraManager->GetActorForwardVector();
-
-						FHitResult hit;
-						TArray<AActor*> ignoredActors;
-						auto traceStart = cameraLoc;
-						auto traceEnd = traceStart + (cameraForward * Weapon->GetShotMaxRange());
-
-						// Calculate and apply deviationScale to the trace end point.
-						auto deviationScale = FMath::GetMappedRangeValueClamped(
-							FVector2D(0.f, GetCharacterMovement()->MaxWalkSpeed * MovingAccuracyDecreaseScale),
-							FVector2D(0.f, Weapon->GetMaximumDeviation()),
-							Accuracy
-						);
-
-						auto deviationDirection = UKismetMathLibrary::RotateAngleAxis(
-							UKismetMathLibrary::Cross_VectorVector(cameraForward, FollowCamera->GetUpVector()),
-							UKismetMathLibrary::RandomFloatInRange(0.f, 359.f),
-							cameraForward);
-
-						traceEnd += deviationDirection * deviationScale;
-
-						// Trace in the ECC_Visibility channel for any actor except for self.
-						if (UKismetSystemLibrary::LineTraceSingle(
-							world,
-							traceStart,
-							traceEnd,
-							UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_Visibility),
-							false,
-							ignoredActors,
-							EDrawDebugTrace::None,
-							hit,
-							true))
-						{
-							// Check if the hit actor has the "Enemy" tag.
-							auto* hitActor = hit.GetActor(); // Replaced hit.Actor from UE4
-							if (hitActor->ActorHasTag(FName("Enemy")))
-							{
-								// Show the hit marker. Start a timer to hide the hitmarker.
-								ShowHitMarker();
-								GetWorldTimerManager().ClearTimer(HitMarkerTimerHandle);
-								GetWorldTimerManager().SetTimer(HitMarkerTimerHandle, this, &AUnrealSFASCharacter::HideHitMarker, HitMarkerDisplayDuration, false);
-
-								// Cast the hit actor to ADroneCharacter.
-								auto* enemy = Cast<ADroneCharacter>(hitActor);
-
-								// Check the cast was successful.
-								if (enemy)
-								{
-									// Damage the enemy.
-									int32 damage = FMath::RandRange(Weapon->GetMinDamage(), Weapon->GetMaxDamage());
-									if (enemy->RecieveDamage(damage))
-									{
-										NumberOfEnemiesDefeated++;
-									}
-									DamageDealt += damage;
-								}
-							}
-						}
-
-						// Remove a round from the current clip of the weapon.
-						Weapon->RemoveRound();
-
-						// Update the game ui.
-						auto* sfasPC = CastChecked<AUnrealSFASPlayerController>(UGameplayStatics::GetPlayerController(world, PlayerIndex));
-						auto* gameUI = sfasPC->GetGameUI();
-						if (gameUI)
-						{
-							gameUI->SetWeaponRoundsRemaining(Weapon->GetRoundsRemaining());
-
-							// Show reload prompt if weapon clip is empty.
-							if (Weapon->IsClipEmpty())
-							{
-								// Auto reload the weapon when it is empty.
-								ReloadWeapon();
-							}
-						}
+					case EWeaponFireMode::SemiAutomatic:
+						QueuedShots = 1;
+						break;
+					case EWeaponFireMode::Burst:
+						QueuedShots = definition->GetBurstCount();
+						break;
+					case EWeaponFireMode::Automatic:
+						break;
 					}
+
+					// Time the shots fired by this press from the input, and resolve them against the drones where they were then.
+					FireInputCycles = inputCycles;
+					UpdateWeaponFire();
+					FireInputCycles = 0;
 				}
 			}
 			else
@@ -811,6 +696,211 @@ void AUnrealSFASCharacter::FireWeapon()
 	}
 }
 
+void AUnrealSFASCharacter::StopFiringWeapon()
+{
+	FireHeld = false;
+}
+
+void AUnrealSFASCharacter::UpdateWeaponFire()
+{
+	auto* world = GetWorld();
+	if (!world)
+	{
+		return;
+	}
+
+	// Drop queued shots while the weapon can't fire, and don't let held automatic fire build up shots to catch up on.
+	const double currentGameSeconds = world->GetTimeSeconds();
+	if (!Weapon || !Aiming || Reloading)
+	{
+		QueuedShots = 0;
+		NextShotGameSeconds = FMath::Max(NextShotGameSeconds, currentGameSeconds);
+		return;
+	}
+
+	// Fire every shot that has come due since the last update. Each shot is due a whole shot interval after the one before it
+	// rather than after the frame it was fired on, so the fire rate is exact at any frame rate, even above one shot per frame.
+	const auto* definition = Weapon->GetDefinition();
+	const bool automatic = (definition->GetFireMode() == EWeaponFireMode::Automatic);
+	const double shotInterval = definition->GetShotInterval();
+	int32 numShots = 0;
+	while ((currentGameSeconds >= NextShotGameSeconds) && (numShots < Weapon->GetRoundsRemaining()))
+	{
+		if (QueuedShots > 0)
+		{
+			QueuedShots--;
+		}
+		else if (!(automatic && FireHeld))
+		{
+			break;
+		}
+
+		numShots++;
+		NextShotGameSeconds += shotInterval;
+
+		// The weapon recovers after the last shot of a burst.
+		if ((definition->GetFireMode() == EWeaponFireMode::Burst) && (QueuedShots == 0))
+		{
+			NextShotGameSeconds += definition->GetBurstRecoverTime();
+		}
+	}
+
+	if (numShots > 0)
+	{
+		FireRounds(numShots);
+	}
+}
+
+void AUnrealSFASCharacter::FireRounds(int32 NumShots)
+{
+	// Is the camera manager reference vallid?
+	auto* world = GetWorld();
+	if (!CameraManager || !world)
+	{
+		return;
+	}
+
+	// Play the weapon shot effects once, however many shots came due this frame.
+	// Play the weapon shot animation montage.
+	auto* montage = Weapon->GetShotAnimMontage();
+	if (montage)
+	{
+		PlayAnimMontage(montage);
+	}
+
+	// Play the weapon fire sound at the player's location.
+	auto* sound = Weapon->GetFireSound();
+	if (sound)
+	{
+		UGameplayStatics::PlaySoundAtLocation(world, sound, GetActorLocation());
+	}
+
+	// Spawn muzzle flash particles system.
+	auto* muzzleEmitterTemplate = Weapon->GetMuzzleFlashEmitterTemplate();
+	if (muzzleEmitterTemplate)
+	{
+		auto* muzzleScene = Weapon->GetMuzzeFlashScene();
+		UGameplayStatics::SpawnEmitterAttached(muzzleEmitterTemplate, muzzleScene, FName("None"), muzzleScene->GetComponentLocation(),
+			muzzleScene->GetComponentRotation(), EAttachLocation::KeepWorldPosition, true, EPSCPoolMethod::AutoRelease);
+	}
+
+	CameraManager = UGameplayStatics::GetPlayerCameraManager(world, PlayerIndex);
+	auto cameraLoc = CameraManager->GetCameraLocation();
+	auto cameraForward = CameraManager->GetActorForwardVector();
+
+	// Calculate the deviation applied to the trace end point of each shot.
+	auto deviationScale = FMath::GetMappedRangeValueClamped(
+		FVector2D(0.f, GetCharacterMovement()->MaxWalkSpeed * MovingAccuracyDecreaseScale),
+		FVector2D(0.f, Weapon->GetMaximumDeviation()),
+		Accuracy
+	);
+
+	// Build every pellet of every shot, then queue them with the game mode's hitscan service in one batch. They are traced with
+	// the rest of this frame's shots and their hit markers, damage and stats are applied next frame. Weapons with a projectile
+	// speed fire each pellet as a projectile instead, if the game mode has a projectile manager.
+	const auto* definition = Weapon->GetDefinition();
+	const int32 pelletsPerShot = FMath::Max(definition->GetPelletsPerShot(), 1);
+	const float pelletSpreadRadians = FMath::DegreesToRadians(definition->GetPelletSpreadDegrees());
+	const float shotMaxRange = Weapon->GetShotMaxRange();
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(world));
+	auto* projectileManager = ((definition->GetProjectileSpeed() > 0.f) && unrealSFASGameMode) ? unrealSFASGameMode->GetProjectileManager() : nullptr;
+
+	// Time shots from the fire input if they were fired by a trigger press, otherwise from when they came due.
+	auto* shotLatency = unrealSFASGameMode ? &unrealSFASGameMode->GetShotLatencyTracker() : nullptr;
+	const uint64 inputCycles = (FireInputCycles != 0) ? FireInputCycles : FPlatformTime::Cycles64();
+
+	FireShots.Reset();
+	for (int32 shotIndex = 0; shotIndex < NumShots; shotIndex++)
+	{
+		auto deviationDirection = UKismetMathLibrary::RotateAngleAxis(
+			UKismetMathLibrary::Cross_VectorVector(cameraForward, FollowCamera->GetUpVector()),
+			UKismetMathLibrary::RandomFloatInRange(0.f, 359.f),
+			cameraForward);
+
+		const FVector shotEnd = cameraLoc + (cameraForward * shotMaxRange) + (deviationDirection * deviationScale);
+		const FVector shotDirection = (shotEnd - cameraLoc).GetSafeNormal();
+
+		for (int32 pelletIndex = 0; pelletIndex < pelletsPerShot; pelletIndex++)
+		{
+			// Single pellet shots go straight down the deviated shot direction.
+			const FVector pelletDirection = (pelletsPerShot > 1) ? FMath::VRandCone(shotDirection, pelletSpreadRadians) : shotDirection;
+
+			if (projectileManager)
+			{
+				FProjectileSpawn projectile;
+				projectile.Source = EHitscanShotSource::Player;
+				projectile.Shooter = this;
+				projectile.Location = cameraLoc;
+				projectile.Velocity = pelletDirection * definition->GetProjectileSpeed();
+				projectile.Lifetime = shotMaxRange / definition->GetProjectileSpeed();
+				projectile.Damage = FMath::RandRange(Weapon->GetMinDamage(), Weapon->GetMaxDamage());
+				projectile.InputCycles = FireInputCycles;
+				projectile.LatencyRecord = shotLatency ? shotLatency->BeginShot(inputCycles) : INDEX_NONE;
+				if (!projectileManager->FireProjectile(projectile) && shotLatency)
+				{
+					shotLatency->EndShot(projectile.LatencyRecord);
+				}
+				continue;
+			}
+
+			FHitscanShot& shot = FireShots.AddDefaulted_GetRef();
+			shot.Source = EHitscanShotSource::Player;
+			shot.Shooter = this;
+			shot.Start = cameraLoc;
+			shot.End = cameraLoc + (pelletDirection * shotMaxRange);
+			shot.Damage = FMath::RandRange(Weapon->GetMinDamage(), Weapon->GetMaxDamage());
+			shot.InputCycles = FireInputCycles;
+			shot.LatencyRecord = shotLatency ? shotLatency->BeginShot(inputCycles) : INDEX_NONE;
+		}
+
+		// Remove a round from the current clip of the weapon.
+		Weapon->RemoveRound();
+	}
+
+	if (unrealSFASGameMode && (FireShots.Num() > 0))
+	{
+		unrealSFASGameMode->GetHitscanService().FireShots(world, unrealSFASGameMode->GetDroneRegistry(), FireShots, &unrealSFASGameMode->GetDroneHitProxyHistory());
+	}
+
+	// Update the game ui.
+	auto* sfasPC = CastChecked<AUnrealSFASPlayerController>(UGameplayStatics::GetPlayerController(world, PlayerIndex));
+	auto* gameUI = sfasPC->GetGameUI();
+	if (gameUI)
+	{
+		gameUI->GetViewModel().SetRoundsRemaining(Weapon->GetRoundsRemaining());
+
+		// Show reload prompt if weapon clip is empty.
+		if (Weapon->IsClipEmpty())
+		{
+			// Auto reload the weapon when it is empty.
+			QueuedShots = 0;
+			ReloadWeapon();
+		}
+	}
+}
+
+void AUnrealSFASCharacter::OnShotHitEnemy(ADroneCharacter* Enemy, int32 Damage, int32 LatencyRecord)
+{
+	// Damage the enemy. The hit marker and stats are updated when the damage is resolved.
+	Enemy->RecieveDamage(Damage, this, LatencyRecord);
+}
+
+void AUnrealSFASCharacter::OnDamageDealt(int32 Damage, int32 EnemiesDefeated)
+{
+	// Show the hit marker. Start a timer to hide the hitmarker.
+	ShowHitMarker();
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		FTimingWheel& timingWheel = unrealSFASGameMode->GetTimingWheel();
+		timingWheel.ClearTimer(HitMarkerTimerHandle);
+		HitMarkerTimerHandle = timingWheel.SetTimer(HitMarkerDisplayDuration, &AUnrealSFASCharacter::OnHitMarkerTimerExpired, this);
+	}
+
+	NumberOfEnemiesDefeated += EnemiesDefeated;
+	DamageDealt += Damage;
+}
+
 void AUnrealSFASCharacter::SwapShoulder()
 {
 	if (Aiming)
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "HitscanService.h"
+#include "TimingWheel.h"
 #include "UnrealSFASCharacter.generated.h"
 
 UCLASS(config=Game)
@@ -19,9 +21,9 @@ class AUnrealSFASCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FollowCamera;
 
-	/** AI stimuli source */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = AI, meta = (AllowPrivateAccess = "true"))
-	class UAIPerceptionStimuliSourceComponent* AiStimuliSource;
+	/** Moves the camera boom and view pitch limits when aiming, swapping shoulder and defeated. Sleeps once they have settled. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
+	class UCameraRigComponent* CameraRig;
 
 public:
 	AUnrealSFASCharacter();
@@ -34,10 +36,16 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
 	float BaseLookUpRate;
 
-	/** Damages the player character's Hitpoints. A negative damage amount will heal the player. */
+	/** Queues damage to the player character's Hitpoints with the game mode's damage queue. A negative damage amount will heal the player. */
 	UFUNCTION(BlueprintCallable, Category = Damage)
 	void RecieveDamage(int Amount);
 
+	/** Changes the player's Hitpoints without any side effects. Returns whether the player has been defeated. Called by the game mode's damage queue. */
+	bool ApplyQueuedDamage(int Amount);
+
+	/** Plays the impact and healing feedback once for every hit this frame, updates the UI and handles defeat. Called by the game mode's damage queue. */
+	void PlayDamageEffects(int Damage, int Healing, bool WasDefeated);
+
 	/** Notifies the character that the reload animation has finished. */
 	UFUNCTION(BlueprintCallable, Category = Reload)
 	void OnFinishedReload();
@@ -61,6 +69,12 @@ public:
 	/** Sets whether this character can return to the main menu. */
 	void SetCanReturnToMainMenu(bool CanReturn);
 
+	/** Queues damage to the enemy credited to this player. Called by the game mode's hitscan service and projectile manager when a shot lands. */
+	void OnShotHitEnemy(class ADroneCharacter* Enemy, int32 Damage, int32 LatencyRecord = INDEX_NONE);
+
+	/** Shows the hit marker and updates the player's stats once for all of the damage the player dealt this frame. Called by the game mode's damage queue. */
+	void OnDamageDealt(int32 Damage, int32 EnemiesDefeated);
+
 protected:
 
 	/** Resets HMD orientation in VR. */
@@ -99,9 +113,18 @@ protected:
 	/** Exit's the player character from the aiming state and returns them to their normal state. */
 	void StopAimingWeapon();
 
-	/** Fire's the player's currently equipped weapon. */
+	/** Pulls the trigger of the player's currently equipped weapon. */
 	void FireWeapon();
 
+	/** Releases the trigger of the player's currently equipped weapon. */
+	void StopFiringWeapon();
+
+	/** Fires every shot of a held trigger or burst that is due. Called on trigger press and every tick. */
+	void UpdateWeaponFire();
+
+	/** Plays the shot effects once and fires NumShots shots, each with the weapon's pellets. */
+	void FireRounds(int32 NumShots);
+
 	/** Swaps the shoulder the player is looking over when aiming. */
 	void SwapShoulder();
 
@@ -132,10 +155,6 @@ public:
 	FORCEINLINE float GetAimBlendWeight() const { return AimBlendWeight; }
 
 private:
-	void UpdateCameraZoom(const float DeltaTime);
-	void UpdateCameraLocationOffset(const float DeltaTime);
-	void UpdateViewPitch(const float DeltaTime);
-
 	void SwapAimingShoulder();
 
 	void ReloadWeapon();
@@ -148,6 +167,9 @@ private:
 	void ShowHitMarker();
 	void HideHitMarker();
 
+	/** Timing wheel callback of the hit marker timer. Context is the character. */
+	static void OnHitMarkerTimerExpired(UObject* Context, int32 Payload);
+
 	/** Triggers game over state. */
 	void OnPlayerDefeated();
 
@@ -161,24 +183,33 @@ private:
 	void ReturnToMainMenu();
 
 private:
-	float TargetBoomLength;
 	float DefaultBoomLength;
-	FVector TargetCameraOffset;
 	float AimBlendWeight;
 	float DefaultViewMinPitch;
 	float DefaultViewMaxPitch;
 	float DefaultMaxWalkSpeed;
 	class APlayerCameraManager* CameraManager;
-	float TargetViewPitchMin;
-	float TargetViewPitchMax;
-	float GameSecondsAtLastShot;
+	/** The game time the next shot is due at. Advanced by exactly one shot interval per shot. */
+	double NextShotGameSeconds;
+
+	/** Shots of a semi automatic press or burst not yet fired. */
+	int32 QueuedShots;
+
+	/** Whether the fire input is held. */
+	bool FireHeld;
+
+	/** When the fire input being handled was received, in cycles. 0 outside of the input, when shots are timed from when they came due and resolved against where the drones are now. */
+	uint64 FireInputCycles;
+
+	/** Every pellet fired in a frame, queued with the hitscan service together. Scratch storage. */
+	TArray<FHitscanShot> FireShots;
 	class AWeapon* Weapon;
 	bool Aiming;
 	bool AimingOverRightShoulder;
 	FVector DefaultCameraRelativeLocation;
 	float Accuracy;
 
-	FTimerHandle HitMarkerTimerHandle;
+	FTimingWheelHandle HitMarkerTimerHandle;
 
 	int Hitpoints; 
 	bool Defeated;
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UnrealSFASCharacterAnimInstance.h"
+#include "UnrealSFAS.h"
+#include "UnrealSFASCharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Player anim game thread copy"), STAT_PlayerAnimGameThreadCopy, STATGROUP_SFASGameplay);
+DECLARE_CYCLE_STAT(TEXT("Player anim thread safe update"), STAT_PlayerAnimThreadSafeUpdate, STATGROUP_SFASGameplay);
+
+UUnrealSFASCharacterAnimInstance::UUnrealSFASCharacterAnimInstance()
+{
+	// Set default member values.
+	Character = nullptr;
+	ControlRotation = FRotator::ZeroRotator;
+	ActorRotation = FRotator::ZeroRotator;
+	Velocity = FVector::ZeroVector;
+	PitchOffset = 0.f;
+	AimBlendWeight = 0.f;
+	Speed = 0.f;
+	IsInAir = false;
+	Defeated = false;
+}
+
+void UUnrealSFASCharacterAnimInstance::NativeInitializeAnimation()
+{
+	Super::NativeInitializeAnimation();
+
+	Character = Cast<AUnrealSFASCharacter>(TryGetPawnOwner());
+}
+
+void UUnrealSFASCharacterAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeUpdateAnimation(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_PlayerAnimGameThreadCopy);
+
+	// Only copy what the thread safe update needs. Everything else happens off the game thread.
+	if (Character)
+	{
+		ControlRotation = Character->GetControlRotation();
+		ActorRotation = Character->GetActorRotation();
+		Velocity = Character->GetVelocity();
+		AimBlendWeight = Character->GetAimBlendWeight();
+		IsInAir = Character->GetCharacterMovement()->IsFalling();
+		Defeated = Character->GetDefeated();
+	}
+}
+
+void UUnrealSFASCharacterAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_PlayerAnimThreadSafeUpdate);
+
+	// Matches AUnrealSFASCharacter::GetPitchOffset.
+	PitchOffset = (ControlRotation - ActorRotation).GetNormalized().Pitch;
+	Speed = Velocity.Size2D();
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "UnrealSFASCharacterAnimInstance.generated.h"
+
+/**
+ * Native animation instance of the player character. The character's aim and movement state is copied once per frame on
+ * the game thread, and the values the graph reads are worked out in NativeThreadSafeUpdateAnimation so the update can run
+ * on a worker thread. Takes effect only once the player's animation blueprint is reparented to this class and its graph
+ * reads these properties instead of calling the character's BlueprintPure getters; until then nothing uses it.
+ */
+UCLASS()
+class UNREALSFAS_API UUnrealSFASCharacterAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+	UUnrealSFASCharacterAnimInstance();
+
+protected:
+	void NativeInitializeAnimation() override;
+	void NativeUpdateAnimation(float DeltaSeconds) override;
+	void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
+private:
+	/** The player character being animated. */
+	UPROPERTY(Transient)
+	class AUnrealSFASCharacter* Character;
+
+	/** Inputs copied from the character on the game thread. */
+	FRotator ControlRotation;
+	FRotator ActorRotation;
+	FVector Velocity;
+
+	/** The offset between the control and actor pitches, in degrees. */
+	UPROPERTY(BlueprintReadOnly, Category = Aim, meta = (AllowPrivateAccess = "true"))
+	float PitchOffset;
+
+	/** How far the character is blended into the aiming pose, in the range 0 - 1. */
+	UPROPERTY(BlueprintReadOnly, Category = Aim, meta = (AllowPrivateAccess = "true"))
+	float AimBlendWeight;
+
+	/** The character's speed along the ground. */
+	UPROPERTY(BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	float Speed;
+
+	/** Whether the character is jumping or falling. */
+	UPROPERTY(BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	bool IsInAir;
+
+	/** Whether the character has been defeated. */
+	UPROPERTY(BlueprintReadOnly, Category = Damage, meta = (AllowPrivateAccess = "true"))
+	bool Defeated;
+};
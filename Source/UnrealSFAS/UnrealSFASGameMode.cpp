@@ -12,6 +12,12 @@
 #include "DroneCharacter.h"
 #include "UnrealSFASGameInstance.h"
 #include "GameOver/GameOverUserWidget.h"
+#include "Camera/PlayerCameraManager.h"
+#include "DroneSwarm.h"
+#include "ProjectileManager.h"
+#include "PickupManager.h"
+#include "Sound/SoundAttenuation.h"
+#include "Engine/World.h"
 
 AUnrealSFASGameMode::AUnrealSFASGameMode()
 {
@@ -29,6 +35,17 @@ AUnrealSFASGameMode::AUnrealSFASGameMode()
 		PlayerControllerClass = PlayerControllerBPClass.Class;
 	}
 
+	// Drone motor voices fade with distance like the drone's own motor audio used to.
+	static ConstructorHelpers::FObjectFinder<USoundAttenuation> DroneMotorAttenuation(TEXT("SoundAttenuation'/Game/Audio/Drone/DroneBuzzAttenuationSettings.DroneBuzzAttenuationSettings'"));
+	if (DroneMotorAttenuation.Object != NULL)
+	{
+		DroneAudioSettings.Attenuation = DroneMotorAttenuation.Object;
+	}
+
+	// Tick before the drones so batch systems see this frame's drone registry.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
 	// Set member default values
 	CurrentWaveNumber = 0;
 	CurrentNumberOfEnemies = 0;
@@ -40,6 +57,15 @@ AUnrealSFASGameMode::AUnrealSFASGameMode()
 	EnemySpawnVolumeCenterLocation = FVector::ZeroVector;
 	EnemySpawnVolumeExtent = FVector(32.f, 32.f, 32.f);
 	EnemyCharacterClass = nullptr;
+	Maze = nullptr;
+	DroneSwarm = nullptr;
+	DroneSwarmClass = nullptr;
+	ProjectileManager = nullptr;
+	ProjectileManagerClass = nullptr;
+	PickupManager = nullptr;
+	PickupManagerClass = nullptr;
+	MaxDroneCharactersPerWave = 32;
+	BatchDroneMovement = true;
 
 	WaveStartSound = nullptr;
 	WaveCompleteSound = nullptr;
@@ -64,6 +90,16 @@ void AUnrealSFASGameMode::NotifyDroneDestroyed()
 	}
 }
 
+void AUnrealSFASGameMode::SetMaze(AUnrealSFASMaze* InMaze)
+{
+	Maze = InMaze;
+}
+
+void AUnrealSFASGameMode::AddDroneToSquad(const FDroneHandle& Handle, const FVector& Location)
+{
+	DroneSquadPlanner.AddDrone(Handle, Location, DroneRegistry, DroneSquadSettings);
+}
+
 void AUnrealSFASGameMode::OnPlayerDefeated()
 {
 	PlayersRemaining--;
@@ -121,6 +157,22 @@ void AUnrealSFASGameMode::BeginPlay()
 			newCharacter->SetPlayerIndex(1);
 		}
 
+		// Record the drone hit proxy history before any actor ticks, so every snapshot is taken at the same point in the frame
+		// whatever order the game mode and the player controllers tick in.
+		PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &AUnrealSFASGameMode::OnWorldPreActorTick);
+
+		// Spawn the manager of the projectiles fired by players and drones.
+		if (ProjectileManagerClass)
+		{
+			ProjectileManager = world->SpawnActor<AProjectileManager>(ProjectileManagerClass.Get(), FVector::ZeroVector, FRotator::ZeroRotator);
+		}
+
+		// Spawn the manager of the pickups dropped by drones.
+		if (PickupManagerClass)
+		{
+			PickupManager = world->SpawnActor<APickupManager>(PickupManagerClass.Get(), FVector::ZeroVector, FRotator::ZeroRotator);
+		}
+
 		// Check the enemy spawn volume class has been set.
 		if (EnemySpawnVolumeClass)
 		{
@@ -134,6 +186,16 @@ void AUnrealSFASGameMode::BeginPlay()
 				auto* enemySpawnVolumeBox = EnemySpawnVolume->GetVolume();
 				enemySpawnVolumeBox->SetBoxExtent(EnemySpawnVolumeExtent);
 
+				// Spawn the swarm that holds the drones beyond the drone character limit.
+				if (DroneSwarmClass)
+				{
+					DroneSwarm = world->SpawnActor<ADroneSwarm>(DroneSwarmClass.Get(), FVector::ZeroVector, FRotator::ZeroRotator);
+					if (DroneSwarm)
+					{
+						DroneSwarm->SetDroneClass(EnemyCharacterClass.Get());
+					}
+				}
+
 				StartNextWave();
 			}
 		}
@@ -146,6 +208,106 @@ void AUnrealSFASGameMode::BeginPlay()
 	}
 }
 
+void AUnrealSFASGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	PreActorTickHandle.Reset();
+
+	// Drones removed after the game mode would otherwise reference a dead registry.
+	DroneRegistry.Reset();
+	DroneSquadPlanner.Reset();
+	DroneAudioManager.Reset();
+	HitscanService.Reset();
+	DamageQueue.Reset();
+	DroneHitProxyHistory.Reset();
+	TimingWheel.Reset();
+
+	// Report the session's shot latency before the samples are dropped.
+	if (ShotLatencyTracker.GetHistogram(EShotLatencyStage::Validated).NumSamples > 0)
+	{
+		ShotLatencyTracker.LogSummary();
+	}
+	ShotLatencyTracker.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AUnrealSFASGameMode::OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if ((World != GetWorld()) || (TickType == LEVELTICK_TimeOnly))
+	{
+		return;
+	}
+
+	// Snapshot the drones where they were drawn last frame, before this frame's fire input is applied.
+	DroneRegistry.SyncFromActors();
+	DroneHitProxyHistory.Record(DroneRegistry, DroneHitProxyHistorySettings);
+}
+
+void AUnrealSFASGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Expire the gameplay timers due this frame.
+	TimingWheel.Tick(DeltaSeconds);
+
+	// Apply the shots fired last frame before anything reads drone or player hitpoints.
+	HitscanService.Tick(GetWorld(), DroneRegistry, DroneSwarm, ShotLatencyTracker);
+
+	// Refresh the packed drone data for this frame. Drones may have moved since the hit proxy history was recorded.
+	DroneRegistry.SyncFromActors();
+
+	// Re-rate drone significance against the players' current points of view.
+	UpdatePlayerViewpoints();
+	DroneSignificanceManager.Tick(DeltaSeconds, DroneRegistry, PlayerViewpoints, DroneSignificanceSettings);
+
+	// Work out which player each drone can see in one batch instead of a perception component per drone.
+	DroneVisibilityService.Tick(DeltaSeconds, GetWorld(), DroneRegistry, DroneSightTargets, DroneSightSettings);
+
+	// Re-plan the squads that are due, so drones act on a shared plan instead of each making its own decisions.
+	DroneSquadPlanner.Tick(DeltaSeconds, DroneRegistry, DroneSightTargets, Maze, DroneSquadSettings);
+
+	// Tick the drones' behavior trees at a fixed rate, spread evenly across frames.
+	DroneAIScheduler.Tick(DeltaSeconds, DroneRegistry, DroneAIScheduleSettings);
+
+	// Steer the drones apart and move them in one batch.
+	if (BatchDroneMovement)
+	{
+		DroneSteering.Calculate(DroneRegistry.GetPositions(), DroneRegistry.GetVelocityX(), DroneRegistry.GetVelocityY(), DroneSteeringSettings);
+		DroneMovementBatch.Tick(DeltaSeconds, DroneRegistry, DroneSteering.GetSteering(), Maze);
+	}
+
+	// Update drone cosmetics in one batch instead of per drone ticks.
+	DroneCosmeticManager.Tick(DroneRegistry);
+
+	// Give the drones nearest the players a motor voice and hear the rest through a crowd bed.
+	DroneAudioManager.Tick(DeltaSeconds, this, DroneRegistry, DroneSwarm, PlayerViewpoints, DroneSignificanceSettings, DroneAudioSettings);
+
+	// Step the projectiles in flight against the drones, players and maze as they are this frame. The first step of a player
+	// projectile is tested against the drones where they were at its fire input.
+	if (ProjectileManager)
+	{
+		ProjectileManager->UpdateProjectiles(DeltaSeconds, DroneRegistry, DroneSightTargets, Maze, &DroneHitProxyHistory, ShotLatencyTracker);
+	}
+
+	// Collect and expire the dropped pickups, and spin them in one batch per pickup class.
+	if (PickupManager)
+	{
+		PickupManager->UpdatePickups(DroneSightTargets);
+	}
+
+	// Simulate the swarm drones, firing the shots of the ones in range and promoting the ones near players to drone characters.
+	if (DroneSwarm)
+	{
+		DroneSwarm->UpdateSwarm(DeltaSeconds, DroneSightTargets, Maze, HitscanService, DroneRegistry);
+	}
+
+	// Resolve the damage dealt this frame once every batch has finished with the drones, so defeated drones are only removed
+	// from the registry here. Damage dealt by actors that tick after the game mode is resolved next frame.
+	DamageQueue.Resolve(ShotLatencyTracker);
+	ShotLatencyTracker.UpdateStats();
+}
+
 void AUnrealSFASGameMode::StartWave(int WaveNumber)
 {
 	// Check the world is valid.
@@ -161,12 +323,24 @@ void AUnrealSFASGameMode::StartWave(int WaveNumber)
 			int numberToSpawn = GetTotalNumberOfEnemiesInWave(WaveNumber);
 			CurrentNumberOfEnemies = 0;
 
+			// Drones beyond the drone character limit join the swarm with the same hitpoints a drone character would have.
+			const int additionalHitpoints = CalculateAdditionalEnemyHitpointsForWave(WaveNumber);
+			const int swarmHitpoints = CastChecked<ADroneCharacter>(EnemyCharacterClass->GetDefaultObject())->GetArchetype()->GetBaseHitpoints() + additionalHitpoints;
+
 			// For each enemy in the wave.
 			for (int i = 0; i < numberToSpawn; i++)
 			{
 				// Find a random location in the enemy spawn volume to spawn an enemy.
 				FVector randomLoc = UKismetMathLibrary::RandomPointInBoundingBox(enemySpawnVolumeBox->GetComponentLocation(), enemySpawnVolumeBox->GetUnscaledBoxExtent());
 
+				// Add the enemy to the swarm once the drone character limit is reached.
+				if (DroneSwarm && (i >= MaxDroneCharactersPerWave))
+				{
+					DroneSwarm->SpawnDrone(randomLoc, swarmHitpoints);
+					CurrentNumberOfEnemies++;
+					continue;
+				}
+
 				// Spawn the enemy at the found location.
 				FActorSpawnParameters spawnParams;
 				spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
@@ -178,7 +352,7 @@ void AUnrealSFASGameMode::StartWave(int WaveNumber)
 					CurrentNumberOfEnemies++;
 
 					// Add additional hitpoints based on wave number.
-					spawnedEnemy->AddHitpoints(CalculateAdditionalEnemyHitpointsForWave(WaveNumber));
+					spawnedEnemy->AddHitpoints(additionalHitpoints);
 				}
 			}
 
@@ -189,7 +363,7 @@ void AUnrealSFASGameMode::StartWave(int WaveNumber)
 			{
 				auto* unrealSFASPlayerController = CastChecked<AUnrealSFASPlayerController>(UGameplayStatics::GetPlayerController(world, i));
 				auto* GameUI = unrealSFASPlayerController->GetGameUI();
-				GameUI->SetWaveNumber(WaveNumber);
+				GameUI->GetViewModel().SetWaveNumber(WaveNumber);
 			}
 
 			// Call the wave started event.
@@ -206,11 +380,9 @@ int AUnrealSFASGameMode::GetTotalNumberOfEnemiesInWave(int WaveNumber)
 
 void AUnrealSFASGameMode::StartNextWave()
 {
-	// Bind StartWave and int parameter to timer delegate.
-	WaveStartCooldownTimerDelegate.BindUFunction(this, FName("StartWave"), ++CurrentWaveNumber);
-
-	// Set the timer to begin the wave start cooldown.
-	GetWorldTimerManager().SetTimer(WaveStartCooldownTimerHandle, WaveStartCooldownTimerDelegate, WaveStartCooldownDuration, false);
+	// Set the timer to begin the wave start cooldown. The wave number is passed through to StartWave.
+	TimingWheel.ClearTimer(WaveStartCooldownTimerHandle);
+	WaveStartCooldownTimerHandle = TimingWheel.SetTimer(WaveStartCooldownDuration, &AUnrealSFASGameMode::OnWaveStartCooldownTimerExpired, this, ++CurrentWaveNumber);
 }
 
 void AUnrealSFASGameMode::OnWaveComplete()
@@ -233,7 +405,8 @@ void AUnrealSFASGameMode::OnWaveComplete()
 		}
 
 		// Begin timer to hide notification.
-		GetWorldTimerManager().SetTimer(WaveNotificationTimerHandle, this, &AUnrealSFASGameMode::OnNotificationExpired, WaveNotificationDisplayDuration, false);
+		TimingWheel.ClearTimer(WaveNotificationTimerHandle);
+		WaveNotificationTimerHandle = TimingWheel.SetTimer(WaveNotificationDisplayDuration, &AUnrealSFASGameMode::OnNotificationTimerExpired, this);
 	}
 }
 
@@ -257,7 +430,8 @@ void AUnrealSFASGameMode::OnWaveStart()
 		}
 
 		// Begin timer to hide notification.
-		GetWorldTimerManager().SetTimer(WaveNotificationTimerHandle, this, &AUnrealSFASGameMode::OnNotificationExpired, WaveNotificationDisplayDuration, false);
+		TimingWheel.ClearTimer(WaveNotificationTimerHandle);
+		WaveNotificationTimerHandle = TimingWheel.SetTimer(WaveNotificationDisplayDuration, &AUnrealSFASGameMode::OnNotificationTimerExpired, this);
 	}
 }
 
@@ -276,8 +450,58 @@ void AUnrealSFASGameMode::OnNotificationExpired()
 	}
 }
 
+void AUnrealSFASGameMode::OnWaveStartCooldownTimerExpired(UObject* Context, int32 WaveNumber)
+{
+	CastChecked<AUnrealSFASGameMode>(Context)->StartWave(WaveNumber);
+}
+
+void AUnrealSFASGameMode::OnNotificationTimerExpired(UObject* Context, int32 Payload)
+{
+	CastChecked<AUnrealSFASGameMode>(Context)->OnNotificationExpired();
+}
+
 int AUnrealSFASGameMode::CalculateAdditionalEnemyHitpointsForWave(int WaveNumber)
 {
-	int baseAdditionalDroneHitpoints = 5;
-	return baseAdditionalDroneHitpoints* WaveNumber;
+	// Each drone type sets how much tougher it gets every wave.
+	auto* enemyCharacter = Cast<ADroneCharacter>(EnemyCharacterClass ? EnemyCharacterClass->GetDefaultObject() : nullptr);
+	const int additionalDroneHitpointsPerWave = enemyCharacter ? enemyCharacter->GetArchetype()->GetHitpointsPerWave() : GetDefault<UDroneArchetype>()->GetHitpointsPerWave();
+	return additionalDroneHitpointsPerWave * WaveNumber;
+}
+
+void AUnrealSFASGameMode::UpdatePlayerViewpoints()
+{
+	PlayerViewpoints.Reset();
+	DroneSightTargets.Reset();
+
+	// Check the world is valid.
+	auto* world = GetWorld();
+	if (world)
+	{
+		for (int i = 0; i < StartingNumberOfPlayers; i++)
+		{
+			// Skip players who have been defeated.
+			auto* unrealSFASCharacter = Cast<AUnrealSFASCharacter>(UGameplayStatics::GetPlayerCharacter(world, i));
+			if (!unrealSFASCharacter || unrealSFASCharacter->GetDefeated())
+			{
+				continue;
+			}
+
+			FDroneSightTarget sightTarget;
+			sightTarget.Actor = unrealSFASCharacter;
+			sightTarget.Location = unrealSFASCharacter->GetActorLocation();
+			sightTarget.PlayerIndex = i;
+			DroneSightTargets.Add(sightTarget);
+
+			auto* cameraManager = UGameplayStatics::GetPlayerCameraManager(world, i);
+			if (cameraManager)
+			{
+				FDroneSignificanceViewpoint viewpoint;
+				viewpoint.PawnLocation = unrealSFASCharacter->GetActorLocation();
+				viewpoint.ViewLocation = cameraManager->GetCameraLocation();
+				viewpoint.ViewDirection = cameraManager->GetCameraRotation().Vector();
+				viewpoint.CosHalfFOV = FMath::Cos(FMath::DegreesToRadians(cameraManager->GetFOVAngle() * 0.5f));
+				PlayerViewpoints.Add(viewpoint);
+			}
+		}
+	}
 }
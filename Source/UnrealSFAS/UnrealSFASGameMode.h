@@ -4,6 +4,20 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "DroneRegistry.h"
+#include "DroneSignificance.h"
+#include "DroneCosmeticManager.h"
+#include "DroneVisibilityService.h"
+#include "DroneMovementBatch.h"
+#include "DroneSteering.h"
+#include "DroneSquadPlanner.h"
+#include "DroneAIScheduler.h"
+#include "DroneAudioManager.h"
+#include "HitscanService.h"
+#include "DamageQueue.h"
+#include "ShotLatencyTracker.h"
+#include "DroneHitProxyHistory.h"
+#include "TimingWheel.h"
 #include "UnrealSFASGameMode.generated.h"
 
 UCLASS(minimalapi)
@@ -23,10 +37,57 @@ public:
 	/** Handles updating the game state when a player is defeated. */
 	void OnPlayerDefeated();
 
+	/** Returns the registry of every live drone. */
+	FORCEINLINE FDroneRegistry& GetDroneRegistry() { return DroneRegistry; }
+	FORCEINLINE const FDroneRegistry& GetDroneRegistry() const { return DroneRegistry; }
+
+	/** Sets the maze of the current level. Called by the maze when it starts. */
+	void SetMaze(class AUnrealSFASMaze* InMaze);
+
+	/** Returns the maze of the current level, or nullptr if there is none. */
+	FORCEINLINE class AUnrealSFASMaze* GetMaze() const { return Maze; }
+
+	/** Adds a drone to a squad so it follows its squad's plan. Called by drones when they spawn. */
+	void AddDroneToSquad(const FDroneHandle& Handle, const FVector& Location);
+
+	/** Returns the planner of every drone squad. */
+	FORCEINLINE const FDroneSquadPlanner& GetDroneSquadPlanner() const { return DroneSquadPlanner; }
+
+	/** Returns the service that traces every hitscan shot in a frame as one batch. */
+	FORCEINLINE FHitscanService& GetHitscanService() { return HitscanService; }
+
+	/** Returns the queue every player and drone damage goes through, resolved once at the end of each tick. */
+	FORCEINLINE FDamageQueue& GetDamageQueue() { return DamageQueue; }
+
+	/** Returns the wheel that runs the short-lived gameplay timers, advanced at the start of each tick. */
+	FORCEINLINE FTimingWheel& GetTimingWheel() { return TimingWheel; }
+
+	/** Returns the tracker timing player shots from the fire input to the hit marker. */
+	FORCEINLINE FShotLatencyTracker& GetShotLatencyTracker() { return ShotLatencyTracker; }
+
+	/** Returns the recent history of the drone hit proxies, used to resolve player shots at their input time. */
+	FORCEINLINE FDroneHitProxyHistory& GetDroneHitProxyHistory() { return DroneHitProxyHistory; }
+
+	/** Returns the manager of every projectile in flight, or nullptr if the game mode doesn't use projectiles. */
+	FORCEINLINE class AProjectileManager* GetProjectileManager() const { return ProjectileManager; }
+
+	/** Returns the manager of the pickups dropped by drones. nullptr if PickupManagerClass is unset. */
+	FORCEINLINE class APickupManager* GetPickupManager() const { return PickupManager; }
+
+	/** Returns the swarm of lightweight drones, or nullptr if the game mode doesn't use one. */
+	FORCEINLINE class ADroneSwarm* GetDroneSwarm() const { return DroneSwarm; }
+
 protected:
 	void BeginPlay() override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Called every tick. Updates the drone registry before the drones and batch systems tick. */
+	void Tick(float DeltaSeconds) override;
 
 private:
+	/** Called once per frame before any actor ticks. Records the drone hit proxy history at the same point every frame. */
+	void OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
 	/** Starts the wave specified. */
 	UFUNCTION()
 	void StartWave(int WaveNumber);
@@ -46,23 +107,96 @@ private:
 	/** Called when a wave status notification has expired. Hides the appropriate UI widget. */
 	void OnNotificationExpired();
 
+	/** Timing wheel callbacks of the wave timers. Context is the game mode. */
+	static void OnWaveStartCooldownTimerExpired(UObject* Context, int32 WaveNumber);
+	static void OnNotificationTimerExpired(UObject* Context, int32 Payload);
+
 	int CalculateAdditionalEnemyHitpointsForWave(int WaveNumber);
 
+	/** Refreshes the point of view and location of each player still in the game. */
+	void UpdatePlayerViewpoints();
+
 private:
 	int CurrentWaveNumber;
 	int CurrentNumberOfEnemies;
 	float WaveStartCooldownDuration;
 
-	FTimerDelegate WaveStartCooldownTimerDelegate;
-	FTimerHandle WaveStartCooldownTimerHandle;
+	FTimingWheelHandle WaveStartCooldownTimerHandle;
 
 	float WaveNotificationDisplayDuration;
-	FTimerHandle WaveNotificationTimerHandle;
+	FTimingWheelHandle WaveNotificationTimerHandle;
+
+	/** Packed storage of every live drone. Drones add and remove themselves on spawn and destruction. */
+	FDroneRegistry DroneRegistry;
+
+	/** Rates drones by distance and visibility to the players and lowers the update rates of the less significant ones. */
+	FDroneSignificanceManager DroneSignificanceManager;
+
+	/** Updates the motor audio pitch of every drone in one batch. */
+	FDroneCosmeticManager DroneCosmeticManager;
+
+	/** Keeps drones apart and flying with their neighbours. */
+	FDroneSteering DroneSteering;
+
+	/** Moves every drone in one batch. */
+	FDroneMovementBatch DroneMovementBatch;
+
+	/** Works out which player each drone can see. */
+	FDroneVisibilityService DroneVisibilityService;
+
+	/** Plans the target, flanking positions and firing order of each drone squad. */
+	FDroneSquadPlanner DroneSquadPlanner;
+
+	/** Ticks drone behavior trees at a fixed rate. */
+	FDroneAIScheduler DroneAIScheduler;
+
+	/** Plays drone motor audio from a fixed pool of voices and a crowd bed per player. */
+	FDroneAudioManager DroneAudioManager;
+
+	/** Traces player and drone shots in batches and applies their results. */
+	FHitscanService HitscanService;
+
+	/** Collects the damage dealt during a frame and resolves it in one pass. */
+	FDamageQueue DamageQueue;
+
+	/** Runs the wave, hit marker and pickup timers. */
+	FTimingWheel TimingWheel;
+
+	/** Times player shots from the fire input to the hit marker for the whole session. */
+	FShotLatencyTracker ShotLatencyTracker;
+
+	/** Where the drone hit proxies were over the last few frames. */
+	FDroneHitProxyHistory DroneHitProxyHistory;
+
+	/** Handle of the world pre actor tick delegate that records the hit proxy history. */
+	FDelegateHandle PreActorTickHandle;
+
+	/** The point of view of each player still in the game. Updated every tick. */
+	TArray<FDroneSignificanceViewpoint> PlayerViewpoints;
+
+	/** Each player still in the game that drones can see. Updated every tick. */
+	TArray<FDroneSightTarget> DroneSightTargets;
 
 private:
 	/** The spawn volume instance used to spawn enemies in. */
 	class ASpawnVolume* EnemySpawnVolume;
 
+	/** The maze of the current level. */
+	UPROPERTY()
+	class AUnrealSFASMaze* Maze;
+
+	/** The swarm instance that holds the drones of a wave beyond the drone character limit. */
+	UPROPERTY()
+	class ADroneSwarm* DroneSwarm;
+
+	/** The manager of every projectile in flight. */
+	UPROPERTY()
+	class AProjectileManager* ProjectileManager;
+
+	/** The manager of every pickup dropped by drones. */
+	UPROPERTY()
+	class APickupManager* PickupManager;
+
 	/** The number of players left remaining in the game. */
 	int PlayersRemaining;
 
@@ -86,6 +220,46 @@ private:
 	/** Set in the derived blueprint. The character class to spawn as enemies. */
 	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
 	TSubclassOf<class ACharacter> EnemyCharacterClass;
+
+	/** Distance and visibility thresholds of the drone significance tiers, and how drones update in each tier. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	FDroneSignificanceSettings DroneSignificanceSettings;
+
+	/** Set in the derived blueprint. The projectile manager class used by weapons and drones that fire projectiles. They fire hitscan shots if unset. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<class AProjectileManager> ProjectileManagerClass;
+
+	/** Set in the derived blueprint. The pickup manager class that holds the pickups dropped by drones. Pickups are spawned as actors if unset. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<class APickupManager> PickupManagerClass;
+
+	/** Set in the derived blueprint. The swarm class used for drones beyond MaxDroneCharactersPerWave. No swarm is used if unset. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<class ADroneSwarm> DroneSwarmClass;
+
+	/** The most drones spawned as drone characters at the start of a wave. The rest join the swarm. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	int32 MaxDroneCharactersPerWave;
+
+	/** Whether the game mode moves drones in one batch. Otherwise each drone's movement component ticks itself. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	bool BatchDroneMovement;
+
+	/** How strongly drones steer to keep apart. Only applies to batched drone movement. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	FDroneSteeringSettings DroneSteeringSettings;
+
+	/** How far and how wide drones can see players. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	FDroneSightSettings DroneSightSettings;
+
+	/** How drones are grouped into squads and how often squad plans are made. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	FDroneSquadSettings DroneSquadSettings;
+
+	/** The fixed rate drone behavior trees are ticked at. */
+	UPROPERTY(EditDefaultsOnly, Category = Enemies, meta = (AllowPrivateAccess = "true"))
+	FDroneAIScheduleSettings DroneAIScheduleSettings;
 	//////////////////////////////////
 	/** Audio category */
 	/** Set in the derived blueprint. The sound to play at the start of a wave. */
@@ -99,6 +273,14 @@ private:
 	/** Set in the derived blueprint. The background music sound. */
 	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
 	USoundBase* BackgroundMusic;
+
+	/** How many drones have their own motor voice and how loud the crowd of the rest is. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	FDroneAudioSettings DroneAudioSettings;
+
+	/** How far back player shots can be resolved against where the drones were. */
+	UPROPERTY(EditDefaultsOnly, Category = Shooting, meta = (AllowPrivateAccess = "true"))
+	FDroneHitProxyHistorySettings DroneHitProxyHistorySettings;
 	//////////////////////////////////
 };
 
@@ -3,6 +3,9 @@
 
 #include "UnrealSFASMaze.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Kismet/GameplayStatics.h"
+#include "UnrealSFASGameMode.h"
+#include "GameCollisionDefinitions.h"
 
 // Sets default values
 AUnrealSFASMaze::AUnrealSFASMaze()
@@ -20,10 +23,20 @@ void AUnrealSFASMaze::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// Start with every cell open.
+	WallTopHeights.Init(TNumericLimits<float>::Lowest(), MazeSize * MazeSize);
+
+	// Let the game mode know about the maze so drones can test their movement against the grid.
+	auto* unrealSFASGameMode = Cast<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
+	if (unrealSFASGameMode)
+	{
+		unrealSFASGameMode->SetMaze(this);
+	}
+
 	if (WallMesh)
 	{
-		const int32 mazeSize = 20;
-		const float blockSize = 200.0f;
+		const int32 mazeSize = MazeSize;
+		const float blockSize = BlockSize;
 		const float blockWidth = 2.0f;
 		const float mazeDensity = 0.1f; // In the range 0 - 1. 1 is more dense
 		const float tallBlockZPos = 150.0f;
@@ -96,6 +109,10 @@ void AUnrealSFASMaze::BeginPlay()
 						meshComponent->SetWorldTransform(worldXForm);
 						meshComponent->AttachToComponent(rootComponent, FAttachmentTransformRules::KeepWorldTransform);
 
+						// Walls are the only maze geometry that blocks shots and drone sight. Gameplay traces are not complex, so
+						// they test the wall mesh's simple collision.
+						meshComponent->SetCollisionProfileName(COLLISION_PROFILE_MAZE_WALL);
+
 						// Used for post process outline effect.
 						meshComponent->SetRenderCustomDepth(true);
 						meshComponent->SetCustomDepthStencilValue(2);
@@ -111,6 +128,10 @@ void AUnrealSFASMaze::BeginPlay()
 						meshComponent->SetCanEverAffectNavigation(true);
 
 						meshComponent->RegisterComponent();
+
+						// Record the top of the wall for grid collision tests.
+						const FBoxSphereBounds meshBounds = WallMesh->GetBounds();
+						WallTopHeights[(i * mazeSize) + j] = blockZPos + ((meshBounds.Origin.Z + meshBounds.BoxExtent.Z) * worldScale.Z);
 					}
 				}
 			}
@@ -118,3 +139,35 @@ void AUnrealSFASMaze::BeginPlay()
 	}
 }
 
+FIntPoint AUnrealSFASMaze::WorldToCell(const FVector& Location)
+{
+	// Blocks are centered on multiples of the block size, offset so the maze is centered on the world origin.
+	const int32 x = FMath::FloorToInt((Location.X / BlockSize) + 0.5f) + (MazeSize / 2);
+	const int32 y = FMath::FloorToInt((Location.Y / BlockSize) + 0.5f) + (MazeSize / 2);
+	return FIntPoint(x, y);
+}
+
+FVector AUnrealSFASMaze::CellToWorld(const FIntPoint& Cell)
+{
+	return FVector(static_cast<float>(Cell.X - (MazeSize / 2)) * BlockSize, static_cast<float>(Cell.Y - (MazeSize / 2)) * BlockSize, 0.0f);
+}
+
+bool AUnrealSFASMaze::IsCellInBounds(const FIntPoint& Cell)
+{
+	return (Cell.X >= 0) && (Cell.X < MazeSize) && (Cell.Y >= 0) && (Cell.Y < MazeSize);
+}
+
+float AUnrealSFASMaze::GetWallTopHeight(const FIntPoint& Cell) const
+{
+	return GetWallTopHeight(WallTopHeights, Cell);
+}
+
+float AUnrealSFASMaze::GetWallTopHeight(TArrayView<const float> WallTopHeights, const FIntPoint& Cell)
+{
+	if (!IsCellInBounds(Cell) || (WallTopHeights.Num() == 0))
+	{
+		return TNumericLimits<float>::Lowest();
+	}
+
+	return WallTopHeights[(Cell.Y * MazeSize) + Cell.X];
+}
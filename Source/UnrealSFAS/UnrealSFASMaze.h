@@ -19,10 +19,39 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+public:
+	/** The number of cells along each side of the maze grid. */
+	static constexpr int32 MazeSize = 20;
+
+	/** The world size of a single maze grid cell. */
+	static constexpr float BlockSize = 200.0f;
+
+	/** Returns the maze grid cell containing the world location. The cell may lie outside of the maze bounds. */
+	static FIntPoint WorldToCell(const FVector& Location);
+
+	/** Returns the world location of the center of the maze grid cell. */
+	static FVector CellToWorld(const FIntPoint& Cell);
+
+	/** Returns whether the cell lies inside of the maze bounds. */
+	static bool IsCellInBounds(const FIntPoint& Cell);
+
+	/** Returns the height of the top of the wall in the cell, or lowest float value if the cell has no wall or is out of bounds. Safe to call from any thread. */
+	float GetWallTopHeight(const FIntPoint& Cell) const;
+
+	/** Returns the height of the top of the wall in the cell of a wall height grid laid out like GetWallTopHeights, or lowest float value if the cell has no wall or is out of bounds. */
+	static float GetWallTopHeight(TArrayView<const float> WallTopHeights, const FIntPoint& Cell);
+
+	/** Returns the height of the top of the wall in each cell, indexed by Cell.Y * MazeSize + Cell.X. Empty until the maze is built. */
+	FORCEINLINE TArrayView<const float> GetWallTopHeights() const { return WallTopHeights; }
+
 public:	
 	UPROPERTY(EditDefaultsOnly, Category = Maze)
 	UStaticMesh* WallMesh;
 
 	UPROPERTY(EditDefaultsOnly, Category = Maze)
 	UMaterialInterface* WallMaterial;
+
+private:
+	/** The height of the top of the wall in each cell, indexed by Cell.Y * MazeSize + Cell.X. Lowest float value for cells without a wall. */
+	TArray<float> WallTopHeights;
 };
@@ -9,6 +9,7 @@
 #include "GameOver/GameOverUserWidget.h"
 #include "Pause/PauseUserWidget.h"
 #include  "UnrealSFASCharacter.h"
+#include "GameFramework/PlayerInput.h"
 
 AUnrealSFASPlayerController::AUnrealSFASPlayerController()
 {
@@ -20,6 +21,7 @@ AUnrealSFASPlayerController::AUnrealSFASPlayerController()
 	}
 
 	// Set member default values
+	FireInputCycles = 0;
 	GameUI = nullptr;
 	GameOverUI = nullptr;
 	GameUIClass = nullptr;
@@ -50,9 +52,9 @@ void AUnrealSFASPlayerController::SpawnGameUI(AUnrealSFASCharacter* unrealSFASCh
 
 			// Setup initial ui state
 			auto* gameMode = CastChecked<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
-			GameUI->SetWaveNumber(gameMode->GetCurrentWaveNumber());
+			GameUI->GetViewModel().SetWaveNumber(gameMode->GetCurrentWaveNumber());
 
-			GameUI->SetHitpointsValue(unrealSFASCharacter->GetHitpoints());
+			GameUI->GetViewModel().SetHitpoints(unrealSFASCharacter->GetHitpoints());
 		}
 	}
 
@@ -72,34 +74,42 @@ void AUnrealSFASPlayerController::SpawnGameUI(AUnrealSFASCharacter* unrealSFASCh
 			PauseUI->Show(false);
 		}
 	}
-}
 
-void AUnrealSFASPlayerController::SpawnGameOverUI(int EnemiesDefeated, int TotalDamageDealt)
-{
-	// Spawn game over user interface
+	// Spawn game over user interface now, hidden, so a defeat doesn't pay for creating it.
 	// Check the game over ui class is valid
-	if (GameOverWidgetClass)
+	if (GameOverWidgetClass && !GameOverUI)
 	{
 		GameOverUI = CreateWidget<UGameOverUserWidget>(this, GameOverWidgetClass);
 
 		// Check game over UI created correctly.
 		if (GameOverUI)
 		{
-			// Setup game over ui.
-			GameOverUI->SetEnemiesDefeatedText(EnemiesDefeated);
-			GameOverUI->SetDamageDealtText(TotalDamageDealt);
+			GameOverUI->SetVisibility(ESlateVisibility::Collapsed);
+			GameOverUI->AddToPlayerScreen();
+		}
+	}
+}
 
-			// Check the world is valid.
-			auto* world = GetWorld();
-			if (world)
-			{
-				// Cast to UnrealSFASGameMode.
-				auto* unrealSFASGameMode = CastChecked<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(world));
-				GameOverUI->SetWavesSurvivedText(unrealSFASGameMode->GetCurrentWaveNumber() - 1);
-			}
+void AUnrealSFASPlayerController::ShowGameOverUI(int EnemiesDefeated, int TotalDamageDealt)
+{
+	// Check the game over UI was created.
+	if (GameOverUI)
+	{
+		// Setup game over ui.
+		GameOverUI->SetEnemiesDefeatedText(EnemiesDefeated);
+		GameOverUI->SetDamageDealtText(TotalDamageDealt);
 
-			GameOverUI->AddToPlayerScreen();
+		// Check the world is valid.
+		auto* world = GetWorld();
+		if (world)
+		{
+			// Cast to UnrealSFASGameMode.
+			auto* unrealSFASGameMode = CastChecked<AUnrealSFASGameMode>(UGameplayStatics::GetGameMode(world));
+			GameOverUI->SetWavesSurvivedText(unrealSFASGameMode->GetCurrentWaveNumber() - 1);
 		}
+
+		// Show the UI.
+		GameOverUI->SetVisibility(ESlateVisibility::SelfHitTestInvisible);
 	}
 }
 
@@ -169,3 +179,29 @@ void AUnrealSFASPlayerController::OnPossess(APawn* InPawn)
 	unrealSFASCharacter->SpawnWeapon(GameUI);
 	unrealSFASCharacter->SetupOnPossessed();
 }
+
+bool AUnrealSFASPlayerController::InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad)
+{
+	// Record when a key bound to fire is pressed. The fire binding runs later in the frame, when the shot is resolved against
+	// the drones where they were at this time.
+	if ((EventType == IE_Pressed) && PlayerInput)
+	{
+		for (const auto& mapping : PlayerInput->GetKeysForAction(FName("FireWeapon")))
+		{
+			if (mapping.Key == Key)
+			{
+				FireInputCycles = FPlatformTime::Cycles64();
+				break;
+			}
+		}
+	}
+
+	return Super::InputKey(Key, EventType, AmountDepressed, bGamepad);
+}
+
+uint64 AUnrealSFASPlayerController::ConsumeFireInputCycles()
+{
+	const uint64 inputCycles = FireInputCycles;
+	FireInputCycles = 0;
+	return inputCycles;
+}
@@ -17,7 +17,8 @@ class UNREALSFAS_API AUnrealSFASPlayerController : public APlayerController
 public:
 	AUnrealSFASPlayerController();
 
-	void SpawnGameOverUI(int EnemiesDefeated, int TotalDamageDealt);
+	/** Fills in and shows the game over UI created with the game UI. */
+	void ShowGameOverUI(int EnemiesDefeated, int TotalDamageDealt);
 
 	void PauseGame(bool Pause);
 	void TogglePause();
@@ -29,12 +30,18 @@ public:
 	FORCEINLINE class UPauseUserWidget* GetPauseUI() const { return PauseUI; }
 	FORCEINLINE int32 GetPlayerIndex() const { return PlayerIndex; }
 
+	/** Returns when the last fire input was received, in cycles, and clears it. 0 if there hasn't been one since the last call. */
+	uint64 ConsumeFireInputCycles();
+
 public:
 	/** Called when the controller possesses a pawn. */
 	void OnPossess(APawn* InPawn) override;
 
+	/** Called as the viewport receives each key event, before input is processed in the world tick. Records when fire is pressed. */
+	bool InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad) override;
+
 private:
-	/** Spawns game ui for the character and adds it to the player screen. */
+	/** Spawns game ui for the character and adds it to the player screen. Creates the pause and game over UI hidden, so showing them doesn't hitch. */
 	void SpawnGameUI(class AUnrealSFASCharacter* unrealSFASCharacter);
 
 private:
@@ -46,6 +53,9 @@ private:
 	bool Paused;
 	int32 PlayerIndexWhoPaused;
 
+	/** When the last fire input was received, in cycles. */
+	uint64 FireInputCycles;
+
 	///////////////////////////////////////////////////
 	/** Game user interface category */
 	/** Set in the derived blueprint */
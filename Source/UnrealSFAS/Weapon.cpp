@@ -2,6 +2,7 @@
 
 
 #include "Weapon.h"
+#include "GameCollisionDefinitions.h"
 
 // Sets default values
 AWeapon::AWeapon()
@@ -15,23 +16,34 @@ AWeapon::AWeapon()
 	// Include the weapon mesh in the player mask.
 	StaticMesh->SetRenderCustomDepth(true);
 	StaticMesh->SetCustomDepthStencilValue(3);
+	// Shots hit the holder's capsule, so the weapon doesn't stop shots or drone sight.
+	StaticMesh->SetCollisionResponseToChannel(COLLISION_SHOT, ECR_Ignore);
+	StaticMesh->SetCollisionResponseToChannel(COLLISION_SIGHT, ECR_Ignore);
 
 	// Setup muzzle flash scene component
 	MuzzleFlashScene = CreateDefaultSubobject<USceneComponent>(TEXT("MuzzleFlashScene"));
 	MuzzleFlashScene->SetupAttachment(RootComponent);
 
-	// Set default member values
-	ShotAnimMontage = nullptr;
-	ReloadAnimMontage = nullptr;
-	ShotRecoverTime = 0.15f;
-	ShotMaxRange = 1000.0f;
-	MinDamage = 1;
-	MaxDamage = 5;
-	FireSound = nullptr;
-	MuzzleFlashEmitterTemplate = nullptr;
-	MaximumDeviation = 50.f;
-	ClipSize = 8;
-	CurrentRounds = ClipSize;
+	// Set default member values. The tuning comes from the weapon definition.
+	Definition = nullptr;
+	LegacyDefinition = nullptr;
+
+	// The deprecated tuning properties default to the definition defaults, so weapons that never set them are unchanged.
+	const auto* defaultDefinition = GetDefault<UWeaponDefinition>();
+	ShotAnimMontage = defaultDefinition->ShotAnimMontage;
+	ReloadAnimMontage = defaultDefinition->ReloadAnimMontage;
+	ShotRecoverTime = defaultDefinition->GetShotInterval();
+	ShotMaxRange = defaultDefinition->ShotMaxRange;
+	MinDamage = defaultDefinition->MinDamage;
+	MaxDamage = defaultDefinition->MaxDamage;
+	FireSound = defaultDefinition->FireSound;
+	EmptyFireSound = defaultDefinition->EmptyFireSound;
+	ReloadSound = defaultDefinition->ReloadSound;
+	MuzzleFlashEmitterTemplate = defaultDefinition->MuzzleFlashEmitterTemplate;
+	MaximumDeviation = defaultDefinition->MaximumDeviation;
+	ClipSize = defaultDefinition->ClipSize;
+
+	CurrentRounds = GetClipCapacity();
 }
 
 void AWeapon::BeginPlay()
@@ -39,7 +51,41 @@ void AWeapon::BeginPlay()
 	Super::BeginPlay();
 
 	// Set the current rounds in the clip to be the max clip size.
-	CurrentRounds = ClipSize;
+	CurrentRounds = GetClipCapacity();
+}
+
+void AWeapon::PostLoad()
+{
+	Super::PostLoad();
+
+	// Only the class default object needs one. Weapons spawned from it copy its pointer.
+	if (HasAnyFlags(RF_ClassDefaultObject) && !Definition && !LegacyDefinition)
+	{
+		LegacyDefinition = CreateLegacyDefinition();
+	}
+}
+
+UWeaponDefinition* AWeapon::CreateLegacyDefinition()
+{
+	// Weapons used to fire one semi automatic shot per press, recovering for ShotRecoverTime seconds between shots.
+	auto* definition = NewObject<UWeaponDefinition>(this, NAME_None, RF_Transient);
+	definition->FireMode = EWeaponFireMode::SemiAutomatic;
+	definition->RoundsPerMinute = 60.f / FMath::Max(ShotRecoverTime, KINDA_SMALL_NUMBER);
+	definition->PelletsPerShot = 1;
+	definition->ProjectileSpeed = 0.f;
+	definition->ShotAnimMontage = ShotAnimMontage;
+	definition->ReloadAnimMontage = ReloadAnimMontage;
+	definition->ShotMaxRange = ShotMaxRange;
+	definition->MinDamage = MinDamage;
+	definition->MaxDamage = MaxDamage;
+	definition->FireSound = FireSound;
+	definition->EmptyFireSound = EmptyFireSound;
+	definition->ReloadSound = ReloadSound;
+	definition->MuzzleFlashEmitterTemplate = MuzzleFlashEmitterTemplate;
+	definition->MaximumDeviation = MaximumDeviation;
+	definition->ClipSize = ClipSize;
+
+	return definition;
 }
 
 void AWeapon::RemoveRound()
@@ -49,7 +95,7 @@ void AWeapon::RemoveRound()
 
 void AWeapon::NewClip()
 {
-	CurrentRounds = ClipSize;
+	CurrentRounds = GetClipCapacity();
 }
 
 
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "WeaponDefinition.h"
 #include "Weapon.generated.h"
 
 UCLASS()
@@ -27,22 +28,27 @@ public:
 	FORCEINLINE USceneComponent* GetMuzzeFlashScene() const { return MuzzleFlashScene; }
 
 	UFUNCTION(BlueprintCallable, Category = Reload)
-	FORCEINLINE USoundBase* GetReloadSound() const { return ReloadSound; }
-
-	FORCEINLINE class UAnimMontage* GetShotAnimMontage() const { return ShotAnimMontage; }
-	FORCEINLINE class UAnimMontage* GetReloadAnimMontage() const { return ReloadAnimMontage; }
-	FORCEINLINE float GetShotRecoverTime() const { return ShotRecoverTime; }
-	FORCEINLINE float GetShotMaxRange() const { return ShotMaxRange; }
-	FORCEINLINE int GetMinDamage() const { return MinDamage; }
-	FORCEINLINE int GetMaxDamage() const { return MaxDamage; }
-	FORCEINLINE USoundBase* GetFireSound() const { return FireSound; }
-	FORCEINLINE USoundBase* GetEmptyFireSound() const { return EmptyFireSound; }
-	FORCEINLINE UParticleSystem* GetMuzzleFlashEmitterTemplate() const { return MuzzleFlashEmitterTemplate; }
-	FORCEINLINE float GetMaximumDeviation() const { return MaximumDeviation; }
+	FORCEINLINE USoundBase* GetReloadSound() const { return GetDefinition()->GetReloadSound(); }
+
+	/**
+	 * Returns the tuning data shared by weapons of this type. Falls back to a definition built from the deprecated tuning
+	 * properties if none is set, or to the definition defaults if there are none either.
+	 */
+	FORCEINLINE const UWeaponDefinition* GetDefinition() const { return Definition ? Definition : (LegacyDefinition ? LegacyDefinition : GetDefault<UWeaponDefinition>()); }
+
+	FORCEINLINE class UAnimMontage* GetShotAnimMontage() const { return GetDefinition()->GetShotAnimMontage(); }
+	FORCEINLINE class UAnimMontage* GetReloadAnimMontage() const { return GetDefinition()->GetReloadAnimMontage(); }
+	FORCEINLINE float GetShotMaxRange() const { return GetDefinition()->GetShotMaxRange(); }
+	FORCEINLINE int GetMinDamage() const { return GetDefinition()->GetMinDamage(); }
+	FORCEINLINE int GetMaxDamage() const { return GetDefinition()->GetMaxDamage(); }
+	FORCEINLINE USoundBase* GetFireSound() const { return GetDefinition()->GetFireSound(); }
+	FORCEINLINE USoundBase* GetEmptyFireSound() const { return GetDefinition()->GetEmptyFireSound(); }
+	FORCEINLINE UParticleSystem* GetMuzzleFlashEmitterTemplate() const { return GetDefinition()->GetMuzzleFlashEmitterTemplate(); }
+	FORCEINLINE float GetMaximumDeviation() const { return GetDefinition()->GetMaximumDeviation(); }
 	FORCEINLINE bool IsClipEmpty() const { return (CurrentRounds == 0); }
-	FORCEINLINE bool IsClipFull() const { return (CurrentRounds == ClipSize); }
+	FORCEINLINE bool IsClipFull() const { return (CurrentRounds == GetClipCapacity()); }
 	FORCEINLINE int GetRoundsRemaining() const { return CurrentRounds; }
-	FORCEINLINE int GetClipCapacity() const { return ClipSize; }
+	FORCEINLINE int GetClipCapacity() const { return GetDefinition()->GetClipSize(); }
 
 	/** Removes a round from the clip. */
 	void RemoveRound();
@@ -54,57 +60,64 @@ protected:
 	/** Called at the start of the game or when spawned. */
 	void BeginPlay() override;
 
+	/** Builds the legacy definition of a blueprint that has no definition asset yet. Spawned weapons share their class default's. */
+	void PostLoad() override;
+
+private:
+	/** Copies the deprecated tuning properties into a new transient weapon definition. */
+	UWeaponDefinition* CreateLegacyDefinition();
+
 private:
 	/** The current number of rounds in the clip. Ranges between 0 and ClipSize. */
 	int CurrentRounds;
 
 	/** Weapon category */
-	/** The montage to play when the weapon is fired. */
+	/** Set in the derived blueprint. The tuning data shared by weapons of this type. */
 	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UWeaponDefinition* Definition;
+
+	/** Built from the deprecated tuning properties when no definition is set. */
+	UPROPERTY(Transient)
+	UWeaponDefinition* LegacyDefinition;
+	/////////////////////////////////////////////////////////////
+	/**
+	 * Deprecated tuning properties. Still loaded so the values set on existing weapon blueprints aren't lost, and used through the
+	 * legacy definition until the blueprint is given a definition asset. Remove once the content has been moved over.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the shot montage on the weapon definition instead."))
 	class UAnimMontage* ShotAnimMontage;
 
-	/** The montage to play when the weapon is reloaded. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the reload montage on the weapon definition instead."))
 	class UAnimMontage* ReloadAnimMontage;
 
-	/** The amount of time (seconds) before the weapon can be fired again. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the rounds per minute on the weapon definition instead."))
 	float ShotRecoverTime;
 
-	/** The maximum units the weapon can hit an object at. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the shot max range on the weapon definition instead."))
 	float ShotMaxRange;
 
-	/** The minimum amount of damage a shot of this weapon can do. Used as the bottom of a range. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the minimum damage on the weapon definition instead."))
 	int MinDamage;
 
-	/** The maximum amount of damage a shot of this weapon can do. Used as the top of a range. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the maximum damage on the weapon definition instead."))
 	int MaxDamage;
 
-	/** The sound to play when the weapon fires. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the fire sound on the weapon definition instead."))
 	USoundBase* FireSound;
 
-	/** The sound to play when the weapon fires and is empty. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the empty fire sound on the weapon definition instead."))
 	USoundBase* EmptyFireSound;
 
-	/** The sound to play when the weapon is reloaded. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the reload sound on the weapon definition instead."))
 	USoundBase* ReloadSound;
 
-	/** The particle system to spawn at the weapon's muzzle location when fired. Creates a muzzle flash effect. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the muzzle flash on the weapon definition instead."))
 	UParticleSystem* MuzzleFlashEmitterTemplate;
 
-	/** The maximum units a shot of this weapon can deviate when fired with low accuracy. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the maximum deviation on the weapon definition instead."))
 	float MaximumDeviation;
 
-	/** The number of rounds in a clip. */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (DeprecatedProperty, DeprecationMessage = "Set the clip size on the weapon definition instead."))
 	int ClipSize;
 	/////////////////////////////////////////////////////////////
 };
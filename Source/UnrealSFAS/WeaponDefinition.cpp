@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponDefinition.h"
+
+UWeaponDefinition::UWeaponDefinition()
+{
+	// Set default member values. These match the original handgun tuning.
+	FireMode = EWeaponFireMode::SemiAutomatic;
+	RoundsPerMinute = 400.f;
+	BurstCount = 3;
+	BurstRecoverTime = 0.3f;
+	PelletsPerShot = 1;
+	PelletSpreadDegrees = 5.f;
+	ShotMaxRange = 1000.0f;
+	ProjectileSpeed = 0.f;
+	MaximumDeviation = 50.f;
+	ClipSize = 8;
+	MinDamage = 1;
+	MaxDamage = 5;
+	ShotAnimMontage = nullptr;
+	ReloadAnimMontage = nullptr;
+	FireSound = nullptr;
+	EmptyFireSound = nullptr;
+	ReloadSound = nullptr;
+	MuzzleFlashEmitterTemplate = nullptr;
+}
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "WeaponDefinition.generated.h"
+
+/** How holding and pressing the trigger fires a weapon. */
+UENUM(BlueprintType)
+enum class EWeaponFireMode : uint8
+{
+	/** One shot per trigger press. */
+	SemiAutomatic,
+
+	/** Shots are fired for as long as the trigger is held. */
+	Automatic,
+
+	/** A fixed number of shots per trigger press. */
+	Burst,
+};
+
+/**
+ * Tuning data shared by every weapon of a type: how it fires, how much damage it deals and its effects. New weapons are
+ * made by creating a definition asset rather than a weapon class. A shotgun is a weapon with more than one pellet per shot,
+ * in any fire mode. Weapons without a definition use the defaults of this class.
+ */
+UCLASS(BlueprintType)
+class UNREALSFAS_API UWeaponDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponDefinition();
+
+	/** Returns the seconds between consecutive shots. */
+	FORCEINLINE float GetShotInterval() const { return 60.f / FMath::Max(RoundsPerMinute, 1.f); }
+
+	FORCEINLINE EWeaponFireMode GetFireMode() const { return FireMode; }
+	FORCEINLINE float GetRoundsPerMinute() const { return RoundsPerMinute; }
+	FORCEINLINE int GetBurstCount() const { return BurstCount; }
+	FORCEINLINE float GetBurstRecoverTime() const { return BurstRecoverTime; }
+	FORCEINLINE int GetPelletsPerShot() const { return PelletsPerShot; }
+	FORCEINLINE float GetPelletSpreadDegrees() const { return PelletSpreadDegrees; }
+	FORCEINLINE float GetShotMaxRange() const { return ShotMaxRange; }
+	FORCEINLINE float GetProjectileSpeed() const { return ProjectileSpeed; }
+	FORCEINLINE int GetMinDamage() const { return MinDamage; }
+	FORCEINLINE int GetMaxDamage() const { return MaxDamage; }
+	FORCEINLINE float GetMaximumDeviation() const { return MaximumDeviation; }
+	FORCEINLINE int GetClipSize() const { return ClipSize; }
+	FORCEINLINE class UAnimMontage* GetShotAnimMontage() const { return ShotAnimMontage; }
+	FORCEINLINE class UAnimMontage* GetReloadAnimMontage() const { return ReloadAnimMontage; }
+	FORCEINLINE USoundBase* GetFireSound() const { return FireSound; }
+	FORCEINLINE USoundBase* GetEmptyFireSound() const { return EmptyFireSound; }
+	FORCEINLINE USoundBase* GetReloadSound() const { return ReloadSound; }
+	FORCEINLINE UParticleSystem* GetMuzzleFlashEmitterTemplate() const { return MuzzleFlashEmitterTemplate; }
+
+private:
+	/** Weapons fill in a definition from their deprecated tuning properties until their blueprint is given a definition asset. */
+	friend class AWeapon;
+
+	///////////////////////////////////////////////
+	/** Fire category */
+	/** How holding and pressing the trigger fires the weapon. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true"))
+	EWeaponFireMode FireMode;
+
+	/** The rate shots are fired at while the trigger is held or a burst is firing. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	float RoundsPerMinute;
+
+	/** The number of shots fired by each trigger press in burst mode. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true", ClampMin = "1", EditCondition = "FireMode == EWeaponFireMode::Burst"))
+	int BurstCount;
+
+	/** The seconds after the last shot of a burst before the next burst can be fired. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true", EditCondition = "FireMode == EWeaponFireMode::Burst"))
+	float BurstRecoverTime;
+
+	/** The number of pellets each shot fires. Each pellet uses one round's damage range. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int PelletsPerShot;
+
+	/** The angle pellets spread from the centre of the shot, in degrees. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true", ClampMin = "0", ClampMax = "90"))
+	float PelletSpreadDegrees;
+
+	/** The maximum units the weapon can hit an object at. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true"))
+	float ShotMaxRange;
+
+	/** The speed of the projectiles the weapon fires. 0 fires instant hitscan shots. Projectiles fly until they have travelled ShotMaxRange. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float ProjectileSpeed;
+
+	/** The maximum units a shot of this weapon can deviate when fired with low accuracy. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true"))
+	float MaximumDeviation;
+
+	/** The number of rounds in a clip. */
+	UPROPERTY(EditDefaultsOnly, Category = Fire, meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int ClipSize;
+	///////////////////////////////////////////////
+	/** Damage category */
+	/** The minimum amount of damage a pellet of this weapon can do. Used as the bottom of a range. */
+	UPROPERTY(EditDefaultsOnly, Category = Damage, meta = (AllowPrivateAccess = "true"))
+	int MinDamage;
+
+	/** The maximum amount of damage a pellet of this weapon can do. Used as the top of a range. */
+	UPROPERTY(EditDefaultsOnly, Category = Damage, meta = (AllowPrivateAccess = "true"))
+	int MaxDamage;
+	///////////////////////////////////////////////
+	/** Animation category */
+	/** The montage to play when the weapon is fired. */
+	UPROPERTY(EditDefaultsOnly, Category = Animation, meta = (AllowPrivateAccess = "true"))
+	class UAnimMontage* ShotAnimMontage;
+
+	/** The montage to play when the weapon is reloaded. */
+	UPROPERTY(EditDefaultsOnly, Category = Animation, meta = (AllowPrivateAccess = "true"))
+	class UAnimMontage* ReloadAnimMontage;
+	///////////////////////////////////////////////
+	/** Audio category */
+	/** The sound to play when the weapon fires. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	USoundBase* FireSound;
+
+	/** The sound to play when the weapon fires and is empty. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	USoundBase* EmptyFireSound;
+
+	/** The sound to play when the weapon is reloaded. */
+	UPROPERTY(EditDefaultsOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	USoundBase* ReloadSound;
+	///////////////////////////////////////////////
+	/** Particles category */
+	/** The particle system to spawn at the weapon's muzzle location when fired. Creates a muzzle flash effect. */
+	UPROPERTY(EditDefaultsOnly, Category = Particles, meta = (AllowPrivateAccess = "true"))
+	UParticleSystem* MuzzleFlashEmitterTemplate;
+	///////////////////////////////////////////////
+};